@@ -0,0 +1,43 @@
+#pragma once
+/**
+ * @file   protocol/log/level.hpp
+ * @brief  Declaration of protocol::log::Level
+ */
+
+/**
+ * @def PROTOCOL_LOG_LEVEL
+ * Lowest level compiled in, as the integer value of a protocol::log::Level. Messages below it are removed by the
+ * compiler together with the formatting of their arguments. Defaults to kTrace, or to kInfo when NDEBUG is defined
+ */
+#ifndef PROTOCOL_LOG_LEVEL
+#ifdef NDEBUG
+#define PROTOCOL_LOG_LEVEL 2
+#else
+#define PROTOCOL_LOG_LEVEL 0
+#endif
+#endif
+
+namespace protocol {
+namespace log {
+
+/**
+ * Severity of a message
+ */
+enum class Level {
+  kTrace,    ///< Per request detail, such as message bodies
+  kDebug,    ///< Per connection and per request events
+  kInfo,     ///< Notable events
+  kWarning,  ///< Errors the library recovers from
+  kError,    ///< Errors the application has to handle
+  kOff,      ///< Disables logging
+};
+
+/**
+ * Get the name of a level
+ * @param level Level
+ * @return Upper case name
+ */
+PROTOCOL_DLL_PUBLIC const char* GetName(Level level);
+
+}  // namespace log
+}  // namespace protocol
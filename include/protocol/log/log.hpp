@@ -0,0 +1,27 @@
+#pragma once
+/**
+ * @file   protocol/log/log.hpp
+ * @brief  Logging macros
+ */
+
+#include <protocol/log/logger.hpp>
+
+/**
+ * @def PROTOCOL_LOG(level, message)
+ * Write a message, formatted with stream insertions: PROTOCOL_LOG_DEBUG("Connecting to " << host << ":" << port).
+ * The message isn't formatted when its level is disabled, and the statement is compiled out when the level is below
+ * PROTOCOL_LOG_LEVEL
+ */
+#define PROTOCOL_LOG(level, message)                                                                               \
+  do {                                                                                                             \
+    if (static_cast<int>(level) >= PROTOCOL_LOG_LEVEL && ::protocol::log::Logger::IsEnabled(level)) {              \
+      ::protocol::log::Message protocol_log_message(level);                                                       \
+      protocol_log_message.GetStream() << message;                                                                 \
+    }                                                                                                              \
+  } while (false)
+
+#define PROTOCOL_LOG_TRACE(message) PROTOCOL_LOG(::protocol::log::Level::kTrace, message)      ///< Trace message
+#define PROTOCOL_LOG_DEBUG(message) PROTOCOL_LOG(::protocol::log::Level::kDebug, message)      ///< Debug message
+#define PROTOCOL_LOG_INFO(message) PROTOCOL_LOG(::protocol::log::Level::kInfo, message)        ///< Info message
+#define PROTOCOL_LOG_WARNING(message) PROTOCOL_LOG(::protocol::log::Level::kWarning, message)  ///< Warning message
+#define PROTOCOL_LOG_ERROR(message) PROTOCOL_LOG(::protocol::log::Level::kError, message)      ///< Error message
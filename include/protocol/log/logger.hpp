@@ -0,0 +1,131 @@
+#pragma once
+/**
+ * @file   protocol/log/logger.hpp
+ * @brief  Class declaration of protocol::log::Logger
+ */
+
+#include <atomic>
+#include <boost/noncopyable.hpp>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <ostream>
+
+#include <protocol/log/level.hpp>
+
+namespace protocol {
+namespace log {
+
+/**
+ * A message handed to the sink
+ */
+struct PROTOCOL_DLL_PUBLIC Record {
+  Level level;                                 ///< Severity
+  std::chrono::system_clock::time_point time;  ///< Time the message was written
+  const char* text;                            ///< Message, not null terminated
+  size_t size;                                 ///< Size of the message
+};
+
+/**
+ * Process wide asynchronous logger. Writers format into a thread local buffer and copy the message into a lock-free
+ * ring, and a background thread hands the queued messages to the sink, so writing never blocks on I/O or on a lock.
+ * Messages are dropped while the ring is full and truncated to kMaxMessage bytes. Use the PROTOCOL_LOG_* macros of
+ * protocol/log/log.hpp rather than this class to write.
+ */
+class PROTOCOL_DLL_PUBLIC Logger {
+ public:
+  static const size_t kCapacity = 4096;   ///< Number of messages the ring holds, a power of two
+  static const size_t kMaxMessage = 256;  ///< Longest message kept, in bytes
+
+  using Sink = std::function<void(const Record&)>;  ///< Sink type, called from one thread at a time
+
+  /**
+   * Counters of the logger
+   */
+  struct Stats {
+    size_t written;  ///< Messages queued
+    size_t dropped;  ///< Messages dropped because the ring was full
+  };
+
+  /**
+   * Check whether a level is enabled at run time
+   * @param level Level
+   * @return True if messages of the level are kept
+   */
+  static bool IsEnabled(Level level) {
+    return static_cast<int>(level) >= level_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Set the lowest level kept at run time, levels below PROTOCOL_LOG_LEVEL are never kept. Defaults to
+   * PROTOCOL_LOG_LEVEL
+   * @param level Level
+   */
+  static void SetLevel(Level level);
+
+  /**
+   * Get the lowest level kept at run time
+   * @return Level
+   */
+  static Level GetLevel();
+
+  /**
+   * Set the sink the messages are handed to, from the background thread or from Flush
+   * @param sink Sink, null restores the default sink which writes to std::clog
+   */
+  static void SetSink(const Sink& sink);
+
+  /**
+   * Queue a message
+   * @param level Level
+   * @param text  Message
+   * @param size  Size of the message
+   */
+  static void Write(Level level, const char* text, size_t size);
+
+  /**
+   * Hand the queued messages to the sink from the calling thread
+   */
+  static void Flush();
+
+  /**
+   * Get the logger counters
+   * @return Counters
+   */
+  static Stats GetStats();
+
+ private:
+  static std::atomic<int> level_;  ///< Lowest level kept
+};
+
+/**
+ * Formats one message into a thread local buffer and queues it when destroyed
+ */
+class PROTOCOL_DLL_PUBLIC Message : boost::noncopyable {
+ public:
+  /**
+   * Ctor
+   * @param level Level of the message
+   */
+  explicit Message(Level level);
+
+  /**
+   * Dtor, queues the message
+   */
+  ~Message();
+
+  /**
+   * Get the stream the message is formatted with
+   * @return Stream
+   */
+  std::ostream& GetStream() {
+    return stream_;
+  }
+
+ private:
+  Level level_;           ///< Level of the message
+  std::ostream& stream_;  ///< Thread local stream over the message buffer
+};
+
+}  // namespace log
+}  // namespace protocol
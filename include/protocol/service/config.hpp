@@ -0,0 +1,69 @@
+#pragma once
+/**
+ * @file   protocol/service/config.hpp
+ * @brief  Declaration of protocol::service::Config
+ */
+
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace protocol {
+namespace service {
+
+/**
+ * Policy used to choose which io_service of the pool a new I/O object is bound to
+ */
+enum class Placement {
+  kRoundRobin,   ///< Cycle through the io_services in order
+  kLeastLoaded,  ///< Pick the io_service with the fewest live sockets
+};
+
+/**
+ * Configuration of the io_service pool
+ */
+struct PROTOCOL_DLL_PUBLIC Config {
+  /**
+   * Default ctor, one io_service per hardware thread placed round-robin
+   */
+  Config()
+      : num_threads(std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1),
+        placement(Placement::kRoundRobin),
+        cpu_affinity(),
+        worker_affinity(),
+        pin_workers(false),
+        numa_local(false),
+        thread_name("protocol"),
+        stack_size(0),
+        drain_timeout_ms(1000) {}
+
+  unsigned int num_threads;           ///< Number of io_services, each one is run by its own thread
+  Placement placement;                ///< Placement policy for new sockets
+  std::vector<unsigned> cpu_affinity; ///< CPUs the worker threads may run on, empty means any
+
+  /**
+   * Per worker CPU sets, worker i runs on worker_affinity[i % worker_affinity.size()]. Takes precedence over
+   * cpu_affinity and pin_workers
+   */
+  std::vector<std::vector<unsigned>> worker_affinity;
+
+  /**
+   * Pin each worker thread to a single CPU, worker i runs on cpu_affinity[i % cpu_affinity.size()] or, when
+   * cpu_affinity is empty, on the CPUs the process may run on (sched_getaffinity) in turn
+   */
+  bool pin_workers;
+
+  /**
+   * Sockets created from a pool thread are placed on a worker of the same NUMA node, so that their memory (which is
+   * first touched by the creating thread) stays local to the thread serving them
+   */
+  bool numa_local;
+
+  std::string thread_name;            ///< Worker threads are named "<thread_name>-<index>", empty keeps the default
+  size_t stack_size;                  ///< Worker thread stack size in bytes, 0 keeps the default
+  size_t drain_timeout_ms;            ///< How long singleton::Drain() waits for outstanding handlers
+};
+
+}  // namespace service
+}  // namespace protocol
@@ -5,22 +5,89 @@
  */
 
 #include <boost/asio/io_service.hpp>
+#include <boost/asio/generic/stream_protocol.hpp>
+#include <memory>
+
+#include <protocol/service/config.hpp>
+#include <protocol/service/topology.hpp>
 
 namespace protocol {
 namespace service {
 namespace singleton {
 
 /**
- * Get an instance of boost::asio::io_service
+ * Get an instance of boost::asio::io_service from the pool. Consecutive calls may return different io_services,
+ * the choice is made by the configured placement policy. Bind every I/O object that belongs to one connection to the
+ * same io_service so that its handlers always run on the same thread.
  * @return instance of boost::asio::io_service
+ * @throws std::runtime_error while the pool is draining
  */
 PROTOCOL_DLL_PUBLIC boost::asio::io_service& Instance();
 
 /**
- * Stops and deletes io_service instance
+ * Get the io_service run by a specific worker of the pool, e.g. to co-locate work with the CPUs reported by
+ * GetTopology()
+ * @param index Worker position in the pool
+ * @return instance of boost::asio::io_service
+ * @throws std::out_of_range if index isn't lower than the pool size
+ * @throws std::runtime_error while the pool is draining
+ */
+PROTOCOL_DLL_PUBLIC boost::asio::io_service& Instance(size_t index);
+
+/**
+ * Get the CPU and NUMA node mapping of the pool workers
+ * @return One entry per worker, ordered by index
+ * @throws std::runtime_error while the pool is draining
+ */
+PROTOCOL_DLL_PUBLIC Topology GetTopology();
+
+/**
+ * Create a socket bound to an io_service chosen by the placement policy. The socket is accounted as load of that
+ * io_service until it is destroyed.
+ * @return A shared pointer to a newly created socket
+ * @throws std::runtime_error while the pool is draining
+ */
+PROTOCOL_DLL_PUBLIC std::shared_ptr<boost::asio::generic::stream_protocol::socket> NewSocket();
+
+/**
+ * Create a socket bound to the io_service run by a specific worker of the pool
+ * @param index Worker position in the pool
+ * @return A shared pointer to a newly created socket
+ * @throws std::out_of_range if index isn't lower than the pool size
+ * @throws std::runtime_error while the pool is draining
+ */
+PROTOCOL_DLL_PUBLIC std::shared_ptr<boost::asio::generic::stream_protocol::socket> NewSocket(size_t index);
+
+/**
+ * Whether the calling thread is the worker running an io_service, i.e. whether waiting there for a handler posted to
+ * that io_service would deadlock. Stays valid while the pool is draining
+ * @param service io_service to check
+ * @return True if called from the thread running service
+ */
+PROTOCOL_DLL_PUBLIC bool RunsInThisThread(const boost::asio::io_service& service);
+
+/**
+ * Set the pool configuration. Takes effect the next time the pool is created, i.e. on the first call to Instance()
+ * or after TearDown()/Drain()
+ * @param config Pool configuration
+ */
+PROTOCOL_DLL_PUBLIC void Configure(const Config& config);
+
+/**
+ * Stops the io_services without waiting for outstanding handlers, joins their threads and deletes the pool
+ * @throws std::logic_error if called from a pool thread
  */
 PROTOCOL_DLL_PUBLIC void TearDown();
 
+/**
+ * Gracefully shuts down the pool. New work is refused (Instance() and NewSocket() throw std::runtime_error) while
+ * outstanding handlers are given up to Config::drain_timeout_ms to complete, then the threads are joined and the pool
+ * is deleted. The next call to Instance() creates a new pool.
+ * @return True if every outstanding handler completed before the deadline
+ * @throws std::logic_error if called from a pool thread
+ */
+PROTOCOL_DLL_PUBLIC bool Drain();
+
 }  // namespace singleton
 }  // namespace service
 }  // namespace protocol
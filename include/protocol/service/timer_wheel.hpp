@@ -0,0 +1,168 @@
+#pragma once
+/**
+ * @file   protocol/service/timer_wheel.hpp
+ * @brief  Class declarations of protocol::service::TimerWheel and protocol::service::Timer
+ */
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/system/error_code.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace protocol {
+namespace service {
+
+class TimerWheel;
+
+/**
+ * One-shot millisecond timer scheduled on the TimerWheel of an io_service. Arming and cancelling are O(1) and don't
+ * allocate besides the handler itself. The handler runs on the thread of the io_service and isn't called once Cancel()
+ * returned true, even if the timer already expired and waits behind the other handlers of its tick.
+ */
+class PROTOCOL_DLL_PUBLIC Timer : boost::noncopyable {
+ public:
+  using Handler = std::function<void()>;  ///< Expiry handler type
+
+  /**
+   * Ctor
+   * @param service io_service whose TimerWheel schedules this timer
+   */
+  explicit Timer(boost::asio::io_service& service);
+
+  /**
+   * Dtor, cancels the timer
+   */
+  ~Timer();
+
+  /**
+   * Schedule the handler, replacing any previously armed one
+   * @param timeout_ms Time from now in milliseconds, rounded up to the wheel resolution
+   * @param handler    Handler called on expiry
+   */
+  void Arm(size_t timeout_ms, Handler handler);
+
+  /**
+   * Cancel the timer
+   * @return True if the timer was armed
+   */
+  bool Cancel();
+
+  /**
+   * Get the io_service the timer is scheduled on
+   * @return A reference to the io_service
+   */
+  boost::asio::io_service& GetService();
+
+ private:
+  friend class TimerWheel;
+
+  boost::asio::io_service& service_;  ///< io_service the timer is scheduled on
+  TimerWheel& wheel_;                 ///< Wheel this timer is scheduled on
+  Timer* prev_;                       ///< Previous timer of the wheel slot or of the expired list
+  Timer* next_;                       ///< Next timer of the wheel slot or of the expired list
+  uint64_t due_;                      ///< Expiry tick
+  bool armed_;                        ///< Whether the timer is linked in the wheel
+  bool expired_;                      ///< Whether the timer is linked in the expired list rather than in a slot
+  Handler handler_;                   ///< Expiry handler
+};
+
+/**
+ * Hashed timing wheel with one millisecond ticks, installed as a service of an io_service. Timers live in
+ * unsorted per slot lists, the slot being their expiry tick modulo the number of slots, so arm and cancel are O(1)
+ * and a single steady_timer drives the whole wheel. When several threads run the io_service, the handlers of
+ * consecutive ticks may run concurrently.
+ */
+class PROTOCOL_DLL_PUBLIC TimerWheel : public boost::asio::io_service::service {
+ public:
+  static boost::asio::io_service::id id;  ///< Service identifier
+  static const size_t kNumSlots = 1024;   ///< Number of slots, a power of two
+
+  /**
+   * Ctor, use boost::asio::use_service<TimerWheel>() to get the instance of an io_service
+   * @param service Owning io_service
+   */
+  explicit TimerWheel(boost::asio::io_service& service);
+
+  /**
+   * Get the number of armed timers
+   * @return Number of armed timers
+   */
+  size_t GetSize();
+
+ private:
+  friend class Timer;
+
+  using Clock = std::chrono::steady_clock;  ///< Wheel time source
+
+  /**
+   * Destroy the handlers of every armed timer
+   */
+  void shutdown_service() override;
+
+  /**
+   * Link a timer
+   * @param timer      Timer to link
+   * @param timeout_ms Time from now in milliseconds
+   * @param handler    Handler called on expiry
+   */
+  void Arm(Timer& timer, size_t timeout_ms, Timer::Handler&& handler);
+
+  /**
+   * Unlink a timer
+   * @param timer Timer to unlink
+   * @return True if the timer was armed
+   */
+  bool Cancel(Timer& timer);
+
+  /**
+   * Unlink a timer from its slot or from the expired list, must be called with mutex_ held
+   * @param timer Timer to unlink
+   */
+  void Unlink(Timer& timer);
+
+  /**
+   * Get the current tick
+   * @return Milliseconds since the wheel was created
+   */
+  uint64_t Now() const;
+
+  /**
+   * Make sure the driving timer wakes up in time for the next occupied slot, must be called with mutex_ held
+   */
+  void Schedule();
+
+  /**
+   * Handler of the driving timer, expires the due timers
+   * @param ec Error code
+   */
+  void OnTick(const boost::system::error_code& ec);
+
+  /**
+   * Take the handler of the next expired timer, so that a timer cancelled by an earlier handler isn't run
+   * @param handler Set to the handler
+   * @return False once the expired list is empty
+   */
+  bool TakeExpired(Timer::Handler& handler);
+
+ private:
+  std::mutex mutex_;                  ///< Protects the wheel, timers may be armed from any thread
+  Clock::time_point start_;           ///< Time of tick 0
+  boost::asio::steady_timer ticker_;  ///< Drives the wheel
+  std::vector<Timer*> slots_;         ///< Slot list heads
+  Timer* expired_head_;               ///< Due timers whose handler waits to run, in expiry order
+  Timer* expired_tail_;               ///< Last timer of the expired list
+  uint64_t cursor_;                   ///< Next tick to process
+  uint64_t wake_;                     ///< Tick ticker_ is set to, valid if waiting_
+  bool waiting_;                      ///< Whether ticker_ has a pending wait
+  bool shutdown_;                     ///< Service shutdown state
+  size_t size_;                       ///< Number of armed timers
+};
+
+}  // namespace service
+}  // namespace protocol
@@ -0,0 +1,25 @@
+#pragma once
+/**
+ * @file   protocol/service/topology.hpp
+ * @brief  Declaration of protocol::service::WorkerInfo
+ */
+
+#include <cstddef>
+#include <vector>
+
+namespace protocol {
+namespace service {
+
+/**
+ * Describes where a worker of the io_service pool runs
+ */
+struct PROTOCOL_DLL_PUBLIC WorkerInfo {
+  size_t index;               ///< Position of the worker in the pool
+  std::vector<unsigned> cpus; ///< CPUs the worker thread is pinned to, empty if it isn't pinned
+  int numa_node;              ///< NUMA node shared by all cpus, -1 if unknown or if they span several nodes
+};
+
+using Topology = std::vector<WorkerInfo>;  ///< Worker mapping of the whole pool
+
+}  // namespace service
+}  // namespace protocol
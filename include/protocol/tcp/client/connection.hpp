@@ -4,8 +4,6 @@
  * @brief  Class definition of protocol::tcp::client::Connection
  */
 
-#include <boost/asio/deadline_timer.hpp>
-#include <boost/asio/ip/tcp.hpp>
 #include <boost/enable_shared_from_this.hpp>
 #include <boost/noncopyable.hpp>
 #include <boost/system/error_code.hpp>
@@ -14,8 +12,14 @@
 #include <functional>
 #include <exception>
 #include <string>
+#include <vector>
 
+#include <protocol/service/timer_wheel.hpp>
+#include <protocol/tcp/client/connection/config.hpp>
 #include <protocol/tcp/client/connection/ptr.hpp>
+#include <protocol/tcp/client/dns_cache.hpp>
+#include <protocol/tcp/socket/endpoint.hpp>
+#include <protocol/tcp/socket/options.hpp>
 #include <protocol/tcp/socket/ptr.hpp>
 
 namespace protocol {
@@ -23,21 +27,52 @@ namespace tcp {
 namespace client {
 
 /**
- * Asynchronously establishes a TCP connection to a specified address within the given timeout.
+ * Asynchronously establishes a connection to a specified address within the given timeout, over TCP or over a Unix
+ * domain socket. When an address has several endpoints, attempts to them are staggered and the first one to succeed
+ * wins, see connection::Config.
  */
 class PROTOCOL_DLL_PUBLIC Connection : public boost::enable_shared_from_this<Connection>, boost::noncopyable {
  public:
   using Callback = std::function<void(std::exception_ptr, socket::sock::Ptr)>;  ///< Callback type
 
   /**
-   * Create an instance of Connection
+   * Create an instance of Connection. Names are resolved through the DnsCache
    * @param uri        Address to connect to
    * @param port       Port to connect to
    * @param timeout_ms Timeout for establishing the connection. A value of 0 implies no timeout
    * @param on_done    Callback to return result asynchronously
+   * @param options    Socket options, applied before connecting to each endpoint
+   * @param config     Connection configuration
    * @return  A shared pointer of a newly created Connection instance
    */
-  static connection::Ptr Start(std::string uri, const uint16_t port, const size_t timeout_ms, const Callback& on_done);
+  static connection::Ptr Start(std::string uri, const uint16_t port, const size_t timeout_ms, const Callback& on_done,
+                               const socket::Options& options = socket::Options(),
+                               const connection::Config& config = connection::Config());
+
+  /**
+   * Create an instance of Connection to an endpoint, without resolving any name
+   * @param endpoint   Endpoint to connect to: a tcp::endpoint, or a local::stream_protocol::endpoint for a Unix domain
+   *                   socket, which skips the TCP level options
+   * @param timeout_ms Timeout for establishing the connection. A value of 0 implies no timeout
+   * @param on_done    Callback to return result asynchronously
+   * @param options    Socket options, applied before connecting
+   * @return  A shared pointer of a newly created Connection instance
+   */
+  static connection::Ptr Start(const socket::Endpoint& endpoint, const size_t timeout_ms, const Callback& on_done,
+                               const socket::Options& options = socket::Options());
+
+  /**
+   * Create an instance of Connection to the first reachable endpoint of a list, without resolving any name
+   * @param endpoints  Endpoints to connect to, in order of preference
+   * @param timeout_ms Timeout for establishing the connection. A value of 0 implies no timeout
+   * @param on_done    Callback to return result asynchronously
+   * @param options    Socket options, applied before connecting to each endpoint
+   * @param config     Connection configuration
+   * @return  A shared pointer of a newly created Connection instance
+   */
+  static connection::Ptr Start(const std::vector<socket::Endpoint>& endpoints, const size_t timeout_ms,
+                               const Callback& on_done, const socket::Options& options = socket::Options(),
+                               const connection::Config& config = connection::Config());
 
   /**
    * Dtor
@@ -53,8 +88,10 @@ class PROTOCOL_DLL_PUBLIC Connection : public boost::enable_shared_from_this<Con
   /**
    * Ctor
    * @param on_done  Callback reference
+   * @param options  Socket options
+   * @param config   Connection configuration
    */
-  explicit Connection(const Callback& on_done);
+  Connection(const Callback& on_done, const socket::Options& options, const connection::Config& config);
 
   /**
    * Starts the connection establishment operation
@@ -64,31 +101,69 @@ class PROTOCOL_DLL_PUBLIC Connection : public boost::enable_shared_from_this<Con
    */
   void Start(std::string uri, const uint16_t port, const size_t timeout_ms);
 
+  /**
+   * Starts connecting to a list of endpoints
+   * @param endpoints  Endpoints to connect to
+   * @param timeout_ms Timeout for establishing the connection. A value of 0 implies no timeout
+   */
+  void Start(const std::vector<socket::Endpoint>& endpoints, const size_t timeout_ms);
+
   /**
    * Handler for deadline task
    */
   void HandleDeadline();
 
+  /**
+   * Handler for the delay between two attempts, starts the next one
+   */
+  void HandleAttemptDelay();
+
   /**
    * Handler for connection task
-   * @param ec                Error code in case an error occurs
-   * @param endpoint_iterator An iterator with the available endpoints
+   * @param ec    Error code in case an error occurs
+   * @param sock  Socket of the attempt
+   * @param index Position of the endpoint of the attempt
    */
-  void HandleConnect(const boost::system::error_code& ec, boost::asio::ip::tcp::resolver::iterator endpoint_iterator);
+  void HandleConnect(const boost::system::error_code& ec, const socket::sock::Ptr& sock, size_t index);
 
   /**
    * Connection resolver handler
-   * @param ec                Error code in case an error occurs
-   * @param endpoint_iterator An iterator with the available endpoints
+   * @param ec        Error code in case an error occurs
+   * @param endpoints The available endpoints
+   */
+  void HandleResolve(const boost::system::error_code& ec, const DnsCache::Endpoints& endpoints);
+
+  /**
+   * Open a socket, apply the options and connect it to the next endpoint
+   */
+  void Connect();
+
+  /**
+   * Move on to the next endpoint after an attempt failed, or report the error once no attempt is left in flight
+   * @param ec      Error code of the attempt
+   * @param index   Position of the endpoint of the attempt
+   * @param message Description of the failed step
+   */
+  void HandleAttemptError(const boost::system::error_code& ec, size_t index, const char* message);
+
+  /**
+   * Stop and report an error
+   * @param ec      Error code
+   * @param message Description of the failed step
    */
-  void HandleResolve(const boost::system::error_code& ec, boost::asio::ip::tcp::resolver::iterator endpoint_iterator);
+  void Fail(const boost::system::error_code& ec, const char* message);
 
  private:
   bool stopped_;                             ///< State control
-  boost::asio::deadline_timer deadline_;     ///< Deadline timer
-  socket::sock::Ptr sock_;                   ///< Network socket resource
-  boost::asio::ip::tcp::resolver resolver_;  ///< Host resolver
+  socket::sock::Ptr sock_;                   ///< Network socket resource, the first attempt and then the winner
+  service::Timer deadline_;                  ///< Deadline timer
+  service::Timer attempt_delay_;             ///< Delay before the next attempt
   Callback on_done_;                         ///< Client callback
+  socket::Options options_;                  ///< Socket options
+  connection::Config config_;                ///< Connection configuration
+  std::vector<socket::Endpoint> endpoints_;  ///< Endpoints to try, in order
+  size_t next_;                              ///< Position of the next endpoint to try
+  std::vector<socket::sock::Ptr> attempts_;  ///< Sockets of the attempts in flight
 };
 
 }  // namespace client
@@ -0,0 +1,34 @@
+#pragma once
+/**
+ * @file   protocol/tcp/client/connection/config.hpp
+ * @brief  Declaration of protocol::tcp::client::connection::Config
+ */
+
+#include <cstddef>
+
+namespace protocol {
+namespace tcp {
+namespace client {
+namespace connection {
+
+/**
+ * Configuration of a Connection
+ */
+struct PROTOCOL_DLL_PUBLIC Config {
+  /**
+   * Default ctor
+   */
+  Config() : attempt_delay_ms(250) {}
+
+  /**
+   * Delay before connecting to the next endpoint while the previous attempts are still in flight, as in RFC 8305. The
+   * first attempt to succeed is kept and the others are cancelled, and a failed attempt starts the next one at once.
+   * 0 tries the endpoints one after the other, each one until it fails
+   */
+  size_t attempt_delay_ms;
+};
+
+}  // namespace connection
+}  // namespace client
+}  // namespace tcp
+}  // namespace protocol
@@ -0,0 +1,156 @@
+#pragma once
+/**
+ * @file   protocol/tcp/client/connection_pool.hpp
+ * @brief  Class declaration of protocol::tcp::client::ConnectionPool
+ */
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/noncopyable.hpp>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <protocol/tcp/client/connection_pool/config.hpp>
+#include <protocol/tcp/client/connection_pool/ptr.hpp>
+#include <protocol/tcp/client/connection_pool/stats.hpp>
+#include <protocol/tcp/client/lease/ptr.hpp>
+#include <protocol/tcp/socket/ptr.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace client {
+
+/**
+ * Keeps connected sockets per host:port so that requests to the same host skip name resolution and the handshake.
+ * Acquire() lends the most recently used idle socket, or connects a new one; the socket comes back to the pool when
+ * its Lease is released. Thread safe.
+ */
+class PROTOCOL_DLL_PUBLIC ConnectionPool : public boost::enable_shared_from_this<ConnectionPool>, boost::noncopyable {
+ public:
+  using Callback = std::function<void(std::exception_ptr, lease::Ptr)>;  ///< Callback type
+
+  /**
+   * Create a ConnectionPool instance
+   * @param config Pool configuration
+   * @return A shared pointer to the new pool
+   */
+  static connection_pool::Ptr Create(const connection_pool::Config& config = connection_pool::Config());
+
+  /**
+   * Dtor, closes the idle sockets and fails the waiting requests with operation_aborted, on the io_service picked when
+   * they were queued. Leased sockets are closed when their lease is dropped
+   */
+  ~ConnectionPool();
+
+  /**
+   * Lease a socket connected to a host
+   * @param host    Address to connect to
+   * @param port    Port to connect to
+   * @param on_done Callback called on the I/O thread of the socket with the lease, or with the connection error
+   */
+  void Acquire(const std::string& host, uint16_t port, const Callback& on_done);
+
+  /**
+   * Close the idle sockets
+   */
+  void Clear();
+
+  /**
+   * Get the pool counters
+   * @return Counters
+   */
+  connection_pool::Stats GetStats();
+
+ private:
+  friend class Lease;
+
+  using Clock = std::chrono::steady_clock;  ///< Clock of the idle timeout
+
+  /**
+   * A socket waiting in the pool
+   */
+  struct Idle {
+    socket::sock::Ptr sock;   ///< Connected socket
+    Clock::time_point since;  ///< Time the socket was released
+  };
+
+  /**
+   * A request waiting for max_per_host
+   */
+  struct Waiter {
+    boost::asio::io_service::work work;  ///< Keeps the io_service the request fails on if the pool is destroyed awake
+    Callback on_done;                    ///< Request callback
+  };
+
+  /**
+   * Sockets of one host
+   */
+  struct Host {
+    std::string host;              ///< Address to connect to
+    uint16_t port;                 ///< Port to connect to
+    std::deque<Idle> idle;         ///< Idle sockets, the least recently released first
+    size_t open;                   ///< Sockets connecting, leased or idle
+    std::deque<Waiter> waiting;    ///< Requests waiting for max_per_host
+  };
+
+  /**
+   * Private constructor for this class
+   * @param config Pool configuration
+   */
+  explicit ConnectionPool(const connection_pool::Config& config);
+
+  /**
+   * Connect a new socket for a request, a socket must be counted as open
+   * @param key     Host to connect to, as host:port
+   * @param host    Address to connect to
+   * @param port    Port to connect to
+   * @param on_done Request callback
+   */
+  void Connect(const std::string& key, const std::string& host, uint16_t port, const Callback& on_done);
+
+  /**
+   * Take back the socket of a lease
+   * @param key      Host of the socket
+   * @param sock     Socket
+   * @param reusable Whether the socket may be lent again
+   */
+  void Return(const std::string& key, const socket::sock::Ptr& sock, bool reusable);
+
+  /**
+   * Forget a socket that was closed or failed to connect, and connect one for a waiting request if any
+   * @param lock Lock of mutex_, released before connecting
+   * @param key  Host of the socket
+   */
+  void Close(std::unique_lock<std::mutex>& lock, const std::string& key);
+
+  /**
+   * Arm the sweep of expired idle sockets unless it is armed, mutex_ must be held
+   */
+  void ArmSweep();
+
+  /**
+   * Close the expired idle sockets and re-arm the sweep while sockets are idle
+   * @param pool Pool to sweep, if still alive
+   * @param ec   Error code
+   */
+  static void OnSweep(const connection_pool::WeakPtr& pool, const boost::system::error_code& ec);
+
+ private:
+  const connection_pool::Config config_;         ///< Pool configuration
+  std::mutex mutex_;                             ///< Protects the members below
+  std::unordered_map<std::string, Host> hosts_;  ///< Sockets per host:port
+  boost::asio::steady_timer sweep_;              ///< Closes the expired idle sockets
+  bool sweeping_;                                ///< Whether sweep_ is armed
+  connection_pool::Stats stats_;                 ///< Counters, idle excepted
+};
+
+}  // namespace client
+}  // namespace tcp
+}  // namespace protocol
@@ -0,0 +1,54 @@
+#pragma once
+/**
+ * @file   protocol/tcp/client/connection_pool/config.hpp
+ * @brief  Declaration of protocol::tcp::client::connection_pool::Config
+ */
+
+#include <cstddef>
+
+#include <protocol/tcp/socket/options.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace client {
+namespace connection_pool {
+
+/**
+ * Configuration of a ConnectionPool
+ */
+struct PROTOCOL_DLL_PUBLIC Config {
+  /**
+   * Default ctor
+   */
+  Config()
+      : max_idle_per_host(8),
+        max_per_host(0),
+        idle_timeout_ms(60000),
+        connect_timeout_ms(1000),
+        health_check(true),
+        options() {}
+
+  size_t max_idle_per_host;  ///< Most idle sockets kept per host, released sockets above it are closed
+
+  /**
+   * Most sockets per host, whether connecting, leased or idle, 0 for no limit. Requests above it wait for a socket to
+   * be released or closed
+   */
+  size_t max_per_host;
+
+  size_t idle_timeout_ms;     ///< Time after which an idle socket is closed, 0 keeps it until it fails a check
+  size_t connect_timeout_ms;  ///< Timeout of new connections, 0 implies no timeout
+
+  /**
+   * Check an idle socket before leasing it, without blocking. A socket that the peer closed, or with unread data left
+   * by a previous exchange, is closed and the next one is tried
+   */
+  bool health_check;
+
+  socket::Options options;  ///< Socket options of new connections
+};
+
+}  // namespace connection_pool
+}  // namespace client
+}  // namespace tcp
+}  // namespace protocol
@@ -0,0 +1,31 @@
+#pragma once
+/**
+ * @file   protocol/tcp/client/connection_pool/ptr.hpp
+ * @brief  Smart pointer declarations for protocol::tcp::client::ConnectionPool
+ */
+
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace client {
+
+class ConnectionPool;
+
+namespace connection_pool {
+
+/**
+ * A mutable ConnectionPool pointer
+ */
+using Ptr = boost::shared_ptr<ConnectionPool>;
+
+/**
+ * A ConnectionPool pointer that doesn't keep the pool alive
+ */
+using WeakPtr = boost::weak_ptr<ConnectionPool>;
+
+}  // namespace connection_pool
+}  // namespace client
+}  // namespace tcp
+}  // namespace protocol
@@ -0,0 +1,29 @@
+#pragma once
+/**
+ * @file   protocol/tcp/client/connection_pool/stats.hpp
+ * @brief  Declaration of protocol::tcp::client::connection_pool::Stats
+ */
+
+#include <cstddef>
+
+namespace protocol {
+namespace tcp {
+namespace client {
+namespace connection_pool {
+
+/**
+ * Counters of a ConnectionPool
+ */
+struct PROTOCOL_DLL_PUBLIC Stats {
+  size_t hits;           ///< Leases served by an idle or released socket
+  size_t connects;       ///< New connections started
+  size_t evicted;        ///< Idle sockets closed by the idle timeout
+  size_t failed_checks;  ///< Idle sockets closed because they failed the health check
+  size_t waited;         ///< Requests that waited because their host reached max_per_host
+  size_t idle;           ///< Idle sockets currently kept
+};
+
+}  // namespace connection_pool
+}  // namespace client
+}  // namespace tcp
+}  // namespace protocol
@@ -0,0 +1,79 @@
+#pragma once
+/**
+ * @file   protocol/tcp/client/dns_cache.hpp
+ * @brief  Class declaration of protocol::tcp::client::DnsCache
+ */
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/system/error_code.hpp>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <protocol/tcp/client/dns_cache/config.hpp>
+#include <protocol/tcp/client/dns_cache/stats.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace client {
+
+/**
+ * Process wide cache of name resolutions, used by Connection. Successful and failed lookups are kept for their TTL,
+ * and concurrent requests for a name that is being looked up share that lookup. Names are cached independently of the
+ * port, and numeric addresses are returned without a lookup. Thread safe.
+ */
+class PROTOCOL_DLL_PUBLIC DnsCache {
+ public:
+  using Endpoints = std::vector<boost::asio::ip::tcp::endpoint>;  ///< Resolved endpoints, in resolver order
+
+  /**
+   * Callback type, called with the lookup error or with at least one endpoint
+   */
+  using Callback = std::function<void(const boost::system::error_code&, const Endpoints&)>;
+
+  /**
+   * Resolve a name
+   * @param service io_service the callback is posted to, which also runs the lookup on a miss
+   * @param host    Name or numeric address to resolve
+   * @param port    Port of the endpoints
+   * @param on_done Callback
+   */
+  static void Resolve(boost::asio::io_service& service, const std::string& host, uint16_t port,
+                      const Callback& on_done);
+
+  /**
+   * Look up names ahead of their first use on the shared io_service pool, names already cached or being looked up are
+   * skipped
+   * @param hosts Names to resolve
+   */
+  static void Prewarm(const std::vector<std::string>& hosts);
+
+  /**
+   * Set the cache configuration, applies to the names resolved afterwards
+   * @param config Configuration
+   */
+  static void Configure(const dns_cache::Config& config);
+
+  /**
+   * Get the cache configuration
+   * @return Configuration
+   */
+  static dns_cache::Config GetConfig();
+
+  /**
+   * Forget every name that isn't being looked up
+   */
+  static void Clear();
+
+  /**
+   * Get the cache counters
+   * @return Counters
+   */
+  static dns_cache::Stats GetStats();
+};
+
+}  // namespace client
+}  // namespace tcp
+}  // namespace protocol
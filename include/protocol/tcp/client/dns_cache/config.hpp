@@ -0,0 +1,43 @@
+#pragma once
+/**
+ * @file   protocol/tcp/client/dns_cache/config.hpp
+ * @brief  Declaration of protocol::tcp::client::dns_cache::Config
+ */
+
+#include <cstddef>
+
+namespace protocol {
+namespace tcp {
+namespace client {
+namespace dns_cache {
+
+/**
+ * Configuration of the DnsCache
+ */
+struct PROTOCOL_DLL_PUBLIC Config {
+  /**
+   * Default ctor
+   */
+  Config() : ttl_ms(30000), negative_ttl_ms(1000), refresh_ahead_ms(3000), max_entries(1024) {}
+
+  /**
+   * Time a resolved name is served from the cache, 0 disables caching but still shares concurrent lookups. The system
+   * resolver doesn't report the record TTL, so this one applies to every name
+   */
+  size_t ttl_ms;
+
+  size_t negative_ttl_ms;  ///< Time a failed lookup is served from the cache, 0 retries the lookup on every request
+
+  /**
+   * A name requested within this time of its expiry is looked up again in the background, so that names in regular
+   * use never miss the cache. 0 disables refreshing
+   */
+  size_t refresh_ahead_ms;
+
+  size_t max_entries;  ///< Most names kept, expired names are dropped first
+};
+
+}  // namespace dns_cache
+}  // namespace client
+}  // namespace tcp
+}  // namespace protocol
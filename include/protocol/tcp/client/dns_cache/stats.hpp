@@ -0,0 +1,29 @@
+#pragma once
+/**
+ * @file   protocol/tcp/client/dns_cache/stats.hpp
+ * @brief  Declaration of protocol::tcp::client::dns_cache::Stats
+ */
+
+#include <cstddef>
+
+namespace protocol {
+namespace tcp {
+namespace client {
+namespace dns_cache {
+
+/**
+ * Counters of the DnsCache
+ */
+struct PROTOCOL_DLL_PUBLIC Stats {
+  size_t hits;           ///< Requests served from a resolved name
+  size_t negative_hits;  ///< Requests served from a failed lookup
+  size_t misses;         ///< Requests that started a lookup
+  size_t coalesced;      ///< Requests that joined a lookup in flight
+  size_t refreshes;      ///< Lookups started ahead of expiry or by a pre-warm
+  size_t entries;        ///< Names currently kept
+};
+
+}  // namespace dns_cache
+}  // namespace client
+}  // namespace tcp
+}  // namespace protocol
@@ -12,12 +12,15 @@ namespace tcp {
 namespace client {
 namespace http {
 
-using Headers = std::vector<std::pair<std::string, std::string>>;  ///< HTTP header type
+/**
+ * HTTP header type, field names without the colon and values without surrounding whitespace
+ */
+using Headers = std::vector<std::pair<std::string, std::string>>;
 
 /**
  * Retrieves the HTML header value which has the given key
  * @param headers HTML headers object
- * @param name Field name
+ * @param name Field name, compared ignoring case
  * @return Reference to header entry value
  * @throws Exception if key is not found
  */
@@ -14,10 +14,13 @@
 #include <boost/enable_shared_from_this.hpp>
 #include <boost/noncopyable.hpp>
 #include <boost/system/error_code.hpp>
+#include <boost/utility/string_ref.hpp>
 #include <boost/asio/coroutine.hpp>
 
+#include <protocol/service/timer_wheel.hpp>
 #include <protocol/tcp/client/http.hpp>
 #include <protocol/tcp/client/http_post/ptr.hpp>
+#include <protocol/tcp/client/response_parser.hpp>
 #include <protocol/tcp/socket/ptr.hpp>
 #include <protocol/tcp/socket/buffer/ptr.hpp>
 
@@ -34,6 +37,12 @@ boost::asio::coroutine {
  public:
   using Callback = std::function<void(std::exception_ptr, http_post::Ptr caller)>;  ///< Callback type
 
+  /**
+   * Body callback type, called with each slice of the response body as it arrives. The slice is only valid during
+   * the call, and an exception thrown aborts the request
+   */
+  using BodyCallback = std::function<void(boost::string_ref data, http_post::Ptr caller)>;
+
   /**
    * Create an HTTPPost instance and return a shared pointer to it
    * @param sock    Input socket in the open state
@@ -106,12 +115,31 @@ boost::asio::coroutine {
    */
   const Headers& GetResponseHeaders() const;
 
+  /**
+   * Getter for response_trailers_
+   * @return Trailer fields of a chunked response body
+   */
+  const Headers& GetResponseTrailers() const;
+
   /**
    * Getter for response_status_code_
    * @return response_status_code_
    */
   int GetResponseStatusCode() const;
 
+  /**
+   * Whether the connection may carry another request after the response
+   * @return False if the response asked to close it, or ended with it
+   */
+  bool IsPersistent() const;
+
+  /**
+   * Stream the response body to a callback instead of storing it, so that GetResponseContent() stays empty. Must be
+   * set before Start
+   * @param callback Body callback, null to store the body
+   */
+  void SetOnBodyCallback(const BodyCallback& callback);
+
   /**
    * Setter for request_body_
    * @param body Value to set
@@ -134,10 +162,17 @@ boost::asio::coroutine {
   /**
    * Performs the logical operations of this class using boost::asio::coroutine
    * @param ec    Error code
-   * @param bytes Number of bytes written
+   * @param bytes Number of bytes transferred
    */
   void operator()(boost::system::error_code ec, std::size_t bytes);
 
+  /**
+   * Parse the bytes received so far
+   * @param eof Whether the peer closed the connection
+   * @return False if the response is malformed, after the callback was called with the error
+   */
+  bool ParseResponse(bool eof);
+
   /**
    * Handler for timer
    */
@@ -147,8 +182,9 @@ boost::asio::coroutine {
   bool stopped_;                                           ///< Control variable
   protocol::tcp::socket::sock::Ptr sock_;                  ///< Network socket resource
   protocol::tcp::socket::buffer::Ptr buffer_;              ///< Input/Output buffer
-  std::shared_ptr<boost::asio::deadline_timer> deadline_;  ///< Deadline timer
+  std::unique_ptr<protocol::service::Timer> deadline_;     ///< Deadline timer
   Callback on_done_callback_;                              ///< Client callback
+  BodyCallback on_body_callback_;                          ///< Client body callback, null to store the body
   std::string path_;                                       ///< Remote host endpoint
 
   Headers request_headers_;                                ///< Request header fields
@@ -156,7 +192,9 @@ boost::asio::coroutine {
 
   int response_status_code_;                               ///< Response status code
   Headers response_headers_;                               ///< Response header fields
+  Headers response_trailers_;                              ///< Response trailer fields
   std::string response_content_;                           ///< Response body
+  ResponseParser parser_;                                  ///< Response parser
 };
 
 }  // namespace http
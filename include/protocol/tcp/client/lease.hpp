@@ -0,0 +1,75 @@
+#pragma once
+/**
+ * @file   protocol/tcp/client/lease.hpp
+ * @brief  Class declaration of protocol::tcp::client::Lease
+ */
+
+#include <boost/noncopyable.hpp>
+#include <string>
+
+#include <protocol/tcp/client/connection_pool/ptr.hpp>
+#include <protocol/tcp/client/lease/ptr.hpp>
+#include <protocol/tcp/socket/ptr.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace client {
+
+/**
+ * A connected socket lent by a ConnectionPool. Call Release() once an exchange completed and left the connection
+ * reusable, the socket then goes back to the pool; a lease dropped without being released closes its socket, which is
+ * the safe outcome when an exchange failed half way.
+ */
+class PROTOCOL_DLL_PUBLIC Lease : boost::noncopyable {
+ public:
+  /**
+   * Dtor, closes the socket unless it was released
+   */
+  ~Lease();
+
+  /**
+   * Get the leased socket
+   * @return The socket, null once released
+   */
+  const socket::sock::Ptr& GetSock() const;
+
+  /**
+   * Whether the socket was used by a previous lease. A peer may close an idle connection at any time, so a request
+   * failing on a reused socket is worth retrying on a new one
+   * @return True if the socket was idle in the pool
+   */
+  bool IsReused() const;
+
+  /**
+   * Give the socket back to the pool for reuse. The socket, and any operation holding it, must not be used afterwards
+   */
+  void Release();
+
+ private:
+  friend class ConnectionPool;
+
+  /**
+   * Private constructor for this class
+   * @param pool   Pool lending the socket
+   * @param key    Host the socket is connected to, as host:port
+   * @param sock   Connected socket
+   * @param reused Whether the socket was used by a previous lease
+   */
+  Lease(connection_pool::WeakPtr pool, std::string key, socket::sock::Ptr sock, bool reused);
+
+  /**
+   * Hand the socket back to the pool
+   * @param reusable Whether the socket may be lent again
+   */
+  void Return(bool reusable);
+
+ private:
+  connection_pool::WeakPtr pool_;  ///< Pool lending the socket, may be destroyed first
+  std::string key_;                ///< Host the socket is connected to
+  socket::sock::Ptr sock_;         ///< Leased socket, null once returned
+  bool reused_;                    ///< Whether the socket was used by a previous lease
+};
+
+}  // namespace client
+}  // namespace tcp
+}  // namespace protocol
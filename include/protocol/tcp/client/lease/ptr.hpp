@@ -0,0 +1,25 @@
+#pragma once
+/**
+ * @file   protocol/tcp/client/lease/ptr.hpp
+ * @brief  Smart pointer declaration for protocol::tcp::client::Lease
+ */
+
+#include <boost/shared_ptr.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace client {
+
+class Lease;
+
+namespace lease {
+
+/**
+ * A mutable Lease pointer
+ */
+using Ptr = boost::shared_ptr<Lease>;
+
+}  // namespace lease
+}  // namespace client
+}  // namespace tcp
+}  // namespace protocol
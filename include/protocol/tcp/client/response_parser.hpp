@@ -0,0 +1,173 @@
+#pragma once
+/**
+ * @file   protocol/tcp/client/response_parser.hpp
+ * @brief  Class declaration of protocol::tcp::client::http::ResponseParser
+ */
+
+#include <boost/noncopyable.hpp>
+#include <boost/utility/string_ref.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace protocol {
+namespace tcp {
+namespace client {
+namespace http {
+
+/**
+ * Incremental HTTP/1.1 response parser. It walks the raw bytes of a response as they arrive and reports the status,
+ * each header and the body through callbacks, with views into the bytes passed in rather than copies, so parsing
+ * doesn't allocate. The status line and header lines are only parsed once complete: bytes of an incomplete line are
+ * left unconsumed and must be passed again, followed by the next bytes received. The body is decoded from the chunked
+ * transfer coding, delimited by Content-Length, or by the end of the stream when there is neither, and is empty for 1xx,
+ * 204 and 304 responses; an interim 1xx response is reported and followed by the final one. Trailer fields of a chunked
+ * body are reported through their own callback, so that they can't pass for headers. The header and trailer fields of
+ * a response, interim ones included, are bounded in number and size.
+ */
+class PROTOCOL_DLL_PUBLIC ResponseParser : boost::noncopyable {
+ public:
+  /**
+   * Status callback type, called with the status code and the reason phrase
+   */
+  using StatusCallback = std::function<void(int status, boost::string_ref reason)>;
+
+  /**
+   * Header callback type, called with the field name and the value stripped of surrounding whitespace
+   */
+  using HeaderCallback = std::function<void(boost::string_ref name, boost::string_ref value)>;
+
+  /**
+   * Body callback type, called with each slice of the body in order
+   */
+  using BodyCallback = std::function<void(boost::string_ref data)>;
+
+  static const size_t kMaxLineSize = 65536;     ///< Longest status or header line accepted
+  static const size_t kMaxFields = 256;         ///< Most header and trailer fields in a response
+  static const size_t kMaxHeaderSize = 262144;  ///< Most bytes of status, header and trailer lines in a response
+
+  /**
+   * Ctor
+   * @param on_status  Status callback, may be null
+   * @param on_header  Header callback, may be null
+   * @param on_body    Body callback, may be null
+   * @param on_trailer Trailer callback, called like on_header with the trailer fields of a chunked body, may be null
+   */
+  ResponseParser(const StatusCallback& on_status, const HeaderCallback& on_header, const BodyCallback& on_body,
+                 const HeaderCallback& on_trailer = HeaderCallback());
+
+  /**
+   * Parse the bytes following the ones consumed so far. Views passed to the callbacks are only valid during the call
+   * @param data Bytes received
+   * @param size Number of bytes
+   * @return Number of bytes consumed. Parsing stops at the end of the response, the bytes after it belong to the next
+   *         one
+   * @throws std::runtime_error if the response is malformed
+   */
+  size_t Parse(const char* data, size_t size);
+
+  /**
+   * Tell the parser that the peer closed the stream, which ends a body delimited by the end of the stream
+   * @throws std::runtime_error if the response is incomplete
+   */
+  void Finish();
+
+  /**
+   * Get ready for the next response on the same connection
+   */
+  void Reset();
+
+  /**
+   * Whether a whole response was parsed
+   * @return True if complete
+   */
+  bool IsComplete() const;
+
+  /**
+   * Whether the status line and the headers were parsed
+   * @return True once the body started
+   */
+  bool IsHeaderComplete() const;
+
+  /**
+   * Get the status code
+   * @return Status code, -1 until the status line was parsed
+   */
+  int GetStatus() const;
+
+  /**
+   * Whether the connection may carry another request after this response
+   * @return False for a response to close the connection, whose body ends with the stream, or that carries both a
+   *         chunked Transfer-Encoding and a Content-Length, which may have been framed differently by an intermediary
+   */
+  bool IsPersistent() const;
+
+ private:
+  /**
+   * Parsing state
+   */
+  enum class State {
+    kStatusLine,  ///< Waiting for the status line
+    kHeaders,     ///< Waiting for a header line or the blank line ending them
+    kBody,        ///< Reading a body of known length, or the data of a chunk
+    kBodyToEof,   ///< Reading a body until the end of the stream
+    kChunkSize,   ///< Waiting for a chunk size line
+    kChunkEnd,    ///< Waiting for the line ending the data of a chunk
+    kTrailers,    ///< Waiting for a trailer line or the blank line ending the chunked body
+    kComplete,    ///< Response complete
+  };
+
+  /**
+   * Get ready for the final response after an interim one, keeping the fields counted against the limits
+   */
+  void Restart();
+
+  /**
+   * Parse the status line
+   * @param line Line, without the line terminator
+   */
+  void ParseStatus(boost::string_ref line);
+
+  /**
+   * Parse a header line, or the blank line ending the headers
+   * @param line Line, without the line terminator
+   */
+  void ParseHeader(boost::string_ref line);
+
+  /**
+   * Parse a line of a chunked body
+   * @param line Line, without the line terminator
+   */
+  void ParseChunk(boost::string_ref line);
+
+  /**
+   * Split a header or trailer line and report it
+   * @param line     Line, without the line terminator
+   * @param name     Field name
+   * @param on_field Callback to report the field to
+   * @return Field value, stripped of surrounding whitespace
+   * @throws std::runtime_error past kMaxFields
+   */
+  boost::string_ref ParseField(boost::string_ref line, boost::string_ref& name, const HeaderCallback& on_field);
+
+ private:
+  StatusCallback on_status_;   ///< Status callback
+  HeaderCallback on_header_;   ///< Header callback
+  BodyCallback on_body_;       ///< Body callback
+  HeaderCallback on_trailer_;  ///< Trailer callback
+  State state_;                ///< Parsing state
+  int status_;                 ///< Status code
+  bool http10_;                ///< Whether the response is HTTP/1.0
+  bool has_length_;            ///< Whether a Content-Length was received
+  bool chunked_;               ///< Whether the body has the chunked transfer coding
+  uint64_t remaining_;         ///< Content-Length, then number of body or chunk bytes left
+  bool close_;                 ///< Whether the response asks to close the connection
+  bool keep_alive_;            ///< Whether the response asks to keep the connection open
+  size_t fields_;              ///< Header and trailer fields received
+  size_t header_size_;         ///< Bytes of status, header and trailer lines received
+};
+
+}  // namespace http
+}  // namespace client
+}  // namespace tcp
+}  // namespace protocol
@@ -4,18 +4,36 @@
  * @brief  Class declaration of protocol::tcp::server::Acceptor
  */
 
-#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/basic_socket_acceptor.hpp>
+#include <boost/asio/generic/stream_protocol.hpp>
+#include <boost/asio/ip/address.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/enable_shared_from_this.hpp>
 #include <boost/noncopyable.hpp>
 #include <boost/system/error_code.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
+#include <protocol/tcp/server/acceptor/config.hpp>
+#include <protocol/tcp/server/acceptor/stats.hpp>
+#include <protocol/tcp/socket/endpoint.hpp>
+#include <protocol/tcp/socket/options.hpp>
 #include <protocol/tcp/socket/ptr.hpp>
 
 namespace protocol {
 namespace tcp {
 namespace server {
 
+class Admission;
+
 /**
  * Bind to the specified endpoint and listens for incoming connection.
  * Once a client is connected performs a callback handing over the newly created socket which holds the client
@@ -25,7 +43,7 @@ class PROTOCOL_DLL_PUBLIC Acceptor : boost::noncopyable {
  public:
   /**
    * Callback performed when a new connection is established or an error occurs.
-   * The handler should be non-blocking.
+   * The handler should be non-blocking. With several listeners it is called concurrently from their workers.
    */
   using Callback = std::function<void(boost::system::error_code, Acceptor &, socket::sock::Ptr)>;
 
@@ -33,31 +51,243 @@ class PROTOCOL_DLL_PUBLIC Acceptor : boost::noncopyable {
    * Acceptor constructor
    * @param port          Service port to bind to
    * @param on_new_client Client callback (should be non-blocking)
+   * @param options       Socket options applied to each accepted socket. Buffer sizes are also set on the listening
+   *                      socket, so that accepted sockets inherit them before the handshake
+   */
+  Acceptor(uint16_t port, Callback on_new_client, const socket::Options& options = socket::Options());
+
+  /**
+   * Acceptor constructor, binds to all the IPv4 interfaces
+   * @param port          Service port to bind to, 0 picks an ephemeral port shared by all the listeners
+   * @param on_new_client Client callback (should be non-blocking)
+   * @param config        Listeners and options of the accepted sockets
+   * @throws boost::system::system_error if a listener can't be bound, or if several listeners are requested on a
+   * platform without SO_REUSEPORT
+   */
+  Acceptor(uint16_t port, Callback on_new_client, const acceptor::Config& config);
+
+  /**
+   * Acceptor constructor
+   * @param endpoint      Endpoint to bind to: a tcp::endpoint, IPv6 ones being dual-stack unless config.v6_only is
+   *                      set, or a local::stream_protocol::endpoint for a Unix domain socket. A socket file left at
+   *                      that path by a previous process is replaced, and the file is removed on destruction
+   * @param on_new_client Client callback (should be non-blocking)
+   * @param config        Listeners and options of the accepted sockets
+   * @throws std::invalid_argument if several listeners are requested on a Unix domain socket
+   * @throws boost::system::system_error if a listener can't be bound, or if several listeners are requested on a
+   * platform without SO_REUSEPORT
    */
-  Acceptor(uint16_t port, Callback on_new_client);
+  Acceptor(const socket::Endpoint& endpoint, Callback on_new_client,
+           const acceptor::Config& config = acceptor::Config());
 
   /**
-   * Dtor
+   * Dtor, waits for the callbacks running on other threads. Must not be called from the callback
    */
   ~Acceptor();
 
   /**
-   * Stop task scheduling and close acceptor
+   * Stop task scheduling and close acceptor. Each listener is closed on its own worker and the call returns once they
+   * all are, so it must not be made while holding a lock the callbacks of other workers may wait for
    */
   void Stop();
 
+  /**
+   * Get the port the listeners are bound to
+   * @return Port, 0 for a Unix domain socket
+   */
+  uint16_t GetPort() const;
+
+  /**
+   * Get the endpoint the listeners are bound to, with the ephemeral port picked by the system if any
+   * @return Endpoint
+   */
+  socket::Endpoint GetEndpoint() const;
+
+  /**
+   * Get the number of listening sockets
+   * @return Number of listeners
+   */
+  size_t GetListeners() const;
+
+  /**
+   * Get the admission counters
+   * @return Counters
+   */
+  acceptor::Stats GetStats() const;
+
  private:
+  using Listening = boost::asio::basic_socket_acceptor<boost::asio::generic::stream_protocol>;  ///< Of any family
+
+  /**
+   * A listening socket and the worker serving it
+   */
+  struct Listener {
+    /**
+     * Ctor
+     * @param service io_service of the worker
+     * @param worker  Position of the worker in the pool, -1 lets the placement policy bind accepted sockets
+     */
+    Listener(boost::asio::io_service &service, int worker)
+        : acceptor(service),
+          worker(worker),
+          spare(),
+          batch(),
+          parked(),
+          pending(0),
+          throttle(service),
+          throttled(false) {}
+
+    Listening acceptor;                    ///< Listening socket
+    int worker;                            ///< Worker the accepted sockets are bound to, -1 for any
+    socket::sock::Ptr spare;               ///< Socket left over by the last drain, used by the next accept
+    std::vector<socket::sock::Ptr> batch;  ///< Connections taken during the current wake-up, kept for its capacity
+    std::deque<socket::sock::Ptr> parked;  ///< Connections accepted while admission control held, taken first
+    size_t pending;                        ///< Outstanding accept operations
+
+    /**
+     * Waits for the accept rate to allow the next connection. Unlike service::Timer it may be cancelled from the
+     * thread destroying the acceptor
+     */
+    boost::asio::steady_timer throttle;
+    bool throttled;  ///< Whether throttle is waiting
+  };
+
+  /**
+   * Completion handlers running on the workers, so that destruction can wait for them
+   */
+  struct Guard {
+    /**
+     * Default ctor
+     */
+    Guard() : mutex(), idle(), alive(true), running(0) {}
+
+    /**
+     * Register a completion that is about to use the acceptor
+     * @return False if the acceptor was destroyed
+     */
+    bool Enter() {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!alive) return false;
+      ++running;
+      return true;
+    }
+
+    /**
+     * Unregister a completion once it no longer uses the acceptor
+     */
+    void Leave() {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (0 == --running) idle.notify_all();
+    }
+
+    std::mutex mutex;              ///< Protects alive and running
+    std::condition_variable idle;  ///< Notified when running drops to 0
+    bool alive;                    ///< Cleared on destruction, completions then return without touching the acceptor
+    size_t running;                ///< Completions currently using the acceptor
+  };
+
+  /**
+   * Open, bind and start every listener
+   * @param endpoint Endpoint to bind to
+   */
+  void Listen(socket::Endpoint endpoint);
+
   /**
    * Handle an incoming connection
-   * @param ec     Error code
-   * @param socket Socket that holds connection
+   * @param listener Listener that accepted the connection
+   * @param ec       Error code
+   * @param socket   Socket that holds connection
+   */
+  void HandleAccept(Listener &listener, const boost::system::error_code &ec, socket::sock::Ptr socket);
+
+  /**
+   * Keep pending_accepts accepts outstanding on a listener, as far as admission control allows
+   * @param listener Listener to accept on
+   */
+  void Arm(Listener &listener);
+
+  /**
+   * Start accepting the next connection, its slot is reserved once it completes
+   * @param listener Listener to accept on
+   */
+  void Accept(Listener &listener);
+
+  /**
+   * Reserve slots for the parked connections of a listener, then take the connections waiting in its backlog,
+   * without blocking
+   * @param listener Listener to accept on
+   */
+  void Drain(Listener &listener);
+
+  /**
+   * Hand the connections taken by a listener over to the callback
+   * @param listener Listener that took the connections
+   */
+  void HandOver(Listener &listener);
+
+  /**
+   * Wait for the accept rate to allow the next connection of a listener, then re-arm it
+   * @param listener Listener to pause
+   * @param wait_ms  Delay before a token is available
+   */
+  void Throttle(Listener &listener, size_t wait_ms);
+
+  /**
+   * Get a socket for the next connection of a listener
+   * @param listener Listener to accept on
+   * @return A socket bound to the worker of the listener
+   */
+  socket::sock::Ptr NewSocket(Listener &listener);
+
+  /**
+   * Admit an accepted connection, releasing its slot once the socket is destroyed
+   * @param sock Accepted socket
+   * @param ec   Set if the source address can't be read
+   * @return The socket to hand over, null if the connection isn't admitted
+   */
+  socket::sock::Ptr Admit(const socket::sock::Ptr &sock, boost::system::error_code &ec);
+
+  /**
+   * Forward an accept completion unless the acceptor was destroyed meanwhile
+   * @param guard    Guard of the acceptor
+   * @param acceptor Acceptor that started the operation
+   * @param listener Listener that accepted the connection
+   * @param ec       Error code
+   * @param socket   Socket that holds connection
+   */
+  static void OnAccept(const std::shared_ptr<Guard> &guard, Acceptor *acceptor, Listener *listener,
+                       const boost::system::error_code &ec, socket::sock::Ptr socket);
+
+  /**
+   * Re-arm a listener that waited for admission control, unless the acceptor was destroyed meanwhile
+   * @param guard    Guard of the acceptor
+   * @param acceptor Acceptor owning the listener
+   * @param listener Listener to re-arm
+   * @param expired  Whether the throttle of the listener expired, rather than a slot being released
+   */
+  static void OnResume(const std::shared_ptr<Guard> &guard, Acceptor *acceptor, Listener *listener, bool expired);
+
+  /**
+   * Re-arm every listener after a slot was released, from any thread
+   * @param guard    Guard of the acceptor
+   * @param acceptor Acceptor owning the listeners
+   */
+  static void Resume(const std::shared_ptr<Guard> &guard, Acceptor *acceptor);
+
+  /**
+   * Cancel the operations of a listener and close it, on its worker unless no thread runs the worker any more
+   * @param listener Listener to close
    */
-  void HandleAccept(const boost::system::error_code &ec, socket::sock::Ptr socket);
+  static void Close(Listener &listener);
 
  private:
-  bool stopped_;                             ///< Control variable
-  boost::asio::ip::tcp::acceptor acceptor_;  ///< TCP listener/acceptor
-  Callback on_new_client_;                   ///< Client callback
+  std::atomic<bool> stopped_;                         ///< Control variable
+  std::vector<std::unique_ptr<Listener>> listeners_;  ///< Listening sockets
+  Callback on_new_client_;                            ///< Client callback
+  acceptor::Config config_;                           ///< Listeners and options of the accepted sockets
+  std::shared_ptr<Guard> guard_;                      ///< Shared with the pending accepts, outlives the acceptor
+  std::shared_ptr<Admission> admission_;              ///< Shared with the handed over sockets, outlives the acceptor
+  std::string path_;                                  ///< Socket file of a Unix domain socket, removed on destruction
 };
 
 }  // namespace server
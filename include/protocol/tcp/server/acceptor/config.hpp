@@ -0,0 +1,80 @@
+#pragma once
+/**
+ * @file   protocol/tcp/server/acceptor/config.hpp
+ * @brief  Declaration of protocol::tcp::server::acceptor::Config
+ */
+
+#include <cstddef>
+
+#include <protocol/tcp/socket/options.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace server {
+namespace acceptor {
+
+/**
+ * Configuration of an Acceptor
+ */
+struct PROTOCOL_DLL_PUBLIC Config {
+  /**
+   * Default ctor, a single listening socket
+   */
+  Config()
+      : listeners(1),
+        pending_accepts(1),
+        accept_batch(32),
+        max_connections(0),
+        max_connections_per_ip(0),
+        accept_rate(0),
+        accept_burst(0),
+        v6_only(false),
+        options() {}
+
+  /**
+   * Number of listening sockets, 0 opens one per worker of the io_service pool. With more than one, every socket is
+   * bound to the same port with SO_REUSEPORT so that the kernel spreads new connections across them; listener i is
+   * served by worker i of the pool and hands over sockets bound to that same worker. A Unix domain socket endpoint
+   * takes a single listener.
+   */
+  size_t listeners;
+
+  size_t pending_accepts;  ///< Accept operations kept outstanding on each listener, at least 1
+
+  /**
+   * Most connections taken per wake-up of a listener. Once an accept completes, the listener keeps accepting without
+   * waiting until the backlog is empty or this many connections were taken, then hands them all over. At least 1
+   */
+  size_t accept_batch;
+
+  /**
+   * Most connections alive at once, 0 for no limit. A connection counts until the last reference to its socket is
+   * dropped; at the limit the listeners stop accepting, leaving new connections in the kernel backlog, and resume
+   * once a connection closes. The accepts already outstanding hold no slot and may still complete, their connections
+   * then wait to be handed over until a slot frees
+   */
+  size_t max_connections;
+
+  /**
+   * Most connections alive at once from one source address, 0 for no limit. The address is only known once a
+   * connection is accepted, so connections above the limit are closed right away and never handed over. Connections
+   * over Unix domain sockets have no source address and aren't limited
+   */
+  size_t max_connections_per_ip;
+
+  double accept_rate;   ///< Connections accepted per second, 0 for no limit. Above the rate they wait in the backlog
+  size_t accept_burst;  ///< Connections that may be accepted at once after an idle period, 0 is one second worth
+
+  /**
+   * Whether a listener bound to an IPv6 endpoint only accepts IPv6 connections (IPV6_V6ONLY). By default it is
+   * dual-stack and also accepts IPv4 connections, whose source addresses are reported as IPv4-mapped
+   */
+  bool v6_only;
+
+  socket::Options options;  ///< Socket options applied to each accepted socket
+};
+
+}  // namespace acceptor
+}  // namespace server
+}  // namespace tcp
+}  // namespace protocol
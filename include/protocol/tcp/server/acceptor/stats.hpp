@@ -0,0 +1,28 @@
+#pragma once
+/**
+ * @file   protocol/tcp/server/acceptor/stats.hpp
+ * @brief  Declaration of protocol::tcp::server::acceptor::Stats
+ */
+
+#include <cstddef>
+
+namespace protocol {
+namespace tcp {
+namespace server {
+namespace acceptor {
+
+/**
+ * Admission counters of an Acceptor
+ */
+struct PROTOCOL_DLL_PUBLIC Stats {
+  size_t accepted;   ///< Connections handed over to the callback
+  size_t active;     ///< Handed over connections whose socket is still alive
+  size_t rejected;   ///< Connections closed right away because their source address reached its limit
+  size_t paused;     ///< Times accepting paused because max_connections was reached
+  size_t throttled;  ///< Times a listener waited for the accept rate to allow another connection
+};
+
+}  // namespace acceptor
+}  // namespace server
+}  // namespace tcp
+}  // namespace protocol
@@ -13,6 +13,7 @@
 #include <istream>
 
 #include <protocol/tcp/socket/buffer/ptr.hpp>
+#include <protocol/tcp/socket/buffer_pool.hpp>
 
 namespace protocol {
 namespace tcp {
@@ -24,13 +25,13 @@ namespace socket {
 class PROTOCOL_DLL_PUBLIC Buffer : public boost::enable_shared_from_this<Buffer> {
  public:
   /**
-   * Create a Buffer instance and initialise it
+   * Get a Buffer instance from the BufferPool and initialise it
    * @param val Value to stream to buffer
    * @return A Buffer::ptr object
    */
   template <typename T>
   static buffer::Ptr Create(const T& val) {
-    buffer::Ptr new_ = buffer::Ptr(new Buffer());
+    buffer::Ptr new_ = BufferPool::Acquire();
     *new_ << val;
     return new_;
   }
@@ -105,6 +106,14 @@ class PROTOCOL_DLL_PUBLIC Buffer : public boost::enable_shared_from_this<Buffer>
     buffer_.consume(buffer_.size());
   }
 
+  /**
+   * Get the number of bytes the streambuf storage holds, whatever its content
+   * @return Storage size
+   */
+  size_t GetCapacity() const {
+    return buffer_.GetCapacity();
+  }
+
   /**
    * Get a string created with the buffer's contents. Doesn't consume the buffer
    * @return String with buffer contents
@@ -114,7 +123,21 @@ class PROTOCOL_DLL_PUBLIC Buffer : public boost::enable_shared_from_this<Buffer>
   }
 
  private:
-  boost::asio::streambuf buffer_;  ///<  The boost stream buffer
+  /**
+   * boost::asio::streambuf that reports the size of its storage
+   */
+  class Streambuf : public boost::asio::streambuf {
+   public:
+    /**
+     * Get the size of the storage, which only grows
+     * @return Storage size
+     */
+    size_t GetCapacity() const {
+      return epptr() - eback();
+    }
+  };
+
+  Streambuf buffer_;               ///<  The boost stream buffer
   std::ostream os_;                ///< Output stream for buffer_
   std::istream is_;                ///< Input stream for buffer_
 };
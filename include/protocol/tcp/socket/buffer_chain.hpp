@@ -0,0 +1,128 @@
+#pragma once
+/**
+ * @file   protocol/tcp/socket/buffer_chain.hpp
+ * @brief  Class declaration of protocol::tcp::socket::BufferChain
+ */
+
+#include <boost/asio/buffer.hpp>
+#include <boost/shared_ptr.hpp>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <protocol/tcp/socket/buffer/ptr.hpp>
+#include <protocol/tcp/socket/buffer_chain/ptr.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+
+/**
+ * Ordered list of borrowed memory slices sent with a single gathered write. Slices aren't copied; each one may carry
+ * an owner handle that keeps its memory alive for as long as the chain, and the memory must not change until the
+ * write that sends it has completed.
+ */
+class PROTOCOL_DLL_PUBLIC BufferChain {
+ public:
+  using Owner = boost::shared_ptr<const void>;  ///< Handle keeping the memory of a slice alive
+
+  /**
+   * Lightweight view over the slices of a chain, models asio's ConstBufferSequence without copying the slice list
+   */
+  class ConstBuffers {
+   public:
+    using value_type = boost::asio::const_buffer;                                     ///< Element type
+    using const_iterator = std::vector<boost::asio::const_buffer>::const_iterator;  ///< Iterator type
+
+    /**
+     * Ctor
+     * @param buffers Slices to view
+     */
+    explicit ConstBuffers(const std::vector<boost::asio::const_buffer>& buffers) : buffers_(&buffers) {}
+
+    /**
+     * Get an iterator to the first slice
+     * @return Iterator
+     */
+    const_iterator begin() const {
+      return buffers_->begin();
+    }
+
+    /**
+     * Get an iterator past the last slice
+     * @return Iterator
+     */
+    const_iterator end() const {
+      return buffers_->end();
+    }
+
+   private:
+    const std::vector<boost::asio::const_buffer>* buffers_;  ///< Viewed slices
+  };
+
+  /**
+   * Create an empty BufferChain instance
+   * @return A shared pointer to the new chain
+   */
+  static buffer_chain::Ptr Create();
+
+  /**
+   * Default ctor for BufferChain
+   */
+  BufferChain() : buffers_(), owners_(), size_(0) {}
+
+  /**
+   * Append a slice
+   * @param data  Memory to send
+   * @param size  Number of bytes to send
+   * @param owner Handle keeping the memory alive, may be null when the memory outlives the write
+   * @return A reference to this chain
+   */
+  BufferChain& Append(const void* data, size_t size, Owner owner = Owner());
+
+  /**
+   * Append the readable content of a buffer, which is not consumed
+   * @param buffer Buffer to send
+   * @return A reference to this chain
+   */
+  BufferChain& Append(const buffer::Ptr& buffer);
+
+  /**
+   * Append the content of a string
+   * @param str String to send
+   * @return A reference to this chain
+   */
+  BufferChain& Append(const boost::shared_ptr<const std::string>& str);
+
+  /**
+   * Remove every slice and release the owners
+   */
+  void Clear();
+
+  /**
+   * Get the slices
+   * @return A buffer sequence over the slices
+   */
+  ConstBuffers GetBuffers() const;
+
+  /**
+   * Get the number of slices
+   * @return Number of slices
+   */
+  size_t GetCount() const;
+
+  /**
+   * Get the total number of bytes
+   * @return Number of bytes
+   */
+  size_t GetSize() const;
+
+ private:
+  std::vector<boost::asio::const_buffer> buffers_;  ///< Slices in sending order
+  std::vector<Owner> owners_;                       ///< Owners of the slices
+  size_t size_;                                     ///< Total number of bytes
+};
+
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
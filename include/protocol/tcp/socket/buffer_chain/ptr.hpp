@@ -0,0 +1,23 @@
+#pragma once
+/**
+ * @file   protocol/tcp/socket/buffer_chain/ptr.hpp
+ * @brief  Smart pointer declaration for protocol::tcp::socket::BufferChain
+ */
+
+#include <boost/shared_ptr.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+class BufferChain;
+namespace buffer_chain {
+
+/**
+ * A mutable BufferChain pointer
+ */
+using Ptr = boost::shared_ptr<BufferChain>;
+
+}  // namespace buffer_chain
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
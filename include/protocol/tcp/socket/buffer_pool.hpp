@@ -0,0 +1,69 @@
+#pragma once
+/**
+ * @file   protocol/tcp/socket/buffer_pool.hpp
+ * @brief  Class declaration of protocol::tcp::socket::BufferPool
+ */
+
+#include <cstddef>
+
+#include <protocol/tcp/socket/buffer/ptr.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+
+/**
+ * Recycles Buffer instances, together with their streambuf storage and streams, across messages. Each thread keeps
+ * one free list per size class; a buffer goes back to the free list of the thread that drops its last reference, or
+ * is destroyed when that list is full. A buffer is filed on release under the largest class its storage holds, so a
+ * buffer that grew moves up, and one whose storage outgrew the largest class is destroyed rather than kept.
+ */
+class PROTOCOL_DLL_PUBLIC BufferPool {
+ public:
+  static const size_t kNumClasses = 4;              ///< Number of size classes
+  static const size_t kClassSizes[kNumClasses];     ///< Storage reserved for each size class, in bytes
+
+  /**
+   * Counters of the pool, aggregated over all threads
+   */
+  struct Stats {
+    size_t hits;      ///< Acquisitions served from a free list
+    size_t misses;    ///< Acquisitions that created a Buffer
+    size_t recycled;  ///< Releases that went back to a free list
+    size_t dropped;   ///< Releases that destroyed the Buffer
+  };
+
+  /**
+   * Get an empty buffer
+   * @param size_hint Number of bytes the buffer is expected to hold, larger than the largest class isn't pooled
+   * @return A shared pointer to the buffer, which returns it to the pool when released
+   */
+  static buffer::Ptr Acquire(size_t size_hint = 0);
+
+  /**
+   * Set the maximum number of buffers each thread keeps per size class, 0 disables recycling
+   * @param max_buffers Maximum number of buffers
+   */
+  static void SetCapacity(size_t max_buffers);
+
+  /**
+   * Get the maximum number of buffers each thread keeps per size class
+   * @return Maximum number of buffers
+   */
+  static size_t GetCapacity();
+
+  /**
+   * Destroy the buffers kept by the calling thread
+   */
+  static void Clear();
+
+  /**
+   * Get the pool counters
+   * @return The counters
+   */
+  static Stats GetStats();
+};
+
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
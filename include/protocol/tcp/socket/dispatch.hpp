@@ -0,0 +1,93 @@
+#pragma once
+/**
+ * @file   protocol/tcp/socket/dispatch.hpp
+ * @brief  Declaration of protocol::tcp::socket::Dispatch
+ */
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/strand.hpp>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+
+/**
+ * Policy deciding how an operation calls its client callback once it completes
+ */
+struct PROTOCOL_DLL_PUBLIC Dispatch {
+  /**
+   * How the callback is called
+   */
+  enum class Mode {
+    kPost,    ///< Queued on the io_service of the socket, runs after the completion handler returns
+    kInline,  ///< Called directly by the completion handler, on the I/O thread
+    kStrand,  ///< Dispatched through a strand, serialised with the other handlers of that strand
+  };
+
+  /**
+   * Default ctor, posts the callback
+   */
+  Dispatch() : mode(Mode::kPost), strand() {}
+
+  /**
+   * Get a policy posting the callback
+   * @return The policy
+   */
+  static Dispatch Post() {
+    return Dispatch();
+  }
+
+  /**
+   * Get a policy calling the callback inline, the callback must not block the I/O thread
+   * @return The policy
+   */
+  static Dispatch Inline() {
+    Dispatch dispatch;
+    dispatch.mode = Mode::kInline;
+    return dispatch;
+  }
+
+  /**
+   * Get a policy dispatching the callback through a strand
+   * @param strand Strand to dispatch through
+   * @return The policy
+   */
+  static Dispatch OnStrand(std::shared_ptr<boost::asio::io_service::strand> strand) {
+    if (!strand) throw std::invalid_argument("Strand can't be null");
+    Dispatch dispatch;
+    dispatch.mode = Mode::kStrand;
+    dispatch.strand = std::move(strand);
+    return dispatch;
+  }
+
+  /**
+   * Call a handler according to the policy
+   * @param service io_service of the completed operation
+   * @param handler Handler calling the client callback
+   */
+  template <typename Handler>
+  void Invoke(boost::asio::io_service& service, Handler handler) const {
+    switch (mode) {
+      case Mode::kInline:
+        handler();
+        break;
+      case Mode::kStrand:
+        strand->dispatch(std::move(handler));
+        break;
+      case Mode::kPost:
+      default:
+        service.post(std::move(handler));
+        break;
+    }
+  }
+
+  Mode mode;                                               ///< How the callback is called
+  std::shared_ptr<boost::asio::io_service::strand> strand;  ///< Strand used with Mode::kStrand
+};
+
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
@@ -0,0 +1,66 @@
+#pragma once
+/**
+ * @file   protocol/tcp/socket/endpoint.hpp
+ * @brief  Declaration of protocol::tcp::socket::Endpoint helpers
+ */
+
+#include <boost/asio/generic/stream_protocol.hpp>
+#include <boost/asio/ip/address.hpp>
+#include <cstdint>
+#include <string>
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+
+/**
+ * Endpoint of a stream socket of any family. Converts implicitly from boost::asio::ip::tcp::endpoint and
+ * boost::asio::local::stream_protocol::endpoint
+ */
+using Endpoint = boost::asio::generic::stream_protocol::endpoint;
+
+/**
+ * Whether an endpoint is an IPv4 or IPv6 one
+ * @param endpoint Endpoint
+ * @return True for IP endpoints, false for Unix domain sockets
+ */
+PROTOCOL_DLL_PUBLIC bool IsIp(const Endpoint& endpoint);
+
+/**
+ * Get the address of an IP endpoint. IPv4-mapped IPv6 addresses, as seen by dual-stack listeners, are reported as IPv4
+ * @param endpoint Endpoint
+ * @return Address, unspecified if the endpoint isn't an IP one
+ */
+PROTOCOL_DLL_PUBLIC boost::asio::ip::address GetAddress(const Endpoint& endpoint);
+
+/**
+ * Get the port of an IP endpoint
+ * @param endpoint Endpoint
+ * @return Port, 0 if the endpoint isn't an IP one
+ */
+PROTOCOL_DLL_PUBLIC uint16_t GetPort(const Endpoint& endpoint);
+
+/**
+ * Get the path of a Unix domain socket endpoint
+ * @param endpoint Endpoint
+ * @return Path, starting with a null character for an abstract socket, empty for other families
+ */
+PROTOCOL_DLL_PUBLIC std::string GetPath(const Endpoint& endpoint);
+
+/**
+ * Get the host part of an endpoint, as sent in an HTTP Host header
+ * @param endpoint Endpoint
+ * @return The address, bracketed for IPv6, "localhost" for a Unix domain socket
+ */
+PROTOCOL_DLL_PUBLIC std::string GetHost(const Endpoint& endpoint);
+
+/**
+ * Format an endpoint for logging
+ * @param endpoint Endpoint
+ * @return "address:port" for IP endpoints, "unix:path" for Unix domain sockets
+ */
+PROTOCOL_DLL_PUBLIC std::string ToString(const Endpoint& endpoint);
+
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
@@ -0,0 +1,144 @@
+#pragma once
+/**
+ * @file   protocol/tcp/socket/handler_memory.hpp
+ * @brief  Declaration of protocol::tcp::socket::HandlerMemory and handler allocation hooks
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <boost/noncopyable.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+
+/**
+ * Memory block recycled by the asynchronous operations of one I/O object. An object has a single operation in
+ * flight at a time and asio releases an operation's memory before calling its handler, so the next operation started
+ * from the handler reuses the same block and a steady-state loop doesn't touch the heap. Requests that don't fit or
+ * arrive while the block is in use fall back to the heap. Allocate and Deallocate aren't synchronized: an instance
+ * must only be used by the operations of a single strand, such as the chain of one I/O object.
+ */
+class PROTOCOL_DLL_PUBLIC HandlerMemory : boost::noncopyable {
+ public:
+  static const size_t kSize = 1024;  ///< Size of the recycled block in bytes
+
+  /**
+   * Default ctor
+   */
+  HandlerMemory() : in_use_(false), hits_(0), misses_(0) {}
+
+  /**
+   * Allocate memory for a handler
+   * @param size Number of bytes
+   * @return Pointer to the memory
+   */
+  void* Allocate(size_t size) {
+    if (!in_use_ && size <= sizeof(storage_)) {
+      in_use_ = true;
+      ++hits_;
+      return &storage_;
+    }
+    ++misses_;
+    return ::operator new(size);
+  }
+
+  /**
+   * Release memory obtained with Allocate()
+   * @param pointer Pointer to the memory
+   */
+  void Deallocate(void* pointer) {
+    if (pointer == &storage_) {
+      in_use_ = false;
+    } else {
+      ::operator delete(pointer);
+    }
+  }
+
+  /**
+   * Get the number of allocations served by the recycled block
+   * @return Number of allocations
+   */
+  size_t GetHits() const {
+    return hits_;
+  }
+
+  /**
+   * Get the number of allocations that fell back to the heap
+   * @return Number of allocations
+   */
+  size_t GetMisses() const {
+    return misses_;
+  }
+
+ private:
+  typename std::aligned_storage<kSize>::type storage_;  ///< The recycled block
+  bool in_use_;                                         ///< Whether storage_ is allocated, owned by the strand
+  std::atomic<size_t> hits_;                            ///< Allocations served by storage_
+  std::atomic<size_t> misses_;                          ///< Allocations served by the heap
+};
+
+/**
+ * Wraps a completion handler so that asio allocates the operation it belongs to from a HandlerMemory
+ */
+template <typename Handler>
+class AllocHandler {
+ public:
+  /**
+   * Ctor
+   * @param memory  Memory to allocate from, must outlive the operation
+   * @param handler Wrapped handler
+   */
+  AllocHandler(HandlerMemory& memory, Handler handler) : memory_(memory), handler_(std::move(handler)) {}
+
+  /**
+   * Forward the completion to the wrapped handler
+   * @param args Completion arguments
+   */
+  template <typename... Args>
+  void operator()(Args&&... args) {
+    handler_(std::forward<Args>(args)...);
+  }
+
+  /**
+   * asio allocation hook
+   * @param size         Number of bytes
+   * @param this_handler Handler the memory is for
+   * @return Pointer to the memory
+   */
+  friend void* asio_handler_allocate(std::size_t size, AllocHandler<Handler>* this_handler) {
+    return this_handler->memory_.Allocate(size);
+  }
+
+  /**
+   * asio deallocation hook
+   * @param pointer      Pointer to the memory
+   * @param this_handler Handler the memory was for
+   */
+  friend void asio_handler_deallocate(void* pointer, std::size_t, AllocHandler<Handler>* this_handler) {
+    this_handler->memory_.Deallocate(pointer);
+  }
+
+ private:
+  HandlerMemory& memory_;  ///< Memory to allocate from
+  Handler handler_;        ///< Wrapped handler
+};
+
+/**
+ * Helper to wrap a handler with AllocHandler
+ * @param memory  Memory to allocate from, must outlive the operation
+ * @param handler Handler to wrap
+ * @return The wrapped handler
+ */
+template <typename Handler>
+inline AllocHandler<Handler> MakeAllocHandler(HandlerMemory& memory, Handler handler) {
+  return AllocHandler<Handler>(memory, std::move(handler));
+}
+
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
@@ -0,0 +1,78 @@
+#pragma once
+/**
+ * @file   protocol/tcp/socket/options.hpp
+ * @brief  Declaration of protocol::tcp::socket::Options
+ */
+
+#include <boost/system/error_code.hpp>
+#include <cstddef>
+
+#include <protocol/tcp/socket/ptr.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+
+/**
+ * Socket options applied when a connection is established. Every member left at its default keeps the system default,
+ * so a default constructed instance doesn't touch the socket.
+ */
+struct PROTOCOL_DLL_PUBLIC Options {
+  /**
+   * Default ctor
+   */
+  Options()
+      : no_delay(false),
+        quick_ack(false),
+        send_buffer_size(0),
+        receive_buffer_size(0),
+        keep_alive(false),
+        keep_alive_idle_s(0),
+        keep_alive_interval_s(0),
+        keep_alive_count(0),
+        user_timeout_ms(0),
+        busy_poll_us(0) {}
+
+  bool no_delay;                   ///< Disable Nagle's algorithm (TCP_NODELAY), small writes are sent immediately
+  bool quick_ack;                  ///< Leave delayed ACK mode at setup (TCP_QUICKACK), the kernel may re-enter it
+  size_t send_buffer_size;         ///< Kernel send buffer size in bytes (SO_SNDBUF), 0 keeps the default
+  size_t receive_buffer_size;      ///< Kernel receive buffer size in bytes (SO_RCVBUF), 0 keeps the default
+  bool keep_alive;                 ///< Send keepalive probes on idle connections (SO_KEEPALIVE)
+  unsigned keep_alive_idle_s;      ///< Idle time before the first probe (TCP_KEEPIDLE), 0 keeps the default
+  unsigned keep_alive_interval_s;  ///< Time between probes (TCP_KEEPINTVL), 0 keeps the default
+  unsigned keep_alive_count;       ///< Unanswered probes before dropping the connection (TCP_KEEPCNT), 0 is default
+  unsigned user_timeout_ms;        ///< Longest time sent data may stay unacknowledged (TCP_USER_TIMEOUT), 0 is default
+  unsigned busy_poll_us;           ///< Busy poll on blocking reads (SO_BUSY_POLL), skipped without CAP_NET_ADMIN
+};
+
+/**
+ * Whether a write corks the socket, so that it and the following writes are coalesced into full segments
+ */
+enum class Cork {
+  kNone,    ///< Leave the socket as it is
+  kCork,    ///< Cork the socket before writing, typically on the first part of a multi-part message
+  kUncork,  ///< Uncork the socket once the write completes, flushing any partial segment of the message
+};
+
+/**
+ * Apply options to an open socket. Buffer sizes should be applied before connecting, or on the listening socket, for
+ * the window scaling to account for them. TCP level options are skipped on Unix domain sockets
+ * @param options Options to apply
+ * @param sock    Socket in the open state
+ * @return The error of the first option that couldn't be applied, operation_not_supported for options this platform
+ * lacks. A busy poll time the process may not raise is logged and skipped
+ */
+PROTOCOL_DLL_PUBLIC boost::system::error_code Apply(const Options& options, sock::Socket& sock);
+
+/**
+ * Cork or uncork a socket (TCP_CORK, TCP_NOPUSH on BSD). While corked, partial segments are held back until the socket
+ * is uncorked
+ * @param sock   Socket in the open state
+ * @param corked Whether to cork the socket
+ * @return Error, operation_not_supported if this platform can't cork
+ */
+PROTOCOL_DLL_PUBLIC boost::system::error_code SetCork(sock::Socket& sock, bool corked);
+
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
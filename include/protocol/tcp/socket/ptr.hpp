@@ -1,10 +1,10 @@
 #pragma once
 /**
  * @file   protocol/tcp/socket/ptr.hpp
- * @brief  Smart pointer declarations for boost::asio::ip::tcp::socket
+ * @brief  Smart pointer declarations for boost::asio::generic::stream_protocol::socket
  */
 
-#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/generic/stream_protocol.hpp>
 #include <memory>
 
 namespace protocol {
@@ -12,7 +12,11 @@ namespace tcp {
 namespace socket {
 namespace sock {
 
-using Ptr = std::shared_ptr<boost::asio::ip::tcp::socket>;  ///< Shared pointer to boost asio socket type
+/**
+ * Stream socket of any family, TCP over IPv4 or IPv6 as well as Unix domain sockets
+ */
+using Socket = boost::asio::generic::stream_protocol::socket;
+using Ptr = std::shared_ptr<Socket>;  ///< Shared pointer to boost asio socket type
 
 }  // namespace sock
 }  // namespace socket
@@ -0,0 +1,130 @@
+#pragma once
+/**
+ * @file   protocol/tcp/socket/read_loop.hpp
+ * @brief  Class declaration of protocol::tcp::socket::ReadLoop
+ */
+
+#include <boost/asio/buffer.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/system/error_code.hpp>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+#include <protocol/service/timer_wheel.hpp>
+#include <protocol/tcp/socket/buffer/ptr.hpp>
+#include <protocol/tcp/socket/handler_memory.hpp>
+#include <protocol/tcp/socket/ptr.hpp>
+#include <protocol/tcp/socket/read_loop/ptr.hpp>
+#include <protocol/tcp/socket/read_one.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+
+/**
+ * Reads a stream of frames from a socket until stopped or an error occurs. A single buffer is kept for the lifetime
+ * of the loop: every frame found by the stream condition is handed to the callback, which runs inline on the I/O
+ * thread, then consumed, and the bytes received past it are parsed as the start of the next frame. A condition
+ * matching an empty frame ends the loop with invalid_argument.
+ */
+class PROTOCOL_DLL_PUBLIC ReadLoop : public boost::enable_shared_from_this<ReadLoop>, boost::noncopyable {
+ public:
+  /**
+   * Callback type, called with no error for every frame and once with the error that ends the loop
+   */
+  using Callback = std::function<void(boost::system::error_code, read_loop::Ptr)>;
+
+  /**
+   * Create a ReadLoop instance and start reading
+   * @param sock             Input socket in the open state
+   * @param stream_condition Incremental functor that determines where each frame ends
+   * @param on_frame         Callback called for every frame and when the loop ends
+   * @param timeout_ms       Longest time without receiving data in milliseconds, a value of 0 implies no timeout
+   * @return A shared_ptr to a newly created ReadLoop instance
+   */
+  static read_loop::Ptr Start(sock::Ptr sock, const ReadOne::StreamCondition& stream_condition,
+                              const Callback& on_frame, const size_t timeout_ms);
+
+  /**
+   * Private constructor for this class
+   * @param sock             Input socket in the open state
+   * @param stream_condition Incremental functor that determines where each frame ends
+   * @param on_frame         Callback called for every frame and when the loop ends
+   */
+  ReadLoop(sock::Ptr sock, const ReadOne::StreamCondition& stream_condition, const Callback& on_frame);
+
+  /**
+   * Stop the loop, no callback is called afterwards
+   */
+  void Stop();
+
+  /**
+   * Get the underlying socket
+   * @return socket
+   */
+  const sock::Ptr& GetSock() const;
+
+  /**
+   * Get the input buffer, the current frame is at its start
+   * @return buffer
+   */
+  const socket::buffer::Ptr GetBuffer() const;
+
+  /**
+   * Get the current frame, only valid during the callback
+   * @return The frame bytes
+   */
+  boost::asio::const_buffer GetFrame() const;
+
+  /**
+   * Get the memory the asynchronous operations are allocated from
+   * @return handler memory
+   */
+  const HandlerMemory& GetHandlerMemory() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;  ///< Time source of the inactivity timeout
+
+  /**
+   * Start the loop with the given timeout value
+   * @param timeout_ms Longest time without receiving data in milliseconds, a value of 0 implies no timeout
+   */
+  void Start(const size_t timeout_ms);
+
+  /**
+   * Deliver the frames already buffered, then wait for more data
+   */
+  void Read();
+
+  /**
+   * Handler for the read operation
+   * @param ec    Error code
+   * @param bytes Number of bytes read
+   */
+  void OnRead(const boost::system::error_code& ec, std::size_t bytes);
+
+  /**
+   * Handler for timer
+   */
+  void OnTimeout();
+
+ private:
+  bool stopped_;                               ///< Control variable
+  sock::Ptr sock_;                             ///< Network socket resource
+  buffer::Ptr buffer_;                         ///< Input buffer
+  ReadOne::StreamCondition stream_condition_;  ///< Condition that delimits frames
+  size_t scanned_;                             ///< Buffered bytes already passed to stream_condition_
+  size_t frame_size_;                          ///< Size of the current frame
+  size_t timeout_ms_;                          ///< Inactivity timeout
+  Clock::time_point last_read_;                ///< Time data was last received
+  std::unique_ptr<service::Timer> deadline_;   ///< Deadline timer
+  Callback on_frame_callback_;                 ///< Client callback
+  HandlerMemory handler_memory_;               ///< Recycled memory of the read operations
+};
+
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
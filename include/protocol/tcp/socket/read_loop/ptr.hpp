@@ -0,0 +1,23 @@
+#pragma once
+/**
+ * @file   protocol/tcp/socket/read_loop/ptr.hpp
+ * @brief  Smart pointer declarations for protocol::tcp::socket::ReadLoop
+ */
+
+#include <boost/shared_ptr.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+class ReadLoop;
+namespace read_loop {
+
+/**
+ * A mutable ReadLoop pointer
+ */
+using Ptr = boost::shared_ptr<ReadLoop>;
+
+}  // namespace read_loop
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
@@ -5,7 +5,6 @@
  */
 
 #include <boost/asio/buffers_iterator.hpp>
-#include <boost/asio/deadline_timer.hpp>
 #include <boost/asio/io_service.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/streambuf.hpp>
@@ -20,9 +19,12 @@
 #include <vector>
 #include <boost/asio/coroutine.hpp>
 
+#include <protocol/service/timer_wheel.hpp>
 #include <protocol/tcp/socket/read_one/ptr.hpp>
 #include <protocol/tcp/socket/ptr.hpp>
 #include <protocol/tcp/socket/buffer/ptr.hpp>
+#include <protocol/tcp/socket/dispatch.hpp>
+#include <protocol/tcp/socket/handler_memory.hpp>
 
 namespace protocol {
 namespace tcp {
@@ -33,9 +35,23 @@ namespace socket {
  */
 class PROTOCOL_DLL_PUBLIC ReadOne : public boost::enable_shared_from_this<ReadOne>, boost::asio::coroutine {
  public:
-  using Callback = std::function<void(boost::system::error_code, read_one::Ptr)>;              ///< Callback type
-  using Iterator = boost::asio::buffers_iterator<boost::asio::streambuf::const_buffers_type>;  ///< Alias for iterator
-  using StopCondition = std::function<std::pair<Iterator, bool>(Iterator, Iterator)>;          ///< Match condition type
+  using Callback = std::function<void(boost::system::error_code, read_one::Ptr)>;  ///< Callback type
+
+  /**
+   * Iterator over the input sequence of the streambuf. That sequence is a single contiguous buffer, so a condition
+   * may read the bytes of [begin, end) through &*begin
+   */
+  using Iterator = boost::asio::buffers_iterator<boost::asio::streambuf::const_buffers_type>;
+  using StopCondition = std::function<std::pair<Iterator, bool>(Iterator, Iterator)>;  ///< Match condition type
+
+  /**
+   * Incremental match condition. It is called with the bytes that arrived since its previous call only, so it must
+   * keep its own state across calls and reset it after a match. The first member of the return value is the number of
+   * bytes of the given range up to the end of the match, the second is true if a match has been found.
+   */
+  using StreamCondition = std::function<std::pair<size_t, bool>(const char* data, size_t size)>;
+
+  static const size_t kStreamReadSize = 4096;  ///< Bytes requested per read in streaming mode
 
   /**
    * Create a ReadOne instance and starts the asynchronous operation
@@ -43,18 +59,43 @@ class PROTOCOL_DLL_PUBLIC ReadOne : public boost::enable_shared_from_this<ReadOn
    * @param stop_condition  Functor that determines when operation has completed
    * @param on_done         Callback called when operation has completed
    * @param timeout_ms      Timeout value in milliseconds, a value of 0 implies no timeout
+   * @param dispatch        How on_done is called upon completion
    * @return A shared_ptr to a newly created ReadOne instance
    */
-  static read_one::Ptr Start(
-      sock::Ptr sock, const StopCondition& stop_condition, const Callback& on_done, const size_t timeout_ms);
+  static read_one::Ptr Start(sock::Ptr sock, const StopCondition& stop_condition, const Callback& on_done,
+                             const size_t timeout_ms, const Dispatch& dispatch = Dispatch());
+
+  /**
+   * Create a ReadOne instance that scans every received byte only once and starts the asynchronous operation
+   * @param sock             Input socket in the open state
+   * @param stream_condition Incremental functor that determines when operation has completed
+   * @param on_done          Callback called when operation has completed
+   * @param timeout_ms       Timeout value in milliseconds, a value of 0 implies no timeout
+   * @param dispatch         How on_done is called upon completion
+   * @return A shared_ptr to a newly created ReadOne instance
+   */
+  static read_one::Ptr StartStreaming(sock::Ptr sock, const StreamCondition& stream_condition, const Callback& on_done,
+                                      const size_t timeout_ms, const Dispatch& dispatch = Dispatch());
 
   /**
    * Private constructor for this class
    * @param sock            Input socket in the open state
    * @param stop_condition  Functor that determines when operation has completed
    * @param on_done         Callback called when operation has completed
+   * @param dispatch        How on_done is called upon completion
+   */
+  ReadOne(sock::Ptr sock, const StopCondition& stop_condition, const Callback& on_done,
+          const Dispatch& dispatch = Dispatch());
+
+  /**
+   * Private constructor for the streaming mode
+   * @param sock             Input socket in the open state
+   * @param stream_condition Incremental functor that determines when operation has completed
+   * @param on_done          Callback called when operation has completed
+   * @param dispatch         How on_done is called upon completion
    */
-  ReadOne(sock::Ptr sock, const StopCondition& stop_condition, const Callback& on_done);
+  ReadOne(sock::Ptr sock, const StreamCondition& stream_condition, const Callback& on_done,
+          const Dispatch& dispatch = Dispatch());
 
   /**
    * Stop the operation
@@ -67,12 +108,25 @@ class PROTOCOL_DLL_PUBLIC ReadOne : public boost::enable_shared_from_this<ReadOn
    */
   const sock::Ptr& GetSock() const;
 
+  /**
+   * Get the memory the asynchronous operations are allocated from
+   * @return handler memory
+   */
+  const HandlerMemory& GetHandlerMemory() const;
+
   /**
    * Get the input buffer
    * @return buffer
    */
   const socket::buffer::Ptr GetBuffer() const;
 
+  /**
+   * Get the number of bytes at the start of the buffer up to the end of the match, bytes past it were received along
+   * with the message
+   * @return Number of bytes
+   */
+  size_t GetMatchSize() const;
+
  private:
   /**
    * Start the operation with the given timeout value
@@ -87,6 +141,18 @@ class PROTOCOL_DLL_PUBLIC ReadOne : public boost::enable_shared_from_this<ReadOn
    */
   void operator()(boost::system::error_code ec, std::size_t bytes);
 
+  /**
+   * Pass the bytes received since the last call to the stream condition
+   * @return True if a match has been found
+   */
+  bool Scan();
+
+  /**
+   * Call the client callback, the only caller of the callback, always invoked through the dispatch policy
+   * @param ec Error code
+   */
+  void Notify(boost::system::error_code ec);
+
   /**
    * Handler for timer
    */
@@ -97,8 +163,13 @@ class PROTOCOL_DLL_PUBLIC ReadOne : public boost::enable_shared_from_this<ReadOn
   sock::Ptr sock_;                                         ///< Network socket resource
   buffer::Ptr buffer_;                                     ///< Input buffer
   StopCondition stop_condition_;                           ///< Condition to consider read operation complete
-  std::shared_ptr<boost::asio::deadline_timer> deadline_;  ///< Deadline timer
+  StreamCondition stream_condition_;                       ///< Incremental condition, used instead if set
+  size_t scanned_;                                         ///< Bytes already passed to stream_condition_
+  size_t match_size_;                                      ///< Bytes up to the end of the match
+  std::unique_ptr<service::Timer> deadline_;               ///< Deadline timer
   Callback on_done_callback_;                              ///< Client callback
+  Dispatch dispatch_;                                      ///< How on_done_callback_ is called upon completion
+  HandlerMemory handler_memory_;                           ///< Recycled memory of the asynchronous operations
 };
 
 }  // namespace socket
@@ -0,0 +1,267 @@
+#pragma once
+/**
+ * @file   protocol/tcp/socket/read_one_framing.hpp
+ * @brief  Declaration of length-prefixed framing functors to use as a protocol::tcp::socket::ReadOne::StopCondition
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <protocol/tcp/socket/read_one.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+namespace read_one {
+namespace handlers {
+
+/**
+ * Byte order of a length field
+ */
+enum class ByteOrder {
+  kBigEndian,     ///< Most significant byte first
+  kLittleEndian,  ///< Least significant byte first
+};
+
+const size_t kDefaultMaxFrameSize = 64 * 1024 * 1024;  ///< Default largest frame, header included
+
+/**
+ * Boundaries of the last frame matched by a framing functor. The frame starts the ReadOne buffer, so the payload can
+ * be used in place at (**buffer).data() + header_size without copying it out
+ */
+struct PROTOCOL_DLL_PUBLIC Frame {
+  size_t header_size;   ///< Bytes before the payload
+  size_t payload_size;  ///< Payload bytes
+  bool valid;           ///< False if the header was malformed or the frame too large, the frame then holds the header
+};
+
+/**
+ * Match one frame whose header holds an unsigned integer giving the payload size. The header is header_size bytes
+ * long and the length field of sizeof(Length) bytes starts at offset in it; adjustment is added to the field value,
+ * e.g. -header_size when the field counts the whole frame. Each copy keeps its own state, so the instance kept by the
+ * caller decodes the frame a read ended with through GetFrame(data, size)
+ */
+template <typename Length, ByteOrder Order>
+struct LengthField {
+  static_assert(std::is_unsigned<Length>::value, "Length must be an unsigned integer type");
+
+  /**
+   * Default ctor
+   * @param offset         Offset of the length field in the header
+   * @param header_size    Size of the header, 0 means the header ends with the length field
+   * @param adjustment     Value added to the length field to get the payload size
+   * @param max_frame_size Largest frame accepted, header included
+   * @throws std::invalid_argument
+   */
+  explicit LengthField(size_t offset = 0, size_t header_size = 0, int64_t adjustment = 0,
+                       size_t max_frame_size = kDefaultMaxFrameSize)
+      : offset_(offset),
+        header_size_(header_size ? header_size : offset + sizeof(Length)),
+        adjustment_(adjustment),
+        max_frame_size_(max_frame_size),
+        frame_{0, 0, false},
+        header_(),
+        seen_(0),
+        next_{0, 0, false} {
+    if (header_size_ < offset_ + sizeof(Length)) {
+      throw std::invalid_argument("Header can't end before the length field");
+    }
+    if (max_frame_size_ < header_size_) throw std::invalid_argument("Maximum frame size is below the header size");
+  }
+
+  /**
+   * The match algorithm
+   * @param begin Start of search range
+   * @param end   End of search range
+   * @return The first member of the return value is an iterator marking one-past-the-end of the bytes that have been
+   * consumed by the match function. The second member of the return value is true if a match has been found, false
+   * otherwise.
+   */
+  std::pair<ReadOne::Iterator, bool> operator()(ReadOne::Iterator begin, ReadOne::Iterator end) {
+    const size_t size = end - begin;
+    if (size < header_size_) return std::make_pair(begin, false);
+
+    const Frame frame = Decode(&*begin);
+    const size_t frame_size = frame.header_size + frame.payload_size;
+    if (size < frame_size) return std::make_pair(begin, false);
+    frame_ = frame;
+    return std::make_pair(begin + frame_size, true);
+  }
+
+  /**
+   * The incremental match algorithm, for use as a ReadOne::StreamCondition
+   * @param data Bytes received since the previous call
+   * @param size Number of bytes
+   * @return The number of bytes up to the end of the match and whether a match has been found
+   */
+  std::pair<size_t, bool> operator()(const char* data, size_t size) {
+    size_t i = 0;
+    if (header_.size() < header_size_) {
+      const size_t take = std::min(size, header_size_ - header_.size());
+      header_.append(data, take);
+      seen_ += take;
+      i = take;
+      if (header_.size() < header_size_) return std::make_pair(size, false);
+      next_ = Decode(header_.data());
+    }
+
+    const size_t missing = next_.header_size + next_.payload_size - seen_;
+    if (size - i < missing) {
+      seen_ += size - i;
+      return std::make_pair(size, false);
+    }
+    frame_ = next_;
+    header_.clear();
+    seen_ = 0;
+    return std::make_pair(i + missing, true);
+  }
+
+  /**
+   * Get the boundaries of the last frame matched by this instance
+   * @return The frame
+   */
+  const Frame& GetFrame() const {
+    return frame_;
+  }
+
+  /**
+   * Decode the frame a read ended with
+   * @param data Matched bytes, the first ReadOne::GetMatchSize() bytes of the read buffer
+   * @param size Number of bytes
+   * @return The frame, invalid with an empty header if the bytes don't hold a whole header
+   */
+  Frame GetFrame(const char* data, size_t size) const {
+    return size < header_size_ ? Frame{0, 0, false} : Decode(data);
+  }
+
+ private:
+  /**
+   * Decode the header
+   * @param header Complete header
+   * @return The frame announced, invalid if its payload size is negative or it is larger than the maximum frame size
+   */
+  Frame Decode(const char* header) const {
+    uint64_t value = 0;
+    const unsigned char* field = reinterpret_cast<const unsigned char*>(header + offset_);
+    for (size_t i = 0; i < sizeof(Length); ++i) {
+      const size_t byte = Order == ByteOrder::kBigEndian ? i : sizeof(Length) - 1 - i;
+      value = (value << 8) | field[byte];
+    }
+
+    // Unsigned arithmetic, a field above INT64_MAX must not wrap to a small size
+    const Frame invalid{header_size_, 0, false};
+    const uint64_t magnitude = adjustment_ < 0 ? 0 - static_cast<uint64_t>(adjustment_) : adjustment_;
+    if (adjustment_ < 0) {
+      if (value < magnitude) return invalid;
+      value -= magnitude;
+    } else {
+      if (value > std::numeric_limits<uint64_t>::max() - magnitude) return invalid;
+      value += magnitude;
+    }
+    if (value > max_frame_size_ - header_size_) return invalid;
+    return Frame{header_size_, static_cast<size_t>(value), true};
+  }
+
+  size_t offset_;          ///< Offset of the length field in the header
+  size_t header_size_;     ///< Size of the header
+  int64_t adjustment_;     ///< Value added to the length field to get the payload size
+  size_t max_frame_size_;  ///< Largest frame accepted, header included
+  Frame frame_;            ///< Last matched frame
+  std::string header_;     ///< Header bytes seen by the incremental algorithm
+  size_t seen_;            ///< Frame bytes seen by the incremental algorithm
+  Frame next_;             ///< Frame being read by the incremental algorithm
+};
+
+/**
+ * Frame made of a big-endian payload size followed by the payload
+ */
+template <typename Length>
+using BigEndianPrefix = LengthField<Length, ByteOrder::kBigEndian>;
+
+/**
+ * Frame made of a little-endian payload size followed by the payload
+ */
+template <typename Length>
+using LittleEndianPrefix = LengthField<Length, ByteOrder::kLittleEndian>;
+
+/**
+ * Match one frame made of a base 128 varint payload size (as used by Protocol Buffers) followed by the payload.
+ * Each copy keeps its own state, the instance kept by the caller decodes a matched frame through GetFrame(data, size)
+ */
+struct PROTOCOL_DLL_PUBLIC VarintPrefix {
+  static const size_t kMaxHeaderSize = 10;  ///< Longest valid varint, enough for 64 bits
+
+  /**
+   * Default ctor
+   * @param max_frame_size Largest frame accepted, header included
+   */
+  explicit VarintPrefix(size_t max_frame_size = kDefaultMaxFrameSize);
+
+  /**
+   * The match algorithm
+   * @param begin Start of search range
+   * @param end   End of search range
+   * @return The first member of the return value is an iterator marking one-past-the-end of the bytes that have been
+   * consumed by the match function. The second member of the return value is true if a match has been found, false
+   * otherwise.
+   */
+  std::pair<ReadOne::Iterator, bool> operator()(ReadOne::Iterator begin, ReadOne::Iterator end);
+
+  /**
+   * The incremental match algorithm, for use as a ReadOne::StreamCondition
+   * @param data Bytes received since the previous call
+   * @param size Number of bytes
+   * @return The number of bytes up to the end of the match and whether a match has been found
+   */
+  std::pair<size_t, bool> operator()(const char* data, size_t size);
+
+  /**
+   * Get the boundaries of the last frame matched by this instance. A varint longer than kMaxHeaderSize or above 64
+   * bits, or a frame larger than the maximum frame size, makes an invalid frame
+   * @return The frame
+   */
+  const Frame& GetFrame() const;
+
+  /**
+   * Decode the frame a read ended with
+   * @param data Matched bytes, the first ReadOne::GetMatchSize() bytes of the read buffer
+   * @param size Number of bytes
+   * @return The frame, invalid with an empty header if the bytes don't hold a whole header
+   */
+  Frame GetFrame(const char* data, size_t size) const;
+
+  /**
+   * Decode a header
+   * @param data  Bytes starting with the header
+   * @param size  Number of bytes
+   * @param frame Set to the frame announced when the header is complete
+   * @return False if more bytes are needed to decode the header
+   */
+  bool Decode(const char* data, size_t size, Frame& frame) const;
+
+  /**
+   * Check a decoded payload size against the maximum frame size
+   * @param header_size Size of the varint
+   * @param value       Payload size
+   * @return The frame announced, invalid if it is too large
+   */
+  Frame MakeFrame(size_t header_size, uint64_t value) const;
+
+  size_t max_frame_size_;  ///< Largest frame accepted, header included
+  Frame frame_;            ///< Last matched frame
+  uint64_t value_;         ///< Payload size decoded by the incremental algorithm so far
+  size_t header_size_;     ///< Varint bytes seen by the incremental algorithm
+  bool sized_;             ///< Whether the incremental algorithm has decoded the whole varint
+  size_t missing_;         ///< Payload bytes the incremental algorithm still expects
+};
+
+}  // namespace handlers
+}  // namespace read_one
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
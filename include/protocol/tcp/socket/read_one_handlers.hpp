@@ -4,7 +4,9 @@
  * @brief  Declaration of some functors to use as a protocol::tcp::socket::ReadOne::StopCondition
  */
 
+#include <cstdint>
 #include <cstdio>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <utility>
@@ -38,7 +40,16 @@ struct PROTOCOL_DLL_PUBLIC ByteCount {
    */
   std::pair<ReadOne::Iterator, bool> operator()(ReadOne::Iterator begin, ReadOne::Iterator end);
 
+  /**
+   * The incremental match algorithm, for use as a ReadOne::StreamCondition
+   * @param data Bytes received since the previous call
+   * @param size Number of bytes
+   * @return The number of bytes up to the end of the match and whether a match has been found
+   */
+  std::pair<size_t, bool> operator()(const char* data, size_t size);
+
   size_t bytes_;  ///< Number of bytes to read
+  size_t seen_;   ///< Bytes seen by the incremental algorithm since the last match
 };
 
 /**
@@ -51,8 +62,9 @@ struct PROTOCOL_DLL_PUBLIC Substring {
    */
   template <typename T>
   explicit Substring(const T& val)
-      : tail_(val.begin(), val.end()) {
+      : tail_(val.begin(), val.end()), prefix_(), matched_(0) {
     if (tail_.empty()) throw std::runtime_error("Token can't be empty");
+    BuildPrefix();
   }
 
   /**
@@ -65,7 +77,90 @@ struct PROTOCOL_DLL_PUBLIC Substring {
    */
   std::pair<ReadOne::Iterator, bool> operator()(ReadOne::Iterator begin, ReadOne::Iterator end);
 
-  std::vector<char> tail_;  ///< String to match
+  /**
+   * The incremental match algorithm (Knuth-Morris-Pratt), for use as a ReadOne::StreamCondition. A match split
+   * between calls is found without looking at previous bytes again
+   * @param data Bytes received since the previous call
+   * @param size Number of bytes
+   * @return The number of bytes up to the end of the match and whether a match has been found
+   */
+  std::pair<size_t, bool> operator()(const char* data, size_t size);
+
+  /**
+   * Compute prefix_ from tail_
+   */
+  void BuildPrefix();
+
+  std::vector<char> tail_;      ///< String to match
+  std::vector<size_t> prefix_;  ///< Length of the longest proper prefix of tail_[0..i] that is also its suffix
+  size_t matched_;              ///< Length of the prefix of tail_ matched by the bytes seen so far
+};
+
+/**
+ * Match whichever of several tokens ends first, scanning the data once with an Aho-Corasick automaton. When several
+ * tokens end on the same byte the longest one is reported. Copies share the automaton but each keeps its own scan
+ * state, so the instance kept by the caller learns the token that ended a read with GetMatch(data, size)
+ */
+struct PROTOCOL_DLL_PUBLIC AnyOf {
+  /**
+   * Default ctor
+   * @param tokens Strings to search for, none may be empty
+   */
+  explicit AnyOf(const std::vector<std::string>& tokens);
+
+  /**
+   * The match algorithm
+   * @param begin Start of search range
+   * @param end   End of search range
+   * @return The first member of the return value is an iterator marking one-past-the-end of the bytes that have been
+   * consumed by the match function. The second member of the return value is true if a match has been found, false
+   * otherwise.
+   */
+  std::pair<ReadOne::Iterator, bool> operator()(ReadOne::Iterator begin, ReadOne::Iterator end);
+
+  /**
+   * The incremental match algorithm, for use as a ReadOne::StreamCondition
+   * @param data Bytes received since the previous call
+   * @param size Number of bytes
+   * @return The number of bytes up to the end of the match and whether a match has been found
+   */
+  std::pair<size_t, bool> operator()(const char* data, size_t size);
+
+  /**
+   * Get the token found by the last match of this instance
+   * @return Index of the token in the ctor argument, -1 if nothing matched yet
+   */
+  int GetMatch() const;
+
+  /**
+   * Get the token matched bytes end with, the longest one if several do
+   * @param data Matched bytes, such as the first ReadOne::GetMatchSize() bytes of the read buffer
+   * @param size Number of bytes
+   * @return Index of the token in the ctor argument, -1 if the bytes end with none
+   */
+  int GetMatch(const char* data, size_t size) const;
+
+  /**
+   * Automaton shared by the copies of an AnyOf, immutable once built
+   */
+  struct Automaton {
+    std::vector<int32_t> next;    ///< Transition table, 256 entries per node, node 0 is the root
+    std::vector<int32_t> output;  ///< Longest token ending on each node, -1 if none
+    size_t longest;               ///< Size of the longest token
+  };
+
+  /**
+   * Scan bytes from a node
+   * @param data Bytes to scan
+   * @param size Number of bytes
+   * @param node Start node, updated to the node reached
+   * @return Number of bytes up to the end of the first match, or size + 1 if there is none
+   */
+  size_t Scan(const char* data, size_t size, int32_t& node);
+
+  std::shared_ptr<const Automaton> automaton_;  ///< Shared automaton
+  int32_t node_;                               ///< Current node of the incremental algorithm
+  int match_;                                  ///< Token found by the last match
 };
 
 }  // namespace handlers
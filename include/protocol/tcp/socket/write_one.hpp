@@ -15,9 +15,14 @@
 #include <vector>
 #include <boost/asio/coroutine.hpp>
 
+#include <protocol/service/timer_wheel.hpp>
 #include <protocol/tcp/socket/write_one/ptr.hpp>
 #include <protocol/tcp/socket/ptr.hpp>
 #include <protocol/tcp/socket/buffer/ptr.hpp>
+#include <protocol/tcp/socket/buffer_chain/ptr.hpp>
+#include <protocol/tcp/socket/dispatch.hpp>
+#include <protocol/tcp/socket/handler_memory.hpp>
+#include <protocol/tcp/socket/options.hpp>
 
 namespace protocol {
 namespace tcp {
@@ -36,17 +41,47 @@ class PROTOCOL_DLL_PUBLIC WriteOne : public boost::enable_shared_from_this<Write
    * @param buffer     Buffer to send
    * @param on_done    Callback called upon completion or when an error condition occurs
    * @param timeout_ms Timeout value in milliseconds, a value of 0 implies no timeout
+   * @param dispatch   How on_done is called upon completion
+   * @param cork       Whether the write corks or uncorks the socket, to send a multi-part message in full segments
    * @return A shared pointer of a newly created WriteOne instance
    */
-  static write_one::Ptr Start(sock::Ptr sock, buffer::Ptr buffer, const Callback& on_done, const size_t timeout_ms);
+  static write_one::Ptr Start(sock::Ptr sock, buffer::Ptr buffer, const Callback& on_done, const size_t timeout_ms,
+                              const Dispatch& dispatch = Dispatch(), Cork cork = Cork::kNone);
+
+  /**
+   * Create a WriteOne instance that sends a chain of slices with a gathered write, without copying them
+   * @param sock       Input socket in the open state
+   * @param chain      Slices to send, must not be modified until the operation completes
+   * @param on_done    Callback called upon completion or when an error condition occurs
+   * @param timeout_ms Timeout value in milliseconds, a value of 0 implies no timeout
+   * @param dispatch   How on_done is called upon completion
+   * @param cork       Whether the write corks or uncorks the socket, to send a multi-part message in full segments
+   * @return A shared pointer of a newly created WriteOne instance
+   */
+  static write_one::Ptr Start(sock::Ptr sock, buffer_chain::Ptr chain, const Callback& on_done,
+                              const size_t timeout_ms, const Dispatch& dispatch = Dispatch(), Cork cork = Cork::kNone);
 
   /**
    * Private constructor for this class
    * @param sock    Input socket in the open state
    * @param buffer  Buffer to send
-   * @param on_done Callback called upon completion or when an error condition occurs
+   * @param on_done  Callback called upon completion or when an error condition occurs
+   * @param dispatch How on_done is called upon completion
+   * @param cork     Whether the write corks or uncorks the socket
    */
-  WriteOne(sock::Ptr sock, buffer::Ptr buffer, const Callback& on_done);
+  WriteOne(sock::Ptr sock, buffer::Ptr buffer, const Callback& on_done, const Dispatch& dispatch = Dispatch(),
+           Cork cork = Cork::kNone);
+
+  /**
+   * Private constructor for this class
+   * @param sock    Input socket in the open state
+   * @param chain   Slices to send
+   * @param on_done  Callback called upon completion or when an error condition occurs
+   * @param dispatch How on_done is called upon completion
+   * @param cork     Whether the write corks or uncorks the socket
+   */
+  WriteOne(sock::Ptr sock, buffer_chain::Ptr chain, const Callback& on_done, const Dispatch& dispatch = Dispatch(),
+           Cork cork = Cork::kNone);
 
   /**
    * Stop the operation and close the socket
@@ -59,6 +94,12 @@ class PROTOCOL_DLL_PUBLIC WriteOne : public boost::enable_shared_from_this<Write
    */
   const sock::Ptr& GetSock() const;
 
+  /**
+   * Get the memory the asynchronous operations are allocated from
+   * @return handler memory
+   */
+  const HandlerMemory& GetHandlerMemory() const;
+
  private:
   /**
    * Start the operation with the given timeout value
@@ -73,6 +114,12 @@ class PROTOCOL_DLL_PUBLIC WriteOne : public boost::enable_shared_from_this<Write
    */
   void operator()(boost::system::error_code ec, std::size_t bytes);
 
+  /**
+   * Call the client callback, the only caller of the callback, always invoked through the dispatch policy
+   * @param ec Error code
+   */
+  void Notify(boost::system::error_code ec);
+
   /**
    * Handler for timer
    */
@@ -82,8 +129,12 @@ class PROTOCOL_DLL_PUBLIC WriteOne : public boost::enable_shared_from_this<Write
   bool stopped_;                                           ///< Control variable
   sock::Ptr sock_;                                         ///< Network socket resource
   buffer::Ptr write_buffer_;                               ///< Output buffer
-  std::shared_ptr<boost::asio::deadline_timer> deadline_;  ///< Deadline timer
+  buffer_chain::Ptr write_chain_;                          ///< Output slices, used instead of write_buffer_ if set
+  std::unique_ptr<service::Timer> deadline_;               ///< Deadline timer
   Callback on_done_callback_;                              ///< Client callback
+  Dispatch dispatch_;                                      ///< How on_done_callback_ is called upon completion
+  Cork cork_;                                              ///< Whether the write corks or uncorks the socket
+  HandlerMemory handler_memory_;                           ///< Recycled memory of the asynchronous operations
 };
 
 }  // namespace socket
@@ -0,0 +1,181 @@
+#pragma once
+/**
+ * @file   protocol/tcp/socket/write_queue.hpp
+ * @brief  Class declaration of protocol::tcp::socket::WriteQueue
+ */
+
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/system/error_code.hpp>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <protocol/service/timer_wheel.hpp>
+#include <protocol/tcp/socket/buffer/ptr.hpp>
+#include <protocol/tcp/socket/buffer_chain/ptr.hpp>
+#include <protocol/tcp/socket/handler_memory.hpp>
+#include <protocol/tcp/socket/ptr.hpp>
+#include <protocol/tcp/socket/write_queue/config.hpp>
+#include <protocol/tcp/socket/write_queue/ptr.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+
+/**
+ * Serialises the writes of any number of producers on one socket. Messages are sent in the order they were pushed,
+ * never interleaved; while a write is in flight new messages queue up and are then sent together with a single
+ * gathered write. Producers are told to pause when the queued bytes exceed the high-water mark and to resume once
+ * they fall to the low-water mark. The first error stops the queue and is reported to every queued message; a write
+ * timeout also closes the socket, as the peer can't tell where the interrupted message ended.
+ */
+class PROTOCOL_DLL_PUBLIC WriteQueue : public boost::enable_shared_from_this<WriteQueue>, boost::noncopyable {
+ public:
+  using Callback = std::function<void(boost::system::error_code, write_queue::Ptr)>;  ///< Message callback type
+
+  /**
+   * Backpressure callback type, called with true when producers should pause and with false when they may resume.
+   * Calls are serialised on the I/O threads in the order the water marks were crossed
+   */
+  using BackpressureCallback = std::function<void(bool pause, write_queue::Ptr)>;
+
+  /**
+   * Counters of a WriteQueue
+   */
+  struct Stats {
+    size_t messages;  ///< Messages written
+    size_t writes;    ///< Gathered writes issued
+  };
+
+  /**
+   * Create a WriteQueue instance
+   * @param sock            Output socket in the open state
+   * @param config          Queue configuration
+   * @param on_backpressure Callback called when the queue crosses its water marks, may be empty
+   * @return A shared pointer to the new queue
+   */
+  static write_queue::Ptr Create(sock::Ptr sock, const write_queue::Config& config = write_queue::Config(),
+                                 const BackpressureCallback& on_backpressure = BackpressureCallback());
+
+  /**
+   * Private constructor for this class
+   * @param sock            Output socket in the open state
+   * @param config          Queue configuration
+   * @param on_backpressure Callback called when the queue crosses its water marks, may be empty
+   */
+  WriteQueue(sock::Ptr sock, const write_queue::Config& config, const BackpressureCallback& on_backpressure);
+
+  /**
+   * Queue the content of a buffer, which is consumed once written. Thread safe
+   * @param buffer  Buffer to send, must not be modified until the message callback
+   * @param on_done Callback called on the I/O thread once the message is written or failed, may be empty
+   * @return False if producers should pause, i.e. the queue is above its high-water mark or stopped
+   */
+  bool Push(buffer::Ptr buffer, const Callback& on_done = Callback());
+
+  /**
+   * Queue a chain of slices. Thread safe
+   * @param chain   Slices to send, must not be modified until the message callback
+   * @param on_done Callback called on the I/O thread once the message is written or failed, may be empty
+   * @return False if producers should pause, i.e. the queue is above its high-water mark or stopped
+   */
+  bool Push(buffer_chain::Ptr chain, const Callback& on_done = Callback());
+
+  /**
+   * Stop the queue, queued messages that aren't being written fail with operation_aborted. Thread safe
+   */
+  void Stop();
+
+  /**
+   * Get the number of bytes queued or being written
+   * @return Number of bytes
+   */
+  size_t GetQueuedBytes();
+
+  /**
+   * Get the queue counters
+   * @return The counters
+   */
+  Stats GetStats();
+
+  /**
+   * Get the underlying socket
+   * @return socket
+   */
+  const sock::Ptr& GetSock() const;
+
+ private:
+  /**
+   * A queued message
+   */
+  struct Message {
+    buffer::Ptr buffer;       ///< Buffer to send, if set
+    buffer_chain::Ptr chain;  ///< Slices to send, if set
+    size_t size;              ///< Number of bytes
+    Callback on_done;         ///< Message callback
+  };
+
+  /**
+   * Queue a message
+   * @param message Message to queue
+   * @return False if producers should pause
+   */
+  bool Push(Message&& message);
+
+  /**
+   * Write the queued messages, or go idle if there are none
+   */
+  void Flush();
+
+  /**
+   * Handler for the write operation
+   * @param ec Error code
+   */
+  void OnWrite(const boost::system::error_code& ec, std::size_t);
+
+  /**
+   * Handler for timer
+   */
+  void OnTimeout();
+
+  /**
+   * Queue a backpressure callback, mutex_ must be held
+   * @param pause Whether producers should pause
+   */
+  void Signal(bool pause);
+
+  /**
+   * Stop the queue and fail the messages that aren't being written
+   * @param ec Error reported to the messages
+   */
+  void Fail(const boost::system::error_code& ec);
+
+ private:
+  sock::Ptr sock_;                                           ///< Network socket resource
+  write_queue::Config config_;                               ///< Queue configuration
+  BackpressureCallback on_backpressure_callback_;            ///< Client backpressure callback
+  std::mutex mutex_;                                         ///< Protects the members below up to writing_
+  std::deque<Message> pending_;                              ///< Messages waiting for the next write
+  size_t queued_bytes_;                                      ///< Bytes pending or being written
+  bool paused_;                                              ///< Whether producers were asked to pause
+  bool stopped_;                                             ///< Control variable
+  bool writing_;                                             ///< Whether a flush is scheduled or a write is in flight
+  Stats stats_;                                              ///< Counters
+  std::vector<Message> batch_;                               ///< Messages being written, only used on the I/O thread
+  std::vector<boost::asio::const_buffer> slices_;            ///< Gathered slices of batch_
+  size_t batch_bytes_;                                       ///< Bytes of batch_
+  bool batch_reported_;                                      ///< Whether a timeout already reported batch_
+  std::unique_ptr<service::Timer> deadline_;                 ///< Deadline timer
+  std::unique_ptr<boost::asio::io_service::strand> strand_;  ///< Serialises the backpressure callbacks
+  HandlerMemory handler_memory_;                             ///< Recycled memory of the write operations
+};
+
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
@@ -0,0 +1,38 @@
+#pragma once
+/**
+ * @file   protocol/tcp/socket/write_queue/config.hpp
+ * @brief  Declaration of protocol::tcp::socket::write_queue::Config
+ */
+
+#include <cstddef>
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+namespace write_queue {
+
+/**
+ * Configuration of a WriteQueue
+ */
+struct PROTOCOL_DLL_PUBLIC Config {
+  /**
+   * Default ctor
+   */
+  Config()
+      : high_water_mark(1024 * 1024),
+        low_water_mark(256 * 1024),
+        max_batch_messages(64),
+        max_batch_bytes(256 * 1024),
+        timeout_ms(0) {}
+
+  size_t high_water_mark;     ///< Queued bytes above which producers are asked to pause
+  size_t low_water_mark;      ///< Queued bytes at or below which paused producers are asked to resume
+  size_t max_batch_messages;  ///< Most messages coalesced in one gathered write
+  size_t max_batch_bytes;     ///< Bytes after which no more messages are added to a gathered write
+  size_t timeout_ms;          ///< Timeout of each gathered write in milliseconds, a value of 0 implies no timeout
+};
+
+}  // namespace write_queue
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
@@ -0,0 +1,23 @@
+#pragma once
+/**
+ * @file   protocol/tcp/socket/write_queue/ptr.hpp
+ * @brief  Smart pointer declarations for protocol::tcp::socket::WriteQueue
+ */
+
+#include <boost/shared_ptr.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+class WriteQueue;
+namespace write_queue {
+
+/**
+ * A mutable WriteQueue pointer
+ */
+using Ptr = boost::shared_ptr<WriteQueue>;
+
+}  // namespace write_queue
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
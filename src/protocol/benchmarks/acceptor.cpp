@@ -0,0 +1,86 @@
+/**
+ * @cond   internal
+ * @file   protocol/benchmarks/acceptor.cpp
+ * @brief  Throughput benchmark of protocol::tcp::server::Acceptor
+ */
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <gtest/gtest.h>
+
+#include <protocol/tcp/server/acceptor.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace server {
+
+namespace sc = std::chrono;
+namespace ba = boost::asio;
+namespace bs = boost::system;
+
+static const size_t kNumClients = 4;                ///< Threads opening connections
+static const size_t kConnectionsPerClient = 1250;  ///< Connections opened by each thread, per configuration
+
+/**
+ * Open connections from several threads as fast as possible and count how fast the acceptor hands them over
+ * @param name   Configuration name
+ * @param config Acceptor configuration
+ */
+static void Storm(const char* name, const acceptor::Config& config) {
+  const size_t total = kNumClients * kConnectionsPerClient;
+  std::atomic<size_t> accepted(0);
+  std::promise<void> done;
+  Acceptor acceptor(0, [&](bs::error_code ec, Acceptor&, socket::sock::Ptr) {
+    ASSERT_FALSE(ec);
+    if (++accepted == total) done.set_value();
+  }, config);
+  const ba::ip::tcp::endpoint endpoint(ba::ip::address_v4::loopback(), acceptor.GetPort());
+
+  const auto start = sc::steady_clock::now();
+  std::vector<std::thread> clients;
+  for (size_t i = 0; i < kNumClients; ++i) {
+    clients.emplace_back([&]() {
+      ba::io_service service;
+      for (size_t j = 0; j < kConnectionsPerClient; ++j) {
+        ba::ip::tcp::socket sock(service);
+        sock.connect(endpoint);
+      }
+    });
+  }
+  for (auto& client : clients) client.join();
+  ASSERT_EQ(std::future_status::ready, done.get_future().wait_for(sc::seconds(30)));
+  const auto us = sc::duration_cast<sc::microseconds>(sc::steady_clock::now() - start).count();
+  acceptor.Stop();
+  std::cout << name << ": " << total * 1000000 / (us ? us : 1) << " connections/s" << std::endl;
+}
+
+/**
+ * @test Compares one accept at a time with outstanding accepts draining the backlog, and with one listener per worker
+ */
+TEST(AcceptorBenchmark, ConnectionsPerSecond) {
+  acceptor::Config single;
+  single.accept_batch = 1;
+  Storm("one accept at a time", single);
+
+  acceptor::Config batched;
+  batched.pending_accepts = 4;
+  batched.accept_batch = 64;
+  Storm("batched", batched);
+
+  acceptor::Config reuse_port = batched;
+  reuse_port.listeners = 0;
+  Storm("batched, one listener per worker", reuse_port);
+}
+
+}  // namespace server
+}  // namespace tcp
+}  // namespace protocol
+
+/// @endcond internal
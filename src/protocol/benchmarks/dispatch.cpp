@@ -0,0 +1,79 @@
+/**
+ * @cond   internal
+ * @file   protocol/benchmarks/dispatch.cpp
+ * @brief  Latency benchmark of the protocol::tcp::socket::Dispatch policies
+ */
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <boost/asio/io_service.hpp>
+#include <gtest/gtest.h>
+
+#include <protocol/tcp/socket/buffer.hpp>
+#include <protocol/tcp/socket/dispatch.hpp>
+#include <protocol/tcp/socket/read_one.hpp>
+#include <protocol/tcp/socket/read_one_handlers.hpp>
+#include <protocol/tcp/socket/socket_pair.hpp>
+#include <protocol/tcp/socket/write_one.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+
+namespace sc = std::chrono;
+namespace ba = boost::asio;
+namespace bs = boost::system;
+
+static const size_t kNumMessages = 20000;  ///< Sequential messages per policy
+
+/**
+ * Send messages one at a time over loopback, the next one leaving when the previous one has been read
+ * @param name          Policy name
+ * @param make_dispatch Makes the policy of every operation for the io_service running them
+ */
+static void PingPong(const char* name, std::function<Dispatch(ba::io_service&)> make_dispatch) {
+  ba::io_service service;
+  const Dispatch dispatch = make_dispatch(service);
+  SocketPair pair(service);
+  sock::Ptr client = pair.client;
+  sock::Ptr server = pair.server;
+
+  size_t sent = 0;
+  std::function<void()> send = [&]() {
+    WriteOne::Start(client, Buffer::Create("ping\n"), [](bs::error_code ec, write_one::Ptr) {
+      ASSERT_FALSE(ec);
+    }, 0, dispatch);
+    ReadOne::Start(server, read_one::handlers::Substring(std::string("\n")), [&](bs::error_code ec, read_one::Ptr) {
+      ASSERT_FALSE(ec);
+      if (++sent < kNumMessages) send();
+    }, 0, dispatch);
+  };
+
+  const auto start = sc::steady_clock::now();
+  send();
+  service.run();
+  const auto ns = sc::duration_cast<sc::nanoseconds>(sc::steady_clock::now() - start).count();
+  ASSERT_EQ(kNumMessages, sent);
+  std::cout << name << ": " << ns / kNumMessages << " ns per message" << std::endl;
+}
+
+/**
+ * @test Compares the round trip latency of the policies
+ */
+TEST(DispatchBenchmark, PingPong) {
+  PingPong("post", [](ba::io_service&) { return Dispatch::Post(); });
+  PingPong("inline", [](ba::io_service&) { return Dispatch::Inline(); });
+  PingPong("strand", [](ba::io_service& service) {
+    return Dispatch::OnStrand(std::make_shared<ba::io_service::strand>(service));
+  });
+}
+
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
+
+/// @endcond internal
@@ -0,0 +1,135 @@
+/**
+ * @cond   internal
+ * @file   protocol/benchmarks/response_parser.cpp
+ * @brief  Benchmark of protocol::tcp::client::http::ResponseParser against the iostream extraction it replaced
+ */
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <boost/asio/buffers_iterator.hpp>
+#include <gtest/gtest.h>
+
+#include <protocol/tcp/client/http.hpp>
+#include <protocol/tcp/client/response_parser.hpp>
+#include <protocol/tcp/socket/buffer.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace client {
+namespace http {
+
+namespace sc = std::chrono;
+namespace ba = boost::asio;
+
+/**
+ * Fill a buffer with bytes as a socket read would
+ * @param buffer Buffer
+ * @param bytes  Bytes
+ */
+static void Receive(socket::Buffer& buffer, const std::string& bytes) {
+  auto space = (*buffer).prepare(bytes.size());
+  std::memcpy(ba::buffer_cast<char*>(space), bytes.data(), bytes.size());
+  (*buffer).commit(bytes.size());
+}
+
+/**
+ * The extraction HTTPGet used before ResponseParser: operator>> for the status, std::getline for each header and
+ * copies of the buffer for the body
+ * @param buffer  Buffer holding a response
+ * @param headers Headers
+ * @param body    Body
+ * @return Status code
+ */
+static int IostreamParse(socket::Buffer& buffer, Headers& headers, std::string& body) {
+  int status_code;
+  std::string key, value;
+  buffer >> key;
+  buffer >> status_code;
+  while (true) {
+    key.clear();
+    value.clear();
+    buffer >> key;
+    std::getline(buffer.GetIStream(), value);
+    if (key.empty() || value.empty()) break;
+    headers.push_back({key, value});
+    if (*ba::buffers_begin((*buffer).data()) == '\r') {
+      (*buffer).consume(2);
+      break;
+    }
+  }
+  body = buffer.ToString();
+  buffer.Reset();
+  body = body + buffer.ToString();
+  std::stoi(GetHeaderField(headers, "Content-Length:"));
+  return status_code;
+}
+
+/**
+ * Time a parse function
+ * @param repeat Number of responses
+ * @param parse  Function to time
+ * @return Responses per second
+ */
+template <typename Parse>
+static double Rate(size_t repeat, Parse parse) {
+  const auto start = sc::steady_clock::now();
+  for (size_t i = 0; i < repeat; ++i) parse();
+  return repeat / sc::duration_cast<sc::duration<double>>(sc::steady_clock::now() - start).count();
+}
+
+/**
+ * @test Parses responses the way HTTPGet stores them, into header and body storage that is new for every response
+ */
+TEST(ResponseParserBenchmark, Responses) {
+  const size_t kRepeat = 200000;
+  for (size_t header_count : {4, 16}) {
+    std::string bytes("HTTP/1.1 200 OK\r\nContent-Length: 512\r\n");
+    for (size_t i = 1; i < header_count; ++i) bytes += "X-Header-" + std::to_string(i) + ": some header value\r\n";
+    bytes += "\r\n" + std::string(512, 'x');
+
+    socket::Buffer buffer;
+
+    const double iostream_rate = Rate(kRepeat, [&]() {
+      Headers headers;
+      std::string body;
+      Receive(buffer, bytes);
+      ASSERT_EQ(200, IostreamParse(buffer, headers, body));
+      ASSERT_EQ(512u, body.size());
+    });
+
+    int status = 0;
+    Headers* headers = nullptr;
+    std::string* body = nullptr;
+    ResponseParser parser([&status](int code, boost::string_ref) { status = code; },
+                          [&headers](boost::string_ref name, boost::string_ref value) {
+                            headers->emplace_back(name.to_string(), value.to_string());
+                          },
+                          [&body](boost::string_ref data) { body->append(data.data(), data.size()); });
+    const double parser_rate = Rate(kRepeat, [&]() {
+      Headers response_headers;
+      std::string response_body;
+      headers = &response_headers;
+      body = &response_body;
+      parser.Reset();
+      Receive(buffer, bytes);
+      const auto data = (*buffer).data();
+      (*buffer).consume(parser.Parse(ba::buffer_cast<const char*>(data), ba::buffer_size(data)));
+      ASSERT_TRUE(parser.IsComplete());
+      ASSERT_EQ(200, status);
+      ASSERT_EQ(512u, response_body.size());
+    });
+
+    std::cout << header_count << " headers: iostream " << static_cast<size_t>(iostream_rate) << " responses/s, parser "
+              << static_cast<size_t>(parser_rate) << " responses/s" << std::endl;
+  }
+}
+
+}  // namespace http
+}  // namespace client
+}  // namespace tcp
+}  // namespace protocol
+
+/// @endcond internal
@@ -0,0 +1,106 @@
+/**
+ * @cond   internal
+ * @file   protocol/benchmarks/search.cpp
+ * @brief  Benchmark of protocol::tcp::socket::search against the byte by byte iterator matcher
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <utility>
+
+#include <boost/asio/buffers_iterator.hpp>
+#include <boost/asio/streambuf.hpp>
+#include <gtest/gtest.h>
+
+#include <protocol/tcp/socket/read_one.hpp>
+
+#include "protocol/tcp/socket/search.hpp"
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+
+namespace sc = std::chrono;
+namespace ba = boost::asio;
+
+/**
+ * The matcher Substring used before the contiguous fast path, walks buffers_iterator one byte at a time
+ * @param begin Start of search range
+ * @param end   End of search range
+ * @param tail  Token to find
+ * @return Iterator past the match and whether one was found
+ */
+static std::pair<ReadOne::Iterator, bool> IteratorFind(
+    ReadOne::Iterator begin, ReadOne::Iterator end, const std::string& tail) {
+  ReadOne::Iterator i = begin;
+  while (true) {
+    while ((i != end) && (*i != tail[0])) ++i;
+    if (std::distance(i, end) < static_cast<std::ptrdiff_t>(tail.size())) return std::make_pair(i, false);
+
+    size_t tail_idx;
+    for (tail_idx = 1; tail_idx < tail.size(); ++tail_idx) {
+      if (*(i + tail_idx) != tail[tail_idx]) break;
+    }
+    if (tail_idx == tail.size()) return std::make_pair(i + tail.size(), true);
+    ++i;
+  }
+}
+
+/**
+ * Time a search function
+ * @param repeat Number of calls
+ * @param search Function to time
+ * @return Nanoseconds per call
+ */
+template <typename Search>
+static double Time(size_t repeat, Search search) {
+  const auto start = sc::steady_clock::now();
+  for (size_t i = 0; i < repeat; ++i) search();
+  return sc::duration_cast<sc::nanoseconds>(sc::steady_clock::now() - start).count() / double(repeat);
+}
+
+/**
+ * @test Searches the blank line ending a block of HTTP-like header lines, so '\r' candidates are frequent
+ */
+TEST(SearchBenchmark, HeaderTerminator) {
+  const std::string token("\r\n\r\n");
+  const std::string line("X-Header: some value\r\n");
+  for (size_t size = 1024; size <= 16 * 1024 * 1024; size *= 4) {
+    ba::streambuf buffer;
+    std::ostream os(&buffer);
+    for (size_t written = 0; written + line.size() + 2 <= size; written += line.size()) os << line;
+    os << "\r\n";
+
+    const auto data = buffer.data();
+    const char* begin = ba::buffer_cast<const char*>(data);
+    const char* end = begin + ba::buffer_size(data);
+    const size_t repeat = std::max<size_t>(1, (64 * 1024 * 1024) / size);
+
+    const double iterator_ns = Time(repeat, [&]() {
+      auto result = IteratorFind(ba::buffers_begin(data), ba::buffers_end(data), token);
+      ASSERT_TRUE(result.second);
+    });
+    const double scalar_ns = Time(repeat, [&]() {
+      ASSERT_NE(end, search::FindScalar(begin, end, token.data(), token.size()));
+    });
+    const double sse2_ns = Time(repeat, [&]() {
+      ASSERT_NE(end, search::FindSse2(begin, end, token.data(), token.size()));
+    });
+    double avx2_ns = 0;
+    if (search::HasAvx2()) {
+      avx2_ns = Time(repeat, [&]() {
+        ASSERT_NE(end, search::FindAvx2(begin, end, token.data(), token.size()));
+      });
+    }
+
+    std::cout << size << " bytes: iterator " << iterator_ns << " ns, scalar " << scalar_ns << " ns, sse2 " << sse2_ns
+              << " ns, avx2 " << (avx2_ns ? std::to_string(avx2_ns) + " ns" : "n/a") << std::endl;
+  }
+}
+
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
+
+/// @endcond internal
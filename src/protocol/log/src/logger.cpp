@@ -0,0 +1,308 @@
+/**
+ * @file   protocol/log/src/logger.cpp
+ * @brief  Class definition of protocol::log::Logger
+ */
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+
+#include <protocol/log/logger.hpp>
+
+#include "protocol/utility/thread.hpp"
+
+namespace protocol {
+namespace log {
+
+namespace sc = std::chrono;
+
+const size_t Logger::kCapacity;
+const size_t Logger::kMaxMessage;
+std::atomic<int> Logger::level_(PROTOCOL_LOG_LEVEL);
+
+const char* GetName(Level level) {
+  switch (level) {
+    case Level::kTrace:
+      return "TRACE";
+    case Level::kDebug:
+      return "DEBUG";
+    case Level::kInfo:
+      return "INFO";
+    case Level::kWarning:
+      return "WARNING";
+    case Level::kError:
+      return "ERROR";
+    case Level::kOff:
+      break;
+  }
+  return "OFF";
+}
+
+namespace {
+
+/**
+ * A message in the ring. A slot at ring position pos is free to write when its sequence is pos, and holds a message
+ * ready to read when its sequence is pos + 1
+ */
+struct Slot {
+  std::atomic<size_t> sequence;       ///< Sequence number
+  Level level;                        ///< Level of the message
+  sc::system_clock::time_point time;  ///< Time the message was written
+  size_t size;                        ///< Size of the message
+  char text[Logger::kMaxMessage];     ///< Message
+};
+
+const size_t kIdleMs = 10;  ///< Time the background thread sleeps when the ring is empty
+
+Slot slots[Logger::kCapacity];      ///< Ring, trivially destructible so that late writers don't touch freed memory
+std::atomic<size_t> head(0);        ///< Next position to write
+size_t tail = 0;                    ///< Next position to read, drain_mutex must be held
+std::atomic<size_t> written(0);     ///< Messages queued
+std::atomic<size_t> dropped(0);     ///< Messages dropped because the ring was full
+std::atomic<bool> shutdown(false);  ///< Whether the background thread was stopped at exit
+
+std::mutex drain_mutex;  ///< Serializes the readers of the ring, protects sink
+Logger::Sink sink;       ///< Sink, null for the default one
+
+/**
+ * Default sink, writes to std::clog
+ * @param record Message
+ */
+void WriteClog(const Record& record) {
+  const std::time_t time = sc::system_clock::to_time_t(record.time);
+  std::tm tm;
+#ifdef _WIN32
+  localtime_s(&tm, &time);
+#else
+  localtime_r(&time, &tm);
+#endif
+  char stamp[32];
+  size_t size = std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &tm);
+  const auto ms = sc::duration_cast<sc::milliseconds>(record.time.time_since_epoch()).count() % 1000;
+  size += std::snprintf(stamp + size, sizeof(stamp) - size, ".%03d ", static_cast<int>(ms));
+  std::clog.write(stamp, size) << GetName(record.level) << ' ';
+  std::clog.write(record.text, record.size) << '\n';
+}
+
+/**
+ * Hand the queued messages to the sink, drain_mutex must be held
+ * @return Number of messages handed
+ */
+size_t Drain() {
+  size_t count = 0;
+  for (;; ++tail, ++count) {
+    Slot& slot = slots[tail & (Logger::kCapacity - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != tail + 1) break;
+    const Record record{slot.level, slot.time, slot.text, slot.size};
+    try {
+      if (sink) {
+        sink(record);
+      } else {
+        WriteClog(record);
+      }
+    } catch (...) {
+      // A failing sink loses the message, not the ring
+    }
+    slot.sequence.store(tail + Logger::kCapacity, std::memory_order_release);
+  }
+  if (count && !sink) std::clog.flush();
+  return count;
+}
+
+/**
+ * Background thread handing the queued messages to the sink, started by the first message and stopped at exit
+ */
+class Drainer {
+ public:
+  /**
+   * Ctor, prepares the ring and starts the thread
+   */
+  Drainer() : stopping_(false), mutex_(), wake_(), thread_() {
+    for (size_t i = 0; i < Logger::kCapacity; ++i) slots[i].sequence.store(i, std::memory_order_relaxed);
+    utility::Thread::Attributes attributes;
+    attributes.name = "protocol-log";
+    thread_.reset(new utility::Thread(attributes, [this]() { Run(); }));
+  }
+
+  /**
+   * Dtor, stops the thread and hands over what is left
+   */
+  ~Drainer() {
+    shutdown = true;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    wake_.notify_one();
+    thread_.reset();
+    std::lock_guard<std::mutex> lock(drain_mutex);
+    Drain();
+  }
+
+ private:
+  /**
+   * Thread body
+   */
+  void Run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+      lock.unlock();
+      size_t count;
+      {
+        std::lock_guard<std::mutex> drain_lock(drain_mutex);
+        count = Drain();
+      }
+      lock.lock();
+      // Writers don't signal, polling keeps them free of any lock
+      if (!count) wake_.wait_for(lock, sc::milliseconds(kIdleMs), [this]() { return stopping_; });
+    }
+  }
+
+  bool stopping_;                            ///< Whether the thread must stop
+  std::mutex mutex_;                         ///< Protects stopping_
+  std::condition_variable wake_;             ///< Wakes the thread up to stop
+  std::unique_ptr<utility::Thread> thread_;  ///< Background thread
+};
+
+/**
+ * Get the background thread, starting it on first use
+ * @return Background thread
+ */
+Drainer& GetDrainer() {
+  static Drainer drainer;
+  return drainer;
+}
+
+/**
+ * Fixed size stream buffer, characters beyond its size are discarded
+ */
+class Buffer : public std::streambuf {
+ public:
+  /**
+   * Ctor
+   */
+  Buffer() {
+    Reset();
+  }
+
+  /**
+   * Discard the content
+   */
+  void Reset() {
+    setp(text_, text_ + Logger::kMaxMessage);
+  }
+
+  /**
+   * Get the content
+   * @return Content
+   */
+  const char* GetText() const {
+    return pbase();
+  }
+
+  /**
+   * Get the size of the content
+   * @return Size
+   */
+  size_t GetSize() const {
+    return pptr() - pbase();
+  }
+
+ private:
+  char text_[Logger::kMaxMessage];  ///< Storage
+};
+
+/**
+ * Message buffer and stream of a thread
+ */
+struct Formatter {
+  /**
+   * Ctor
+   */
+  Formatter() : buffer(), stream(&buffer) {}
+
+  Buffer buffer;        ///< Message buffer
+  std::ostream stream;  ///< Stream over the buffer
+};
+
+/**
+ * Get the formatter of the calling thread
+ * @return Formatter
+ */
+Formatter& GetFormatter() {
+  thread_local Formatter formatter;
+  return formatter;
+}
+
+}  // namespace
+
+void Logger::SetLevel(Level level) {
+  level_.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+Level Logger::GetLevel() {
+  return static_cast<Level>(level_.load(std::memory_order_relaxed));
+}
+
+void Logger::SetSink(const Sink& new_sink) {
+  std::lock_guard<std::mutex> lock(drain_mutex);
+  sink = new_sink;
+}
+
+void Logger::Write(Level level, const char* text, size_t size) {
+  if (shutdown) return;
+  GetDrainer();
+
+  size_t pos = head.load(std::memory_order_relaxed);
+  Slot* slot;
+  while (true) {
+    slot = &slots[pos & (kCapacity - 1)];
+    const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+    const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence - pos);
+    if (!diff) {
+      if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+    } else if (diff < 0) {
+      ++dropped;
+      return;
+    } else {
+      pos = head.load(std::memory_order_relaxed);
+    }
+  }
+
+  slot->level = level;
+  slot->time = sc::system_clock::now();
+  slot->size = std::min(size, kMaxMessage);
+  std::memcpy(slot->text, text, slot->size);
+  slot->sequence.store(pos + 1, std::memory_order_release);
+  ++written;
+}
+
+void Logger::Flush() {
+  if (shutdown) return;
+  GetDrainer();
+  std::lock_guard<std::mutex> lock(drain_mutex);
+  Drain();
+}
+
+Logger::Stats Logger::GetStats() {
+  return Stats{written, dropped};
+}
+
+Message::Message(Level level) : level_(level), stream_(GetFormatter().stream) {
+  GetFormatter().buffer.Reset();
+  stream_.clear();
+}
+
+Message::~Message() {
+  const Buffer& buffer = GetFormatter().buffer;
+  Logger::Write(level_, buffer.GetText(), buffer.GetSize());
+}
+
+}  // namespace log
+}  // namespace protocol
@@ -0,0 +1,157 @@
+/**
+ * @cond  internal
+ * @file  protocol/log/tests/logger.cpp
+ * @brief Unit tests for protocol::log::Logger
+ */
+
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <protocol/log/log.hpp>
+
+namespace protocol {
+namespace log {
+
+class LoggerTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    level_ = Logger::GetLevel();
+    before_ = Logger::GetStats();
+    Logger::SetSink([this](const Record& record) {
+      const std::string text(record.text, record.size);
+      // Other tests may still have connections logging
+      if (text.compare(0, kPrefix.size(), kPrefix)) return;
+      std::lock_guard<std::mutex> lock(mutex_);
+      records_.push_back(std::make_pair(record.level, text.substr(kPrefix.size())));
+    });
+  }
+
+  virtual void TearDown() {
+    Logger::Flush();
+    Logger::SetSink(Logger::Sink());
+    Logger::SetLevel(level_);
+  }
+
+  /**
+   * Get the messages of the test handed to the sink
+   * @return Levels and messages, without the prefix
+   */
+  std::vector<std::pair<Level, std::string>> GetRecords() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return records_;
+  }
+
+  const std::string kPrefix = "LoggerTest ";            ///< Prefix of the messages of the test
+  Level level_;                                         ///< Level restored after the test
+  Logger::Stats before_;                                ///< Counters when the test started
+  std::mutex mutex_;                                    ///< Protects records_
+  std::vector<std::pair<Level, std::string>> records_;  ///< Messages of the test handed to the sink
+};
+
+/**
+ * @test Disabled levels aren't formatted
+ */
+TEST_F(LoggerTest, Levels) {
+  size_t formatted = 0;
+  auto format = [&formatted]() { return ++formatted; };
+
+  Logger::SetLevel(Level::kWarning);
+  PROTOCOL_LOG_DEBUG(kPrefix << "debug " << format());
+  PROTOCOL_LOG_INFO(kPrefix << "info " << format());
+  PROTOCOL_LOG_WARNING(kPrefix << "warning " << format());
+  PROTOCOL_LOG_ERROR(kPrefix << "error " << format());
+  Logger::Flush();
+
+  ASSERT_EQ(2u, formatted);
+  auto records = GetRecords();
+  ASSERT_EQ(2u, records.size());
+  ASSERT_EQ(Level::kWarning, records[0].first);
+  ASSERT_EQ("warning 1", records[0].second);
+  ASSERT_EQ(Level::kError, records[1].first);
+  ASSERT_EQ("error 2", records[1].second);
+  ASSERT_STREQ("WARNING", GetName(records[0].first));
+
+  Logger::SetLevel(Level::kOff);
+  PROTOCOL_LOG_ERROR(kPrefix << "error " << format());
+  Logger::Flush();
+  ASSERT_EQ(2u, formatted);
+  ASSERT_EQ(2u, GetRecords().size());
+}
+
+/**
+ * @test Long messages are truncated
+ */
+TEST_F(LoggerTest, Truncation) {
+  Logger::SetLevel(Level::kInfo);
+  PROTOCOL_LOG_INFO(kPrefix << std::string(2 * Logger::kMaxMessage, 'x'));
+  PROTOCOL_LOG_INFO(kPrefix << "short");
+  Logger::Flush();
+
+  auto records = GetRecords();
+  ASSERT_EQ(2u, records.size());
+  ASSERT_EQ(std::string(Logger::kMaxMessage - kPrefix.size(), 'x'), records[0].second);
+  ASSERT_EQ("short", records[1].second);
+}
+
+/**
+ * @test Messages of concurrent writers are all delivered, in order per writer
+ */
+TEST_F(LoggerTest, Concurrent) {
+  const size_t kThreads = 4, kMessages = 500;
+  Logger::SetLevel(Level::kInfo);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (size_t i = 0; i < kMessages; ++i) PROTOCOL_LOG_INFO(kPrefix << t << " " << i);
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  Logger::Flush();
+
+  auto records = GetRecords();
+  ASSERT_EQ(kThreads * kMessages, records.size());
+  std::vector<size_t> next(kThreads, 0);
+  for (auto& record : records) {
+    const size_t t = std::stoul(record.second);
+    ASSERT_EQ(std::to_string(t) + " " + std::to_string(next[t]++), record.second);
+  }
+}
+
+/**
+ * @test Writers drop messages rather than wait while the ring is full
+ */
+TEST_F(LoggerTest, Full) {
+  std::promise<void> entered, release;
+  std::shared_future<void> released(release.get_future());
+  bool blocked = false;
+  Logger::SetSink([&](const Record&) {
+    if (blocked) return;
+    blocked = true;
+    entered.set_value();
+    released.wait();
+  });
+  Logger::SetLevel(Level::kInfo);
+  PROTOCOL_LOG_INFO(kPrefix << "blocking");
+  entered.get_future().wait();
+
+  const size_t kMessages = Logger::kCapacity + 100;
+  for (size_t i = 0; i < kMessages; ++i) PROTOCOL_LOG_INFO(kPrefix << i);
+  const Logger::Stats stats = Logger::GetStats();
+  release.set_value();
+  // The sink refers to the locals of the test
+  Logger::Flush();
+  Logger::SetSink(Logger::Sink());
+  ASSERT_LE(100u, stats.dropped - before_.dropped);
+  ASSERT_LE(kMessages + 1, stats.written - before_.written + stats.dropped - before_.dropped);
+}
+
+}  // namespace log
+}  // namespace protocol
+
+/// @endcond internal
@@ -5,44 +5,150 @@
  */
 
 #include <boost/asio/io_service.hpp>
-#include <future>
+#include <boost/asio/generic/stream_protocol.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <vector>
 
+#include <protocol/service/config.hpp>
+#include <protocol/service/topology.hpp>
+#include "protocol/utility/thread.hpp"
+
 namespace protocol {
 namespace service {
 
 /**
- * Encapsulates boost::asio::io_service instance and runs a configurable number of threads on it.
+ * Pool of boost::asio::io_service instances, each one run by a single thread.
  */
 class Service {
  public:
   /**
-   * Start an io service specifying the number of threads to run it on
-   * @param num_threads Number of threads to run io_service on
+   * Start the pool
+   * @param config Pool configuration
    */
-  explicit Service(unsigned int num_threads);
+  explicit Service(const Config& config);
 
   /**
-   * Dtor
+   * Dtor, stops the pool without draining if Shutdown() wasn't called. Called from a pool thread, e.g. when that
+   * thread drops the last reference to the pool, the other threads are joined and the calling one is left to return
+   * from its handler and exit on its own, its io_service freed by that thread
    */
   ~Service();
 
   /**
-   * Get a reference to the io_service instance
+   * Let the io_services run out of work and join their threads. Handlers still pending after the timeout are
+   * abandoned by stopping the io_services.
+   * @param timeout_ms How long to wait for outstanding handlers to complete
+   * @return True if every handler completed before the timeout
+   * @throws std::logic_error if called from one of the pool threads
+   */
+  bool Shutdown(size_t timeout_ms);
+
+  /**
+   * Get a reference to the io_service chosen by the placement policy
    * @return A reference to the io_service
    */
   boost::asio::io_service& GetService();
 
+  /**
+   * Get a reference to the io_service at the given position of the pool
+   * @param index Position in the pool, must be lower than GetSize()
+   * @return A reference to the io_service
+   */
+  boost::asio::io_service& GetService(size_t index);
+
+  /**
+   * Get the number of io_services in the pool
+   * @return Pool size
+   */
+  size_t GetSize() const;
+
+  /**
+   * Get the CPU and NUMA mapping of the workers
+   * @return One entry per worker
+   */
+  Topology GetTopology() const;
+
+  /**
+   * Get the position of the worker running the calling thread
+   * @return Worker index or -1 if the calling thread doesn't belong to this pool
+   */
+  int GetCurrentWorker() const;
+
+  /**
+   * Get the io_service run by the calling thread, whichever pool it belongs to
+   * @return The io_service, nullptr if the calling thread isn't a pool worker
+   */
+  static const boost::asio::io_service* GetCurrentService();
+
+  /**
+   * Create a socket bound to the io_service chosen by the placement policy
+   * @return A shared pointer to a newly created socket
+   */
+  std::shared_ptr<boost::asio::generic::stream_protocol::socket> NewSocket();
+
+  /**
+   * Create a socket bound to the io_service at the given position of the pool
+   * @param index Position in the pool, must be lower than GetSize()
+   * @return A shared pointer to a newly created socket
+   */
+  std::shared_ptr<boost::asio::generic::stream_protocol::socket> NewSocket(size_t index);
+
  private:
+  /**
+   * An io_service and the thread running it
+   */
+  struct Worker {
+    Worker()
+        : service(1), work(new boost::asio::io_service::work(service)), load(new std::atomic<size_t>(0)),
+          orphaned(false) {}
+
+    boost::asio::io_service service;                          ///< The boost::asio::io_service instance
+    std::unique_ptr<boost::asio::io_service::work> work;      ///< Keeps io_service awake
+    std::shared_ptr<std::atomic<size_t>> load;                ///< Number of live sockets bound to service
+    std::unique_ptr<utility::Thread> thread;                  ///< Thread running service
+    WorkerInfo info;                                          ///< CPU and NUMA mapping
+    bool orphaned;                                            ///< Pool destroyed from this worker, which frees itself
+  };
+
   Service() = delete;                            ///< Delete default constructor
   Service(Service const&) = delete;              ///< Delete copy construct
   Service(Service&&) = delete;                   ///< Delete move construct
   Service& operator=(Service const&) = delete;   ///< Delete copy assignment
   Service& operator=(Service const&&) = delete;  ///< Delete move assignment
 
-  boost::asio::io_service service_;            ///< The boost::asio::io_service instance
-  std::shared_ptr<boost::asio::io_service::work> dummy_work_;   ///< Keeps io_service awake
-  std::vector<std::future<void>> io_workers_;  ///< Container for io_service threads
+  /**
+   * Choose a worker according to the placement policy
+   * @return The chosen worker
+   */
+  Worker& Pick();
+
+  /**
+   * Create a socket bound to the io_service of a worker, accounted as load of that worker
+   * @param worker The worker
+   * @return A shared pointer to a newly created socket
+   */
+  std::shared_ptr<boost::asio::generic::stream_protocol::socket> NewSocket(Worker& worker);
+
+  /**
+   * Body of the worker threads
+   * @param worker Worker to run
+   */
+  void Run(Worker& worker);
+
+  Placement placement_;                          ///< Placement policy
+  bool numa_local_;                              ///< Restrict placement to the caller's NUMA node
+  std::vector<size_t> all_;                      ///< Indexes of every worker
+  std::map<int, std::vector<size_t>> nodes_;     ///< Indexes of the workers of each NUMA node
+  std::atomic<size_t> next_;                     ///< Round-robin cursor
+  std::vector<std::unique_ptr<Worker>> workers_; ///< The pool
+  std::mutex mutex_;                             ///< Protects running_
+  std::condition_variable exited_;               ///< Signalled when a worker thread leaves its io_service
+  size_t running_;                               ///< Number of worker threads still running their io_service
+  bool shutdown_;                                ///< Shutdown state
 };
 
 }  // namespace service
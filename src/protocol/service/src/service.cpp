@@ -3,32 +3,251 @@
  * @brief  Class definition of protocol::service::Service
  */
 
-#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string>
 #include <thread>
 #include <vector>
+#include <protocol/log/log.hpp>
+
 #include "protocol/service/service.hpp"
+#include "protocol/utility/cpu.hpp"
 
 namespace protocol {
 namespace service {
 
-Service::Service(unsigned int num_threads) :
-    service_(),
-    dummy_work_(std::shared_ptr<boost::asio::io_service::work>(new boost::asio::io_service::work(service_))) {
-  for (size_t i = 0; i < num_threads; ++i) {
-    io_workers_.push_back(std::async(std::launch::async, [&]() { service_.run(); }));
+namespace {
+
+/**
+ * Identifies the pool worker running the current thread
+ */
+struct CurrentWorker {
+  const Service* service;             ///< Pool the thread belongs to
+  size_t index;                       ///< Worker position in the pool
+  const boost::asio::io_service* io;  ///< io_service run by the thread
+};
+
+thread_local CurrentWorker current_worker = {nullptr, 0, nullptr};
+
+/**
+ * Compute the CPU set of a worker
+ * @param config Pool configuration
+ * @param index  Worker position in the pool
+ * @return CPU set, empty if the worker isn't pinned
+ */
+std::vector<unsigned> GetWorkerCpus(const Config& config, size_t index) {
+  if (!config.worker_affinity.empty()) {
+    return config.worker_affinity[index % config.worker_affinity.size()];
+  }
+  if (config.pin_workers) {
+    if (!config.cpu_affinity.empty()) {
+      return {config.cpu_affinity[index % config.cpu_affinity.size()]};
+    }
+    const std::vector<unsigned> allowed = utility::GetAllowedCpus();
+    return {allowed[index % allowed.size()]};
+  }
+  return config.cpu_affinity;
+}
+
+/**
+ * Find the NUMA node shared by a set of CPUs
+ * @param cpus CPU set
+ * @return NUMA node index or -1 if unknown or not shared
+ */
+int GetNumaNode(const std::vector<unsigned>& cpus) {
+  int node = -1;
+  for (size_t i = 0; i < cpus.size(); ++i) {
+    const int cpu_node = utility::GetNumaNode(cpus[i]);
+    if (cpu_node < 0 || (i && cpu_node != node)) return -1;
+    node = cpu_node;
+  }
+  return node;
+}
+
+}  // namespace
+
+Service::Service(const Config& config)
+    : placement_(config.placement), numa_local_(config.numa_local), next_(0), running_(0), shutdown_(false) {
+  if (!config.num_threads) throw std::invalid_argument("Service needs at least one thread");
+
+  for (size_t i = 0; i < config.num_threads; ++i) {
+    workers_.emplace_back(new Worker());
+    Worker& worker = *workers_.back();
+    worker.info.index = i;
+    worker.info.cpus = GetWorkerCpus(config, i);
+    worker.info.numa_node = GetNumaNode(worker.info.cpus);
+    all_.push_back(i);
+    if (worker.info.numa_node >= 0) nodes_[worker.info.numa_node].push_back(i);
+  }
+
+  utility::Thread::Attributes attributes;
+  attributes.stack_size = config.stack_size;
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    if (!config.thread_name.empty()) attributes.name = config.thread_name + "-" + std::to_string(i);
+    attributes.cpus = workers_[i]->info.cpus;
+    Worker* worker = workers_[i].get();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++running_;
+    }
+    try {
+      worker->thread.reset(new utility::Thread(attributes, [this, worker]() { Run(*worker); }));
+    } catch (...) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --running_;
+      }
+      Shutdown(0);
+      throw;
+    }
   }
 }
 
 Service::~Service() {
-  dummy_work_.reset();
-//  for (auto & worker : io_workers_) {
-//    worker.get();
-//  }
-  service_.stop();
+  if (shutdown_) return;
+  auto current = std::find_if(workers_.begin(), workers_.end(), [](const std::unique_ptr<Worker>& worker) {
+    return worker->thread && worker->thread->IsCurrent();
+  });
+  if (workers_.end() == current) {
+    Shutdown(0);
+    return;
+  }
+
+  // Shutdown() can't join the calling thread, whose io_service is still running below this handler. That worker is
+  // handed over to its thread, which detaches and frees it once run() returns, without touching the pool again
+  shutdown_ = true;
+  for (auto& worker : workers_) {
+    worker->work.reset();
+    worker->service.stop();
+  }
+  (*current)->orphaned = true;
+  (*current)->thread.reset();
+  current->release();
+  for (auto& worker : workers_) {
+    if (worker && worker->thread) worker->thread->Join();
+  }
+}
+
+bool Service::Shutdown(size_t timeout_ms) {
+  for (auto& worker : workers_) {
+    if (worker->thread && worker->thread->IsCurrent()) throw std::logic_error("Can't shutdown from a pool thread");
+  }
+  shutdown_ = true;
+
+  // Without the work guards each io_service returns from run() once its outstanding handlers are done
+  for (auto& worker : workers_) {
+    worker->work.reset();
+  }
+
+  bool drained;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    drained = exited_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this]() { return 0 == running_; });
+  }
+
+  for (auto& worker : workers_) {
+    if (!drained) worker->service.stop();
+    if (worker->thread) worker->thread->Join();
+  }
+  return drained;
 }
 
 boost::asio::io_service& Service::GetService() {
-  return service_;
+  return Pick().service;
+}
+
+boost::asio::io_service& Service::GetService(size_t index) {
+  return workers_.at(index)->service;
+}
+
+size_t Service::GetSize() const {
+  return workers_.size();
+}
+
+Topology Service::GetTopology() const {
+  Topology topology;
+  for (auto& worker : workers_) {
+    topology.push_back(worker->info);
+  }
+  return topology;
+}
+
+int Service::GetCurrentWorker() const {
+  return this == current_worker.service ? static_cast<int>(current_worker.index) : -1;
+}
+
+const boost::asio::io_service* Service::GetCurrentService() {
+  return current_worker.io;
+}
+
+std::shared_ptr<boost::asio::generic::stream_protocol::socket> Service::NewSocket() {
+  return NewSocket(Pick());
+}
+
+std::shared_ptr<boost::asio::generic::stream_protocol::socket> Service::NewSocket(size_t index) {
+  return NewSocket(*workers_.at(index));
+}
+
+std::shared_ptr<boost::asio::generic::stream_protocol::socket> Service::NewSocket(Worker& worker) {
+  using Socket = boost::asio::generic::stream_protocol::socket;
+  std::shared_ptr<std::atomic<size_t>> load = worker.load;
+  ++*load;
+  return std::shared_ptr<Socket>(new Socket(worker.service), [load](Socket* sock) {
+    delete sock;
+    --*load;
+  });
+}
+
+void Service::Run(Worker& worker) {
+  current_worker.service = this;
+  current_worker.index = worker.info.index;
+  current_worker.io = &worker.service;
+
+  for (;;) {
+    try {
+      worker.service.run();
+      break;
+    } catch (const std::exception& e) {
+      // A handler threw, keep serving the remaining ones
+      PROTOCOL_LOG_ERROR("Handler of worker " << worker.info.index << " threw: " << e.what());
+    } catch (...) {
+      PROTOCOL_LOG_ERROR("Handler of worker " << worker.info.index << " threw an unknown exception");
+    }
+  }
+
+  current_worker.service = nullptr;
+  current_worker.io = nullptr;
+  if (worker.orphaned) {
+    delete &worker;
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  --running_;
+  exited_.notify_all();
+}
+
+Service::Worker& Service::Pick() {
+  const std::vector<size_t>* candidates = &all_;
+  const int current = GetCurrentWorker();
+  if (numa_local_ && current >= 0) {
+    auto node = nodes_.find(workers_[current]->info.numa_node);
+    if (nodes_.end() != node) candidates = &node->second;
+  }
+
+  const size_t start = next_++ % candidates->size();
+  if (Placement::kRoundRobin == placement_) {
+    return *workers_[(*candidates)[start]];
+  }
+
+  // Scan from the round-robin cursor so that ties are spread over the candidates
+  size_t best = (*candidates)[start];
+  for (size_t i = 1; i < candidates->size(); ++i) {
+    const size_t idx = (*candidates)[(start + i) % candidates->size()];
+    if (*workers_[idx]->load < *workers_[best]->load) best = idx;
+  }
+  return *workers_[best];
 }
 
 }  // namespace service
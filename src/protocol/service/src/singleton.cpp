@@ -4,6 +4,8 @@
  */
 
 #include <mutex>
+#include <stdexcept>
+#include <utility>
 #include <protocol/service/singleton.hpp>
 #include "protocol/service/service.hpp"
 
@@ -12,35 +14,93 @@ namespace service {
 namespace singleton {
 
 static Service* service = nullptr;
+static Config config;
+static bool draining = false;
 
 static std::mutex& GetMutex() {
   static std::mutex m_;
   return m_;
 }
 
-void TearDown() {
-  GetMutex().lock();
-  if (nullptr != service) {
-    delete service;
-    service = nullptr;
+static Service& GetPool() {
+  std::lock_guard<std::mutex> lock(GetMutex());
+  if (draining) throw std::runtime_error("The io_service pool is draining");
+  if (nullptr == service) {
+    service = new Service(config);
   }
-  GetMutex().unlock();
+  return *service;
 }
 
+/**
+ * Detach the pool from the singleton and shut it down. New work is refused until the shutdown completes
+ * @param timeout_ms How long to wait for outstanding handlers, 0 stops immediately
+ * @return True if every handler completed before the timeout
+ */
+static bool Release(size_t timeout_ms) {
+  Service* old = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(GetMutex());
+    if (nullptr == service || draining) return true;
+    std::swap(old, service);
+    draining = true;
+  }
 
-boost::asio::io_service& Instance() {
-  static const unsigned int kNumServiceThreads = 5;
-  GetMutex().lock();
-  if (nullptr == service) {
-    service = new Service(kNumServiceThreads);
+  bool drained = false;
+  try {
+    drained = old->Shutdown(timeout_ms);
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(GetMutex());
+    std::swap(old, service);
+    draining = false;
+    throw;
   }
-  if (service->GetService().stopped()) {
-    delete service;
-    service = new Service(kNumServiceThreads);
+  delete old;
+
+  std::lock_guard<std::mutex> lock(GetMutex());
+  draining = false;
+  return drained;
+}
+
+void TearDown() {
+  Release(0);
+}
+
+bool Drain() {
+  size_t timeout_ms;
+  {
+    std::lock_guard<std::mutex> lock(GetMutex());
+    timeout_ms = config.drain_timeout_ms;
   }
-  GetMutex().unlock();
+  return Release(timeout_ms);
+}
+
+void Configure(const Config& new_config) {
+  std::lock_guard<std::mutex> lock(GetMutex());
+  config = new_config;
+}
+
+boost::asio::io_service& Instance() {
+  return GetPool().GetService();
+}
+
+boost::asio::io_service& Instance(size_t index) {
+  return GetPool().GetService(index);
+}
+
+Topology GetTopology() {
+  return GetPool().GetTopology();
+}
+
+std::shared_ptr<boost::asio::generic::stream_protocol::socket> NewSocket() {
+  return GetPool().NewSocket();
+}
+
+std::shared_ptr<boost::asio::generic::stream_protocol::socket> NewSocket(size_t index) {
+  return GetPool().NewSocket(index);
+}
 
-  return service->GetService();
+bool RunsInThisThread(const boost::asio::io_service& service) {
+  return &service == Service::GetCurrentService();
 }
 
 }  // namespace singleton
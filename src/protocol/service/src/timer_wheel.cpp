@@ -0,0 +1,211 @@
+/**
+ * @file   protocol/service/src/timer_wheel.cpp
+ * @brief  Class definitions of protocol::service::TimerWheel and protocol::service::Timer
+ */
+
+#include <boost/bind.hpp>
+#include <utility>
+
+#include <protocol/service/timer_wheel.hpp>
+
+namespace protocol {
+namespace service {
+
+namespace ba = boost::asio;
+namespace bs = boost::system;
+
+Timer::Timer(ba::io_service& service)
+    : service_(service),
+      wheel_(ba::use_service<TimerWheel>(service)),
+      prev_(nullptr),
+      next_(nullptr),
+      due_(0),
+      armed_(false),
+      expired_(false) {
+}
+
+Timer::~Timer() {
+  Cancel();
+}
+
+void Timer::Arm(size_t timeout_ms, Handler handler) {
+  wheel_.Arm(*this, timeout_ms, std::move(handler));
+}
+
+bool Timer::Cancel() {
+  return wheel_.Cancel(*this);
+}
+
+ba::io_service& Timer::GetService() {
+  return service_;
+}
+
+ba::io_service::id TimerWheel::id;
+
+TimerWheel::TimerWheel(ba::io_service& service)
+    : ba::io_service::service(service),
+      start_(Clock::now()),
+      ticker_(service),
+      slots_(kNumSlots, nullptr),
+      expired_head_(nullptr),
+      expired_tail_(nullptr),
+      cursor_(1),
+      wake_(0),
+      waiting_(false),
+      shutdown_(false),
+      size_(0) {
+}
+
+size_t TimerWheel::GetSize() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return size_;
+}
+
+void TimerWheel::shutdown_service() {
+  std::vector<Timer::Handler> handlers;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
+    for (Timer* head : slots_) {
+      while (head) {
+        Timer* timer = head;
+        head = head->next_;
+        handlers.push_back(std::move(timer->handler_));
+        Unlink(*timer);
+      }
+    }
+    while (expired_head_) {
+      handlers.push_back(std::move(expired_head_->handler_));
+      Unlink(*expired_head_);
+    }
+    ticker_.cancel();
+  }
+  // Handlers are destroyed without the lock, they may own objects whose timers cancel on destruction
+}
+
+void TimerWheel::Arm(Timer& timer, size_t timeout_ms, Timer::Handler&& handler) {
+  Timer::Handler previous;
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (shutdown_) return;
+
+  if (timer.armed_) {
+    previous = std::move(timer.handler_);
+    Unlink(timer);
+  }
+
+  timer.due_ = Now() + (timeout_ms ? timeout_ms : 1);
+  if (timer.due_ < cursor_) timer.due_ = cursor_;
+  timer.handler_ = std::move(handler);
+  timer.armed_ = true;
+
+  Timer*& head = slots_[timer.due_ & (kNumSlots - 1)];
+  timer.prev_ = nullptr;
+  timer.next_ = head;
+  if (head) head->prev_ = &timer;
+  head = &timer;
+  ++size_;
+
+  if (!waiting_ || timer.due_ < wake_) Schedule();
+}
+
+bool TimerWheel::Cancel(Timer& timer) {
+  Timer::Handler handler;
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!timer.armed_) return false;
+
+  handler = std::move(timer.handler_);
+  Unlink(timer);
+  return true;
+}
+
+void TimerWheel::Unlink(Timer& timer) {
+  if (timer.prev_) {
+    timer.prev_->next_ = timer.next_;
+  } else if (timer.expired_) {
+    expired_head_ = timer.next_;
+  } else {
+    slots_[timer.due_ & (kNumSlots - 1)] = timer.next_;
+  }
+  if (timer.next_) {
+    timer.next_->prev_ = timer.prev_;
+  } else if (timer.expired_) {
+    expired_tail_ = timer.prev_;
+  }
+  timer.prev_ = timer.next_ = nullptr;
+  timer.armed_ = false;
+  timer.expired_ = false;
+  --size_;
+}
+
+uint64_t TimerWheel::Now() const {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start_).count();
+}
+
+void TimerWheel::Schedule() {
+  if (!size_) return;
+
+  // Wake up on the next occupied slot, timers due in later rounds just cause an early wake up
+  uint64_t tick = cursor_;
+  for (size_t i = 0; i < kNumSlots && !slots_[tick & (kNumSlots - 1)]; ++i) {
+    ++tick;
+  }
+  // Only expired timers are left, their handlers are about to run
+  if (!slots_[tick & (kNumSlots - 1)]) return;
+  if (waiting_ && wake_ <= tick) return;
+
+  wake_ = tick;
+  waiting_ = true;
+  ticker_.expires_at(start_ + std::chrono::milliseconds(tick));
+  ticker_.async_wait(boost::bind(&TimerWheel::OnTick, this, _1));
+}
+
+void TimerWheel::OnTick(const bs::error_code& ec) {
+  // Aborted waits were replaced by an earlier one
+  if (ba::error::operation_aborted == ec) return;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    waiting_ = false;
+    if (shutdown_) return;
+
+    const uint64_t now = Now();
+    // After a long stall one pass over the wheel covers every slot
+    if (now >= cursor_ + kNumSlots) cursor_ = now + 1 - kNumSlots;
+    for (; cursor_ <= now; ++cursor_) {
+      Timer* timer = slots_[cursor_ & (kNumSlots - 1)];
+      while (timer) {
+        Timer* next = timer->next_;
+        if (timer->due_ <= now) {
+          // Moved to the expired list, where it stays armed and cancellable until its handler is taken
+          Unlink(*timer);
+          timer->armed_ = timer->expired_ = true;
+          timer->prev_ = expired_tail_;
+          (expired_tail_ ? expired_tail_->next_ : expired_head_) = timer;
+          expired_tail_ = timer;
+          ++size_;
+        }
+        timer = next;
+      }
+    }
+    Schedule();
+  }
+
+  // Another thread running the io_service may take handlers of this tick as well, each runs once
+  Timer::Handler handler;
+  while (TakeExpired(handler)) {
+    handler();
+  }
+}
+
+bool TimerWheel::TakeExpired(Timer::Handler& handler) {
+  // The previous handler is destroyed without the lock, it may own objects whose timers cancel on destruction
+  Timer::Handler previous = std::move(handler);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!expired_head_) return false;
+  handler = std::move(expired_head_->handler_);
+  Unlink(*expired_head_);
+  return true;
+}
+
+}  // namespace service
+}  // namespace protocol
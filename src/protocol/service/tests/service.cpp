@@ -0,0 +1,206 @@
+/**
+ * @cond   internal
+ * @file   protocol/service/tests/service.cpp
+ * @brief  Unit tests for protocol::service::Service
+ */
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/deadline_timer.hpp>
+
+#include <gtest/gtest.h>
+
+#include <protocol/log/log.hpp>
+
+#include "protocol/service/service.hpp"
+#include "protocol/utility/cpu.hpp"
+
+namespace protocol {
+namespace service {
+
+namespace ba = boost::asio;
+
+/**
+ * @test Tests round-robin placement cycles through the whole pool
+ */
+TEST(Service, RoundRobin) {
+  Config config;
+  config.num_threads = 3;
+  config.placement = Placement::kRoundRobin;
+  Service service(config);
+  ASSERT_EQ(3u, service.GetSize());
+
+  std::set<ba::io_service*> seen;
+  for (size_t i = 0; i < service.GetSize(); ++i) {
+    seen.insert(&service.GetService());
+  }
+  ASSERT_EQ(3u, seen.size());
+  ASSERT_EQ(&service.GetService(0), &service.GetService());
+}
+
+/**
+ * @test Tests least-loaded placement picks the io_service with fewest live sockets
+ */
+TEST(Service, LeastLoaded) {
+  Config config;
+  config.num_threads = 2;
+  config.placement = Placement::kLeastLoaded;
+  Service service(config);
+
+  std::vector<std::shared_ptr<ba::generic::stream_protocol::socket>> sockets;
+  sockets.push_back(service.NewSocket());
+  sockets.push_back(service.NewSocket());
+  ASSERT_NE(&sockets[0]->get_io_service(), &sockets[1]->get_io_service());
+
+  // Releasing a socket makes its io_service the least loaded one
+  ba::io_service* released = &sockets[1]->get_io_service();
+  sockets.pop_back();
+  for (size_t i = 0; i < 3; ++i) {
+    sockets.push_back(service.NewSocket());
+    ASSERT_EQ(released, &sockets.back()->get_io_service());
+    sockets.pop_back();
+  }
+}
+
+/**
+ * @test Tests an empty pool is rejected
+ */
+TEST(Service, NoThreads) {
+  Config config;
+  config.num_threads = 0;
+  ASSERT_THROW(Service service(config), std::invalid_argument);
+}
+
+/**
+ * @test Tests shutdown waits for outstanding handlers
+ */
+TEST(Service, Drain) {
+  Config config;
+  config.num_threads = 2;
+  Service service(config);
+
+  std::atomic<int> done(0);
+  for (size_t i = 0; i < 4; ++i) {
+    service.GetService().post([&done]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      ++done;
+    });
+  }
+  ASSERT_TRUE(service.Shutdown(1000));
+  ASSERT_EQ(4, done);
+}
+
+/**
+ * @test Tests shutdown gives up on handlers that outlive the deadline
+ */
+TEST(Service, DrainDeadline) {
+  Config config;
+  config.num_threads = 1;
+  Service service(config);
+
+  bool fired = false;
+  ba::deadline_timer timer(service.GetService(), boost::posix_time::seconds(60));
+  timer.async_wait([&fired](const boost::system::error_code&) { fired = true; });
+  ASSERT_FALSE(service.Shutdown(10));
+  ASSERT_FALSE(fired);
+}
+
+/**
+ * @test Tests pinned workers run on the CPU reported by the topology
+ */
+TEST(Service, PinWorkers) {
+  Config config;
+  config.num_threads = 2;
+  config.pin_workers = true;
+  Service service(config);
+
+  Topology topology = service.GetTopology();
+  ASSERT_EQ(2u, topology.size());
+  for (size_t i = 0; i < topology.size(); ++i) {
+    ASSERT_EQ(i, topology[i].index);
+    ASSERT_EQ(1u, topology[i].cpus.size());
+    ASSERT_EQ(topology[i].numa_node, utility::GetNumaNode(topology[i].cpus[0]));
+
+    std::promise<std::pair<int, int>> where;
+    service.GetService(i).post([&]() {
+      where.set_value(std::make_pair(service.GetCurrentWorker(), utility::GetCurrentCpu()));
+    });
+    auto result = where.get_future().get();
+    ASSERT_EQ(static_cast<int>(i), result.first);
+    if (result.second >= 0) {
+      ASSERT_EQ(topology[i].cpus[0], static_cast<unsigned>(result.second));
+    }
+  }
+  ASSERT_EQ(-1, service.GetCurrentWorker());
+}
+
+/**
+ * @test Tests explicit per worker CPU sets
+ */
+TEST(Service, WorkerAffinity) {
+  Config config;
+  config.num_threads = 3;
+  const std::vector<unsigned> cpu{utility::GetAllowedCpus().back()};
+  config.worker_affinity = {cpu, cpu};
+  Service service(config);
+
+  for (auto& worker : service.GetTopology()) {
+    ASSERT_EQ(cpu, worker.cpus);
+  }
+}
+
+/**
+ * @test Tests a throwing handler is logged and doesn't stop its worker
+ */
+TEST(Service, HandlerException) {
+  std::mutex mutex;
+  std::vector<std::string> errors;
+  const log::Level level = log::Logger::GetLevel();
+  log::Logger::SetLevel(log::Level::kError);
+  log::Logger::SetSink([&](const log::Record& record) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (record.level == log::Level::kError) errors.emplace_back(record.text, record.size);
+  });
+
+  Config config;
+  config.num_threads = 1;
+  Service service(config);
+  service.GetService().post([]() { throw std::runtime_error("handler failure"); });
+  std::promise<void> next;
+  service.GetService().post([&next]() { next.set_value(); });
+  next.get_future().wait();
+
+  log::Logger::Flush();
+  log::Logger::SetSink(log::Logger::Sink());
+  log::Logger::SetLevel(level);
+  ASSERT_EQ(1u, errors.size());
+  ASSERT_NE(std::string::npos, errors[0].find("handler failure"));
+}
+
+/**
+ * @test Tests the pool can be destroyed from one of its own handlers, e.g. by the last owner of a shared pointer
+ */
+TEST(Service, DestroyFromWorker) {
+  Config config;
+  config.num_threads = 2;
+  Service* service = new Service(config);
+  std::promise<void> destroyed;
+  service->GetService(0).post([service, &destroyed]() {
+    delete service;
+    destroyed.set_value();
+  });
+  ASSERT_EQ(std::future_status::ready, destroyed.get_future().wait_for(std::chrono::seconds(5)));
+}
+
+}  // namespace service
+}  // namespace protocol
+
+/// @endcond internal
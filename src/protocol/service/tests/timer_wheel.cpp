@@ -0,0 +1,130 @@
+/**
+ * @cond   internal
+ * @file   protocol/service/tests/timer_wheel.cpp
+ * @brief  Unit tests for protocol::service::TimerWheel and protocol::service::Timer
+ */
+
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <protocol/service/singleton.hpp>
+#include <protocol/service/timer_wheel.hpp>
+
+namespace protocol {
+namespace service {
+
+namespace sc = std::chrono;
+namespace ba = boost::asio;
+
+/**
+ * @test Tests an armed timer fires on the io_service thread
+ */
+TEST(TimerWheel, Fires) {
+  Timer timer(singleton::Instance());
+  std::promise<std::thread::id> fired;
+  const auto start = sc::steady_clock::now();
+  timer.Arm(20, [&fired]() { fired.set_value(std::this_thread::get_id()); });
+
+  auto fut = fired.get_future();
+  ASSERT_EQ(std::future_status::ready, fut.wait_for(sc::milliseconds(500)));
+  ASSERT_NE(std::this_thread::get_id(), fut.get());
+  ASSERT_GE(sc::steady_clock::now() - start, sc::milliseconds(20));
+  ASSERT_FALSE(timer.Cancel());
+}
+
+/**
+ * @test Tests cancelled and re-armed timers don't call the replaced handlers
+ */
+TEST(TimerWheel, CancelAndRearm) {
+  Timer cancelled(singleton::Instance());
+  Timer rearmed(cancelled.GetService());
+  std::atomic<int> calls(0);
+  std::promise<void> done;
+
+  cancelled.Arm(10, [&calls]() { calls += 100; });
+  rearmed.Arm(10, [&calls]() { calls += 10; });
+  rearmed.Arm(30, [&calls, &done]() {
+    ++calls;
+    done.set_value();
+  });
+  ASSERT_TRUE(cancelled.Cancel());
+  ASSERT_FALSE(cancelled.Cancel());
+
+  ASSERT_EQ(std::future_status::ready, done.get_future().wait_for(sc::milliseconds(500)));
+  std::this_thread::sleep_for(sc::milliseconds(20));
+  ASSERT_EQ(1, calls);
+}
+
+/**
+ * @test Tests a handler cancels a timer that expired in the same tick before that timer's handler runs
+ */
+TEST(TimerWheel, CancelExpired) {
+  ba::io_service service;
+  Timer first(service);
+  Timer second(service);
+  int calls = 0;
+  bool cancelled = false;
+  first.Arm(5, [&]() {
+    ++calls;
+    cancelled = second.Cancel();
+  });
+  second.Arm(5, [&]() {
+    ++calls;
+    cancelled = first.Cancel();
+  });
+
+  // Both are due by the time the wheel ticks
+  std::this_thread::sleep_for(sc::milliseconds(20));
+  service.run();
+  ASSERT_EQ(1, calls);
+  ASSERT_TRUE(cancelled);
+  ASSERT_EQ(0u, ba::use_service<TimerWheel>(service).GetSize());
+}
+
+/**
+ * @test Tests timers expire in order, including ones beyond a full turn of the wheel
+ */
+TEST(TimerWheel, Order) {
+  ba::io_service service;
+  std::vector<size_t> fired;
+  std::vector<std::unique_ptr<Timer>> timers;
+  const size_t timeouts[] = {TimerWheel::kNumSlots + 5, 5, 30, 1, 15};
+  for (size_t timeout : timeouts) {
+    timers.emplace_back(new Timer(service));
+    timers.back()->Arm(timeout, [&fired, timeout]() { fired.push_back(timeout); });
+  }
+  ASSERT_EQ(5u, ba::use_service<TimerWheel>(service).GetSize());
+
+  service.run();
+  ASSERT_EQ((std::vector<size_t>{1, 5, 15, 30, TimerWheel::kNumSlots + 5}), fired);
+  ASSERT_EQ(0u, ba::use_service<TimerWheel>(service).GetSize());
+}
+
+/**
+ * @test Tests an io_service run by several threads fires timers while a handler of an earlier tick still runs
+ */
+TEST(TimerWheel, ConcurrentTicks) {
+  ba::io_service service;
+  Timer first(service), second(service);
+  std::promise<void> second_fired;
+  std::future<void> second_done = second_fired.get_future();
+  std::future_status status = std::future_status::timeout;
+  first.Arm(1, [&]() {
+    second.Arm(5, [&second_fired]() { second_fired.set_value(); });
+    status = second_done.wait_for(sc::milliseconds(1000));
+  });
+
+  std::thread other([&service]() { service.run(); });
+  service.run();
+  other.join();
+  ASSERT_EQ(std::future_status::ready, status);
+}
+
+}  // namespace service
+}  // namespace protocol
+
+/// @endcond internal
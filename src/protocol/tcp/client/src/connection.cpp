@@ -3,13 +3,17 @@
  * @brief  Class definition of protocol::tcp::client::Connection
  */
 
-#include <iostream>
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
 #include <system_error>
+#include <vector>
 
 #include <boost/format.hpp>
 #include <boost/bind.hpp>
-#include <boost/asio/ip/tcp.hpp>
 
+#include <protocol/log/log.hpp>
 #include <protocol/service/singleton.hpp>
 #include <protocol/tcp/client/connection.hpp>
 
@@ -23,99 +27,220 @@ using std::system_error;
 using std::system_category;
 namespace ba = boost::asio;
 namespace bs = boost::system;
-using ba::ip::tcp;
 
-#define BIND(x) boost::bind(&Connection::x, shared_from_this())               ///< Helper bind to member method
-#define BIND2(x, y, z) boost::bind(&Connection::x, shared_from_this(), y, z)  ///< Helper bind to member method
+#define BIND(x) boost::bind(&Connection::x, shared_from_this())                     ///< Helper bind to member method
+#define BIND1(x, y) boost::bind(&Connection::x, shared_from_this(), y)              ///< Helper bind to member method
+#define BIND2(x, y, z) boost::bind(&Connection::x, shared_from_this(), y, z)        ///< Helper bind to member method
+#define BIND3(x, y, z, w) boost::bind(&Connection::x, shared_from_this(), y, z, w)  ///< Helper bind to member method
+
+namespace {
+
+/**
+ * Alternate the address families of resolved endpoints, starting with the family of the first one, so that staggered
+ * attempts don't all wait on a broken family
+ * @param endpoints Resolved endpoints, in resolver order
+ * @return Interleaved endpoints
+ */
+std::vector<socket::Endpoint> Interleave(const DnsCache::Endpoints& endpoints) {
+  std::vector<socket::Endpoint> preferred, other;
+  for (auto& endpoint : endpoints) {
+    (endpoint.address().is_v6() == endpoints.front().address().is_v6() ? preferred : other).push_back(endpoint);
+  }
+
+  std::vector<socket::Endpoint> interleaved;
+  interleaved.reserve(endpoints.size());
+  for (size_t i = 0; i < preferred.size() || i < other.size(); ++i) {
+    if (i < preferred.size()) interleaved.push_back(preferred[i]);
+    if (i < other.size()) interleaved.push_back(other[i]);
+  }
+  return interleaved;
+}
+
+/**
+ * Create the socket of a later attempt on the worker of the first one, so that the handlers of a connection never run
+ * concurrently
+ * @param service io_service of the first attempt
+ * @return A socket bound to the same worker
+ * @throws std::runtime_error while the pool is draining
+ */
+socket::sock::Ptr NewSocket(const ba::io_service& service) {
+  const size_t workers = service::singleton::GetTopology().size();
+  for (size_t i = 0; i < workers; ++i) {
+    if (&service::singleton::Instance(i) == &service) return service::singleton::NewSocket(i);
+  }
+  throw std::runtime_error("The io_service of the connection left the pool");
+}
+
+}  // namespace
 
 connection::Ptr Connection::Start(
-    std::string uri, const uint16_t port, const size_t timeout_ms, const Callback& on_done) {
-  connection::Ptr new_(new Connection(on_done));
+    std::string uri, const uint16_t port, const size_t timeout_ms, const Callback& on_done,
+    const socket::Options& options, const connection::Config& config) {
+  connection::Ptr new_(new Connection(on_done, options, config));
   new_->Start(std::move(uri), port, timeout_ms);
   return new_;
 }
 
-Connection::Connection(const Callback& on_done)
+connection::Ptr Connection::Start(
+    const socket::Endpoint& endpoint, const size_t timeout_ms, const Callback& on_done,
+    const socket::Options& options) {
+  return Start(std::vector<socket::Endpoint>{endpoint}, timeout_ms, on_done, options);
+}
+
+connection::Ptr Connection::Start(
+    const std::vector<socket::Endpoint>& endpoints, const size_t timeout_ms, const Callback& on_done,
+    const socket::Options& options, const connection::Config& config) {
+  if (endpoints.empty()) throw std::invalid_argument("Endpoints can't be empty");
+  connection::Ptr new_(new Connection(on_done, options, config));
+  new_->Start(endpoints, timeout_ms);
+  return new_;
+}
+
+Connection::Connection(const Callback& on_done, const socket::Options& options, const connection::Config& config)
   : stopped_(false),
-    deadline_(service::singleton::Instance()),
-    //sock_(new tcp::socket(deadline_.get_io_service())),
-    resolver_(deadline_.get_io_service()),
-    on_done_(on_done) {
-  sock_ = std::shared_ptr<boost::asio::ip::tcp::socket>(new boost::asio::ip::tcp::socket(deadline_.get_io_service()));
+    sock_(service::singleton::NewSocket()),
+    deadline_(sock_->get_io_service()),
+    attempt_delay_(sock_->get_io_service()),
+    on_done_(on_done),
+    options_(options),
+    config_(config),
+    endpoints_(),
+    next_(0),
+    attempts_() {
 }
 
 void Connection::Start(std::string uri, const uint16_t port, const size_t timeout_ms) {
   if (stopped_) return;
 
-  std::cout << "Connecting to " << uri << ":" << port << std::endl;
+  PROTOCOL_LOG_DEBUG("Connecting to " << uri << ":" << port);
+
+  if (timeout_ms) {
+    deadline_.Arm(timeout_ms, BIND(HandleDeadline));
+  }
+  DnsCache::Resolve(sock_->get_io_service(), uri, port, BIND2(HandleResolve, _1, _2));
+}
+
+void Connection::Start(const std::vector<socket::Endpoint>& endpoints, const size_t timeout_ms) {
+  if (stopped_) return;
+
+  PROTOCOL_LOG_DEBUG("Connecting to " << socket::ToString(endpoints.front())
+                     << (endpoints.size() > 1 ? " and the next endpoints" : ""));
 
   if (timeout_ms) {
-    deadline_.expires_from_now(boost::posix_time::milliseconds(timeout_ms));
-    deadline_.async_wait(BIND(HandleDeadline));
+    deadline_.Arm(timeout_ms, BIND(HandleDeadline));
   }
-  resolver_.async_resolve(tcp::resolver::query(uri, std::to_string(port)), BIND2(HandleResolve, _1, _2));
+  endpoints_ = endpoints;
+  Connect();
 }
 
 void Connection::Stop() {
   if (stopped_) return;
   stopped_ = true;
-  deadline_.cancel();
-  resolver_.cancel();
+  deadline_.Cancel();
+  attempt_delay_.Cancel();
+  // Cancel the attempts that lost, or all but the first one on a timeout
+  for (auto& sock : attempts_) {
+    bs::error_code ec;
+    if (sock != sock_) sock->close(ec);
+  }
+  attempts_.clear();
 }
 
 void Connection::HandleDeadline() {
   if (stopped_) return;
 
-  if (deadline_.expires_at() <= ba::deadline_timer::traits_type::now()) {
-    Stop();
-    on_done_(make_exception_ptr(system_error(ETIMEDOUT, system_category(), "Operation timed out")),
-             sock_);
-  }
-
-  // Put the actor back to sleep.
-  deadline_.async_wait(boost::bind(&Connection::HandleDeadline, this));
+  Stop();
+  on_done_(make_exception_ptr(system_error(ETIMEDOUT, system_category(), "Operation timed out")), sock_);
 }
 
 Connection::~Connection() {
   Stop();
 }
 
-void Connection::HandleConnect(const bs::error_code& error, ba::ip::tcp::resolver::iterator endpoint_iterator) {
+void Connection::HandleAttemptDelay() {
   if (stopped_) return;
 
-  if (error && (endpoint_iterator == tcp::resolver::iterator())) {
-      Stop();
-      on_done_(make_exception_ptr(std::system_error(error.value(), system_category(),
-                                                    (format("Couldn't connect: %1%") % error.message()).str())), sock_);
-    return;
-    };
+  Connect();
+}
+
+void Connection::HandleConnect(const bs::error_code& error, const socket::sock::Ptr& sock, size_t index) {
+  if (stopped_) return;
 
-  auto host = sock_->remote_endpoint().address().to_string();
-  auto port = sock_->remote_endpoint().port();
   if (!error) {
+    sock_ = sock;
     Stop();
-    std::cout << "Successfully connected to " << host << ":" << port << std::endl;
+    PROTOCOL_LOG_DEBUG("Successfully connected to " << socket::ToString(endpoints_[index]));
     on_done_(nullptr, sock_);
-  } else if (endpoint_iterator != tcp::resolver::iterator()) {
-    sock_->close();
-    tcp::endpoint endpoint = *endpoint_iterator;
-    std::cout << "Couldn't connect to " << host << ":" << port << ", error: " << error.message() << ". Trying next endpoint" <<  std::endl;
-    sock_->async_connect(endpoint, BIND2(HandleConnect, _1, ++endpoint_iterator));
+    return;
+  }
+
+  bs::error_code ec;
+  sock->close(ec);
+  attempts_.erase(std::find(attempts_.begin(), attempts_.end(), sock));
+  HandleAttemptError(error, index, "Couldn't connect");
+}
+
+void Connection::HandleAttemptError(const bs::error_code& error, size_t index, const char* message) {
+  if (next_ < endpoints_.size()) {
+    PROTOCOL_LOG_INFO(message << " to " << socket::ToString(endpoints_[index]) << ", error: " << error.message()
+                      << ". Trying next endpoint");
+    // A failed attempt doesn't wait for the delay
+    attempt_delay_.Cancel();
+    Connect();
+  } else if (attempts_.empty()) {
+    Fail(error, message);
+  } else {
+    PROTOCOL_LOG_INFO(message << " to " << socket::ToString(endpoints_[index]) << ", error: " << error.message()
+                      << ". Waiting for " << attempts_.size() << " more attempts");
   }
 }
 
-void Connection::HandleResolve(const bs::error_code& error, ba::ip::tcp::resolver::iterator endpoint_iterator) {
+void Connection::HandleResolve(const bs::error_code& error, const DnsCache::Endpoints& endpoints) {
   if (stopped_) return;
   if (error) {
-    on_done_(
-        make_exception_ptr(
-            std::system_error(error.value(), system_category(),
-                              (format("Couldn't resolve address: %1%") % error.message()).str())), sock_);
-    Stop();
+    Fail(error, "Couldn't resolve address");
+    return;
   }
 
-  tcp::endpoint endpoint = *endpoint_iterator;
-  sock_->async_connect(endpoint, BIND2(HandleConnect, _1, ++endpoint_iterator));
+  if (config_.attempt_delay_ms) {
+    endpoints_ = Interleave(endpoints);
+  } else {
+    endpoints_.assign(endpoints.begin(), endpoints.end());
+  }
+  Connect();
+}
+
+void Connection::Connect() {
+  const size_t index = next_++;
+  const socket::Endpoint& endpoint = endpoints_[index];
+  socket::sock::Ptr sock;
+  try {
+    sock = index ? NewSocket(sock_->get_io_service()) : sock_;
+  } catch (const std::runtime_error& e) {
+    PROTOCOL_LOG_ERROR("Couldn't create a socket: " << e.what());
+    HandleAttemptError(ba::error::operation_aborted, index, "Couldn't create a socket");
+    return;
+  }
+  bs::error_code ec;
+  // Buffer sizes must be set before the handshake for the window scale to account for them
+  sock->open(endpoint.protocol(), ec);
+  if (ec || (ec = socket::Apply(options_, *sock))) {
+    bs::error_code ignored;
+    sock->close(ignored);
+    HandleAttemptError(ec, index, "Couldn't apply socket options");
+    return;
+  }
+  attempts_.push_back(sock);
+  sock->async_connect(endpoint, BIND3(HandleConnect, _1, sock, index));
+  if (config_.attempt_delay_ms && next_ < endpoints_.size()) {
+    attempt_delay_.Arm(config_.attempt_delay_ms, BIND(HandleAttemptDelay));
+  }
+}
+
+void Connection::Fail(const bs::error_code& error, const char* message) {
+  Stop();
+  on_done_(make_exception_ptr(std::system_error(error.value(), system_category(),
+                                                (format("%1%: %2%") % message % error.message()).str())), sock_);
 }
 
 }  // namespace client
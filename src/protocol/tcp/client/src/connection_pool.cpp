@@ -0,0 +1,229 @@
+/**
+ * @file   protocol/tcp/client/src/connection_pool.cpp
+ * @brief  Class definition of protocol::tcp::client::ConnectionPool
+ */
+
+#include <sys/socket.h>
+#include <sys/types.h>
+
+#include <cerrno>
+#include <system_error>
+#include <utility>
+
+#include <boost/asio/error.hpp>
+#include <boost/bind.hpp>
+
+#include <protocol/service/singleton.hpp>
+#include <protocol/tcp/client/connection.hpp>
+#include <protocol/tcp/client/connection_pool.hpp>
+#include <protocol/tcp/client/lease.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace client {
+
+namespace ba = boost::asio;
+namespace bs = boost::system;
+
+namespace {
+
+/**
+ * Check without blocking that an idle socket can carry a new exchange
+ * @param sock Idle socket
+ * @return False if the peer closed the connection, or if a previous exchange left unread data
+ */
+bool IsHealthy(socket::sock::Socket& sock) {
+  if (!sock.is_open()) return false;
+  char byte;
+  const ssize_t received = ::recv(sock.native_handle(), &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+  return received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+}
+
+}  // namespace
+
+connection_pool::Ptr ConnectionPool::Create(const connection_pool::Config& config) {
+  return connection_pool::Ptr(new ConnectionPool(config));
+}
+
+ConnectionPool::ConnectionPool(const connection_pool::Config& config)
+    : config_(config),
+      mutex_(),
+      hosts_(),
+      sweep_(service::singleton::Instance()),
+      sweeping_(false),
+      stats_() {
+}
+
+ConnectionPool::~ConnectionPool() {
+  bs::error_code ec;
+  sweep_.cancel(ec);
+  // The pool of io_services may be draining, the waiters fail on the io_service they hold
+  for (auto& entry : hosts_) {
+    for (auto& waiter : entry.second.waiting) {
+      waiter.work.get_io_service().post(boost::bind(waiter.on_done, std::make_exception_ptr(std::system_error(
+          ba::error::operation_aborted, std::system_category(), "Pool destroyed")), lease::Ptr()));
+    }
+  }
+}
+
+void ConnectionPool::Acquire(const std::string& host, uint16_t port, const Callback& on_done) {
+  const std::string key = host + ":" + std::to_string(port);
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto it = hosts_.find(key);
+  if (it == hosts_.end()) {
+    it = hosts_.emplace(key, Host{host, port, std::deque<Idle>(), 0, std::deque<Waiter>()}).first;
+  }
+  Host& entry = it->second;
+
+  // The most recently released socket is the least likely to have been closed by the peer
+  const Clock::time_point expiry = Clock::now() - std::chrono::milliseconds(config_.idle_timeout_ms);
+  while (!entry.idle.empty()) {
+    Idle idle = std::move(entry.idle.back());
+    entry.idle.pop_back();
+    if (config_.idle_timeout_ms && idle.since <= expiry) {
+      --entry.open;
+      ++stats_.evicted;
+      continue;
+    }
+    if (config_.health_check && !IsHealthy(*idle.sock)) {
+      --entry.open;
+      ++stats_.failed_checks;
+      continue;
+    }
+    ++stats_.hits;
+    lease::Ptr lease(new Lease(shared_from_this(), key, idle.sock, true));
+    idle.sock->get_io_service().post(boost::bind(on_done, std::exception_ptr(), lease));
+    return;
+  }
+
+  // Sockets only idle while no request waits, so waiting requests are always served in order
+  if (config_.max_per_host && entry.open >= config_.max_per_host) {
+    entry.waiting.push_back(Waiter{ba::io_service::work(service::singleton::Instance()), on_done});
+    ++stats_.waited;
+    return;
+  }
+  ++entry.open;
+  ++stats_.connects;
+  lock.unlock();
+  Connect(key, host, port, on_done);
+}
+
+void ConnectionPool::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto it = hosts_.begin(); it != hosts_.end();) {
+    it->second.open -= it->second.idle.size();
+    it->second.idle.clear();
+    if (!it->second.open && it->second.waiting.empty()) {
+      it = hosts_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+connection_pool::Stats ConnectionPool::GetStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  connection_pool::Stats stats = stats_;
+  stats.idle = 0;
+  for (auto& entry : hosts_) stats.idle += entry.second.idle.size();
+  return stats;
+}
+
+void ConnectionPool::Connect(const std::string& key, const std::string& host, uint16_t port,
+                             const Callback& on_done) {
+  connection_pool::WeakPtr pool(shared_from_this());
+  Connection::Start(host, port, config_.connect_timeout_ms, [pool, key, on_done](std::exception_ptr eptr,
+                                                                                 socket::sock::Ptr sock) {
+    if (eptr) {
+      connection_pool::Ptr self = pool.lock();
+      if (self) {
+        std::unique_lock<std::mutex> lock(self->mutex_);
+        self->Close(lock, key);
+      }
+      on_done(eptr, lease::Ptr());
+      return;
+    }
+    on_done(nullptr, lease::Ptr(new Lease(pool, key, sock, false)));
+  }, config_.options);
+}
+
+void ConnectionPool::Return(const std::string& key, const socket::sock::Ptr& sock, bool reusable) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  Host& entry = hosts_.at(key);
+  if (reusable && sock->is_open()) {
+    if (!entry.waiting.empty()) {
+      Callback waiter = std::move(entry.waiting.front().on_done);
+      entry.waiting.pop_front();
+      ++stats_.hits;
+      lease::Ptr lease(new Lease(shared_from_this(), key, sock, true));
+      lock.unlock();
+      sock->get_io_service().post(boost::bind(waiter, std::exception_ptr(), lease));
+      return;
+    }
+    if (entry.idle.size() < config_.max_idle_per_host) {
+      entry.idle.push_back(Idle{sock, Clock::now()});
+      ArmSweep();
+      return;
+    }
+  }
+
+  bs::error_code ec;
+  sock->close(ec);
+  Close(lock, key);
+}
+
+void ConnectionPool::Close(std::unique_lock<std::mutex>& lock, const std::string& key) {
+  auto it = hosts_.find(key);
+  Host& entry = it->second;
+  --entry.open;
+  if (entry.waiting.empty()) {
+    if (!entry.open) hosts_.erase(it);
+    return;
+  }
+
+  Callback waiter = std::move(entry.waiting.front().on_done);
+  entry.waiting.pop_front();
+  ++entry.open;
+  ++stats_.connects;
+  const std::string host = entry.host;
+  const uint16_t port = entry.port;
+  lock.unlock();
+  Connect(key, host, port, waiter);
+}
+
+void ConnectionPool::ArmSweep() {
+  if (sweeping_ || !config_.idle_timeout_ms) return;
+  sweeping_ = true;
+  sweep_.expires_from_now(std::chrono::milliseconds(config_.idle_timeout_ms));
+  sweep_.async_wait(boost::bind(&ConnectionPool::OnSweep, connection_pool::WeakPtr(shared_from_this()), _1));
+}
+
+void ConnectionPool::OnSweep(const connection_pool::WeakPtr& pool, const bs::error_code& ec) {
+  if (ec) return;
+  connection_pool::Ptr self = pool.lock();
+  if (!self) return;
+
+  std::lock_guard<std::mutex> lock(self->mutex_);
+  self->sweeping_ = false;
+  const Clock::time_point expiry = Clock::now() - std::chrono::milliseconds(self->config_.idle_timeout_ms);
+  bool idle = false;
+  for (auto it = self->hosts_.begin(); it != self->hosts_.end();) {
+    Host& entry = it->second;
+    while (!entry.idle.empty() && entry.idle.front().since <= expiry) {
+      entry.idle.pop_front();
+      --entry.open;
+      ++self->stats_.evicted;
+    }
+    idle = idle || !entry.idle.empty();
+    if (!entry.open && entry.waiting.empty()) {
+      it = self->hosts_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  if (idle) self->ArmSweep();
+}
+
+}  // namespace client
+}  // namespace tcp
+}  // namespace protocol
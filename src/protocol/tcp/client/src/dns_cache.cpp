@@ -0,0 +1,294 @@
+/**
+ * @file   protocol/tcp/client/src/dns_cache.cpp
+ * @brief  Class definition of protocol::tcp::client::DnsCache
+ */
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include <boost/bind.hpp>
+
+#include <protocol/service/singleton.hpp>
+#include <protocol/tcp/client/dns_cache.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace client {
+
+namespace ba = boost::asio;
+namespace bs = boost::system;
+using ba::ip::tcp;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;  ///< Clock of the TTLs
+
+/**
+ * A request waiting for a lookup
+ */
+struct Waiter {
+  ba::io_service::work work;   ///< Keeps the io_service the callback is posted to awake, the lookup may run elsewhere
+  uint16_t port;               ///< Port of the endpoints
+  DnsCache::Callback on_done;  ///< Callback
+};
+
+/**
+ * A cached name
+ */
+struct Entry {
+  /**
+   * Default ctor, a name that was never resolved
+   */
+  Entry() : addresses(), error(), expiry(), resolved(false), pending(false), waiting() {}
+
+  std::vector<ba::ip::address> addresses;  ///< Resolved addresses
+  bs::error_code error;                    ///< Error of the last lookup
+  Clock::time_point expiry;                ///< Time the result stops being served
+  bool resolved;                           ///< Whether addresses and error hold a result
+  bool pending;                            ///< Whether a lookup is in flight
+  std::vector<Waiter> waiting;             ///< Requests waiting for the lookup in flight
+};
+
+std::mutex mutex;                                ///< Protects the variables below
+std::unordered_map<std::string, Entry> entries;  ///< Cached names
+dns_cache::Config config;                        ///< Cache configuration
+dns_cache::Stats stats = {};                     ///< Counters, entries excepted
+
+/**
+ * Post a result to a request
+ * @param service   io_service of the request
+ * @param ec        Lookup error
+ * @param endpoints Resolved endpoints
+ * @param on_done   Callback of the request
+ */
+void Deliver(ba::io_service& service, const bs::error_code& ec, const DnsCache::Endpoints& endpoints,
+             const DnsCache::Callback& on_done) {
+  service.post(boost::bind(on_done, ec, endpoints));
+}
+
+/**
+ * A lookup in flight. If its io_service is destroyed first, the lookup is abandoned so that the next request for the
+ * name starts a new one
+ */
+struct Query {
+  /**
+   * Ctor
+   * @param service io_service running the lookup
+   * @param host    Name to look up
+   */
+  Query(ba::io_service& service, const std::string& host) : resolver(service), host(host), done(false) {}
+
+  /**
+   * Dtor, abandons the lookup unless it completed
+   */
+  ~Query() {
+    if (done) return;
+    std::vector<Waiter> waiting;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto it = entries.find(host);
+      if (it == entries.end()) return;
+      it->second.pending = false;
+      waiting.swap(it->second.waiting);
+      if (!it->second.resolved) entries.erase(it);
+    }
+    // Requests bound to the destroyed io_service can't be called back anymore, the others are told of the abort
+    ba::io_service& destroyed = resolver.get_io_service();
+    for (auto& waiter : waiting) {
+      ba::io_service& service = waiter.work.get_io_service();
+      if (&service != &destroyed) Deliver(service, ba::error::operation_aborted, DnsCache::Endpoints(), waiter.on_done);
+    }
+  }
+
+  tcp::resolver resolver;  ///< Resolver running the lookup
+  std::string host;        ///< Name looked up
+  bool done;               ///< Whether the lookup completed
+};
+
+/**
+ * Pair addresses with a port
+ * @param addresses Addresses
+ * @param port      Port
+ * @return Endpoints
+ */
+DnsCache::Endpoints MakeEndpoints(const std::vector<ba::ip::address>& addresses, uint16_t port) {
+  DnsCache::Endpoints endpoints;
+  endpoints.reserve(addresses.size());
+  for (auto& address : addresses) endpoints.push_back(tcp::endpoint(address, port));
+  return endpoints;
+}
+
+/**
+ * Drop expired names when the cache is full, mutex must be held
+ * @param now Current time
+ */
+void Trim(Clock::time_point now) {
+  if (entries.size() < config.max_entries) return;
+  for (auto it = entries.begin(); it != entries.end();) {
+    if (!it->second.pending && it->second.expiry <= now) {
+      it = entries.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  for (auto it = entries.begin(); it != entries.end() && entries.size() >= config.max_entries;) {
+    if (!it->second.pending) {
+      it = entries.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+/**
+ * Store the result of a lookup and hand it to the waiting requests
+ * @param query    Lookup
+ * @param ec       Error
+ * @param iterator Resolved endpoints
+ */
+void OnResolved(const std::shared_ptr<Query>& query, bs::error_code ec, tcp::resolver::iterator iterator) {
+  query->done = true;
+  const std::string& host = query->host;
+  std::vector<ba::ip::address> addresses;
+  for (; !ec && iterator != tcp::resolver::iterator(); ++iterator) addresses.push_back(iterator->endpoint().address());
+  if (!ec && addresses.empty()) ec = ba::error::host_not_found;
+
+  std::vector<Waiter> waiting;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    const Clock::time_point now = Clock::now();
+    Entry& entry = entries[host];
+    entry.pending = false;
+    waiting.swap(entry.waiting);
+    if (ec && entry.resolved && !entry.error && entry.expiry > now) {
+      // A failed refresh keeps serving the result it was refreshing until it expires
+      addresses = entry.addresses;
+      ec = bs::error_code();
+    } else {
+      const size_t ttl_ms = ec ? config.negative_ttl_ms : config.ttl_ms;
+      entry.addresses = addresses;
+      entry.error = ec;
+      entry.expiry = now + std::chrono::milliseconds(ttl_ms);
+      entry.resolved = true;
+      if (!ttl_ms) entries.erase(host);
+    }
+  }
+
+  for (auto& waiter : waiting) {
+    Deliver(waiter.work.get_io_service(), ec, MakeEndpoints(addresses, waiter.port), waiter.on_done);
+  }
+}
+
+/**
+ * Start looking up a name, the entry must be marked pending and mutex must not be held: if starting fails, the
+ * destroyed Query locks it to abandon the lookup
+ * @param service io_service running the lookup
+ * @param host    Name to look up
+ */
+void Lookup(ba::io_service& service, const std::string& host) {
+  std::shared_ptr<Query> query = std::make_shared<Query>(service, host);
+  query->resolver.async_resolve(tcp::resolver::query(host, "0"), boost::bind(&OnResolved, query, _1, _2));
+}
+
+}  // namespace
+
+void DnsCache::Resolve(ba::io_service& service, const std::string& host, uint16_t port, const Callback& on_done) {
+  bs::error_code ec;
+  const ba::ip::address address = ba::ip::address::from_string(host, ec);
+  if (!ec) {
+    Deliver(service, ec, Endpoints{tcp::endpoint(address, port)}, on_done);
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(mutex);
+  const Clock::time_point now = Clock::now();
+  auto it = entries.find(host);
+  if (it != entries.end() && it->second.resolved && it->second.expiry > now) {
+    Entry& entry = it->second;
+    ++(entry.error ? stats.negative_hits : stats.hits);
+    bool refresh = false;
+    if (!entry.error && !entry.pending && config.refresh_ahead_ms &&
+        entry.expiry - now <= std::chrono::milliseconds(config.refresh_ahead_ms)) {
+      ++stats.refreshes;
+      entry.pending = true;
+      refresh = true;
+    }
+    Deliver(service, entry.error, MakeEndpoints(entry.addresses, port), on_done);
+    lock.unlock();
+    if (refresh) Lookup(service, host);
+    return;
+  }
+
+  if (it == entries.end()) {
+    Trim(now);
+    it = entries.emplace(host, Entry()).first;
+  }
+  Entry& entry = it->second;
+  entry.waiting.push_back(Waiter{ba::io_service::work(service), port, on_done});
+  if (entry.pending) {
+    ++stats.coalesced;
+    return;
+  }
+  ++stats.misses;
+  entry.pending = true;
+  lock.unlock();
+  Lookup(service, host);
+}
+
+void DnsCache::Prewarm(const std::vector<std::string>& hosts) {
+  ba::io_service& pool = service::singleton::Instance();
+  std::vector<std::string> lookups;
+  std::unique_lock<std::mutex> lock(mutex);
+  const Clock::time_point now = Clock::now();
+  for (auto& host : hosts) {
+    bs::error_code ec;
+    ba::ip::address::from_string(host, ec);
+    if (!ec) continue;
+    auto it = entries.find(host);
+    if (it != entries.end() && (it->second.pending || (it->second.resolved && it->second.expiry > now))) continue;
+    if (it == entries.end()) {
+      Trim(now);
+      it = entries.emplace(host, Entry()).first;
+    }
+    ++stats.refreshes;
+    it->second.pending = true;
+    lookups.push_back(host);
+  }
+  lock.unlock();
+  for (auto& host : lookups) Lookup(pool, host);
+}
+
+void DnsCache::Configure(const dns_cache::Config& new_config) {
+  std::lock_guard<std::mutex> lock(mutex);
+  config = new_config;
+}
+
+dns_cache::Config DnsCache::GetConfig() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return config;
+}
+
+void DnsCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex);
+  for (auto it = entries.begin(); it != entries.end();) {
+    if (!it->second.pending) {
+      it = entries.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+dns_cache::Stats DnsCache::GetStats() {
+  std::lock_guard<std::mutex> lock(mutex);
+  dns_cache::Stats result = stats;
+  result.entries = entries.size();
+  return result;
+}
+
+}  // namespace client
+}  // namespace tcp
+}  // namespace protocol
@@ -7,6 +7,8 @@
 #include <algorithm>
 #include <utility>
 
+#include <boost/algorithm/string/predicate.hpp>
+
 #include <protocol/tcp/client/http.hpp>
 
 namespace protocol {
@@ -19,9 +21,8 @@ using std::runtime_error;
 using std::string;
 
 std::string& GetHeaderField(Headers& headers, const std::string& name) {
-  std::string key_ = name + ":";
-  auto it = std::find_if(headers.begin(), headers.end(), [&key_](const pair<string, string>& element) {
-    return element.first == key_;
+  auto it = std::find_if(headers.begin(), headers.end(), [&name](const pair<string, string>& element) {
+    return boost::algorithm::iequals(element.first, name);
   });
   if (headers.end() != it) {
     return it->second;
@@ -6,7 +6,6 @@
 #include <algorithm>
 #include <cstdio>
 #include <future>
-#include <iostream>
 #include <ostream>
 #include <sstream>
 #include <string>
@@ -17,15 +16,16 @@
 
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/trim.hpp>
-#include <boost/asio/read.hpp>
-#include <boost/asio/read_until.hpp>
 #include <boost/asio/write.hpp>
 #include <boost/bind.hpp>
 #include <boost/lexical_cast.hpp>
 
+#include <protocol/log/log.hpp>
 #include <protocol/service/singleton.hpp>
 #include <protocol/tcp/client/http_get.hpp>
 #include <protocol/tcp/socket/buffer.hpp>
+#include <protocol/tcp/socket/buffer_pool.hpp>
+#include <protocol/tcp/socket/endpoint.hpp>
 
 #include <boost/asio/coroutine.hpp>  // Attention on the order including these two
 #include <boost/asio/yield.hpp>      // changing it may result in compilation errors
@@ -55,6 +55,8 @@ using ichar_iter = std::istream_iterator<istringstream::char_type>;
 #define BIND(x) boost::bind(&HTTPGet::x, shared_from_this())               ///< Helper bind to member method
 #define BIND2(x, y, z) boost::bind(&HTTPGet::x, shared_from_this(), y, z)  ///< Helper bind to member method
 
+static const size_t kReadSize = 16384;  ///< Number of bytes requested per read
+
 http_get::Ptr HTTPGet::Create(protocol::tcp::socket::sock::Ptr sock, std::string path, const Callback& on_done) {
   http_get::Ptr new_(new HTTPGet(sock, std::move(path), on_done));
   return new_;
@@ -63,15 +65,31 @@ http_get::Ptr HTTPGet::Create(protocol::tcp::socket::sock::Ptr sock, std::string
 HTTPGet::HTTPGet(protocol::tcp::socket::sock::Ptr sock, std::string path, const Callback& on_done)
     : stopped_(true),
       sock_(sock),
-      buffer_(protocol::tcp::socket::Buffer::Create("")),
+      buffer_(protocol::tcp::socket::BufferPool::Acquire()),
       on_done_callback_(on_done),
+      on_body_callback_(),
       path_(std::move(path)),
       request_headers_(),
       status_code_(-1),
       headers_(),
-      body_() {
+      trailers_(),
+      body_(),
+      parser_([this](int status, boost::string_ref) { status_code_ = status; },
+              [this](boost::string_ref name, boost::string_ref value) {
+                headers_.emplace_back(name.to_string(), value.to_string());
+              },
+              [this](boost::string_ref data) {
+                if (on_body_callback_) {
+                  on_body_callback_(data, shared_from_this());
+                } else {
+                  body_.append(data.data(), data.size());
+                }
+              },
+              [this](boost::string_ref name, boost::string_ref value) {
+                trailers_.emplace_back(name.to_string(), value.to_string());
+              }) {
   if (!sock_) throw std::invalid_argument("Socket can't be null");
-  deadline_ = std::shared_ptr<ba::deadline_timer>(new ba::deadline_timer(sock_->get_io_service()));
+  deadline_.reset(new service::Timer(sock_->get_io_service()));
 }
 
 void HTTPGet::Start(const size_t timeout_ms) {
@@ -81,8 +99,7 @@ void HTTPGet::Start(const size_t timeout_ms) {
   buffer_->Reset();
 
   if (timeout_ms) {
-    deadline_->expires_from_now(boost::posix_time::milliseconds(timeout_ms));
-    deadline_->async_wait(BIND(OnTimeout));
+    deadline_->Arm(timeout_ms, BIND(OnTimeout));
   }
 
   operator()(bs::error_code(), 0);
@@ -91,17 +108,18 @@ void HTTPGet::Start(const size_t timeout_ms) {
 void HTTPGet::Stop() {
   if (!stopped_) stopped_ = true;
 
-  deadline_->cancel();
+  deadline_->Cancel();
 }
 
 const protocol::tcp::socket::sock::Ptr HTTPGet::GetSock() const {
   return sock_;
 }
 
-void HTTPGet::operator()(bs::error_code error = bs::error_code(), std::size_t = 0) {
+void HTTPGet::operator()(bs::error_code error = bs::error_code(), std::size_t bytes = 0) {
   if (stopped_) return;
 
-  if (error) {
+  // The end of the stream may end the body, the parser tells
+  if (error && error != ba::error::eof) {
     Stop();
     on_done_callback_(make_exception_ptr(std::system_error(error.value(), system_category(), error.message())),
                       shared_from_this());
@@ -114,7 +132,7 @@ void HTTPGet::operator()(bs::error_code error = bs::error_code(), std::size_t =
         // Send the request
         buffer_->Reset();
         *buffer_ << "GET " << path_ << " HTTP/1.1\r\n"
-             << "Host: " << sock_->remote_endpoint().address().to_string() << "\r\n"
+             << "Host: " << socket::GetHost(sock_->remote_endpoint()) << "\r\n"
              << "Connection: Keep-Alive\r\n";
 
         for (auto &header : request_headers_) {
@@ -125,55 +143,25 @@ void HTTPGet::operator()(bs::error_code error = bs::error_code(), std::size_t =
 
         ba::async_write(*sock_, **buffer_, BIND2(operator(), _1, _2));
       }
-      yield {
-        buffer_->Reset();
-        ba::async_read_until(*sock_, **buffer_, "\r\n\r\n", BIND2(operator(), _1, _2));
-      }
-      yield {
-        std::string key, value;
-        *buffer_ >> key;
-        *buffer_ >> status_code_;
-        std::cout << "HTTP Get response status<" << status_code_ << ">" << std::endl;
-
-        // Get header fields
-        while (true) {
-          key.clear();
-          value.clear();
-          *buffer_ >> key;
-          getline(buffer_->GetIStream(), value);
-          std::cout << "Found header field <" << key << ", " << value << ">" << std::endl;
-          if (key.empty() || value.empty()) {
-            break;
-          }
-          headers_.push_back({key, value});
-          if (*boost::asio::buffers_begin((**buffer_).data()) == '\r') {
-            (**buffer_).consume(2);
-            break;
-          }
-        }
 
-        body_ = buffer_->ToString();
-        buffer_->Reset();
+      // Parse the response as it arrives
+      buffer_->Reset();
+      parser_.Reset();
+      status_code_ = -1;
+      headers_.clear();
+      trailers_.clear();
+      body_.clear();
+      do {
+        yield sock_->async_read_some((**buffer_).prepare(kReadSize), BIND2(operator(), _1, _2));
+        (**buffer_).commit(bytes);
+        if (!ParseResponse(error == ba::error::eof)) return;
+      } while (!parser_.IsComplete());
 
-        int content_length = 0;
-        try {
-          content_length = stoi(GetHeaderField(headers_, "Content-Length"));
-        } catch (const std::exception &e) {
-          std::cout << "Failed to get content length" << std::endl;
-        }
-
-        if (static_cast<int>(body_.size()) > content_length) {
-          std::cout << "Got invalid content length" << std::endl;
-          content_length = body_.size();
-        }
-
-        size_t to_read = content_length - body_.size();
-        ba::async_read(*sock_, **buffer_, ba::transfer_exactly(to_read), BIND2(operator(), _1, _2));
-      }
       yield {
         Stop();
-        body_ = body_ +  buffer_->ToString();
-        std::cout << "Got http content, body: " << body_ << std::endl;
+        PROTOCOL_LOG_DEBUG("HTTP Get response status<" << status_code_ << ">, " << headers_.size() << " headers, "
+                           << body_.size() << " bytes of body");
+        PROTOCOL_LOG_TRACE("Got http content, body: " << body_);
         buffer_->Reset();
         on_done_callback_(nullptr, shared_from_this());
       }
@@ -181,14 +169,25 @@ void HTTPGet::operator()(bs::error_code error = bs::error_code(), std::size_t =
   }
 }
 
+bool HTTPGet::ParseResponse(bool eof) {
+  try {
+    const auto data = (**buffer_).data();
+    (**buffer_).consume(parser_.Parse(ba::buffer_cast<const char*>(data), ba::buffer_size(data)));
+    if (eof) parser_.Finish();
+  } catch (const std::exception&) {
+    Stop();
+    on_done_callback_(std::current_exception(), shared_from_this());
+    return false;
+  }
+  return true;
+}
+
 void HTTPGet::OnTimeout() {
   if (stopped_) return;
 
-  if (deadline_->expires_at() <= ba::deadline_timer::traits_type::now()) {
-    Stop();
-    on_done_callback_(make_exception_ptr(system_error(ETIMEDOUT, system_category(), "Operation timed out")),
-                      shared_from_this());
-  }
+  Stop();
+  on_done_callback_(make_exception_ptr(system_error(ETIMEDOUT, system_category(), "Operation timed out")),
+                    shared_from_this());
 }
 
 int HTTPGet::GetStatus() const {
@@ -203,6 +202,18 @@ const Headers& HTTPGet::GetHeaders() const {
   return headers_;
 }
 
+const Headers& HTTPGet::GetTrailers() const {
+  return trailers_;
+}
+
+bool HTTPGet::IsPersistent() const {
+  return parser_.IsComplete() && parser_.IsPersistent();
+}
+
+void HTTPGet::SetOnBodyCallback(const BodyCallback& callback) {
+  on_body_callback_ = callback;
+}
+
 void HTTPGet::SetRequestHeaders(const Headers& requestHeaders) {
   request_headers_ = requestHeaders;
 }
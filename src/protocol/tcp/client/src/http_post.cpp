@@ -5,7 +5,6 @@
 
 #include <cstdio>
 #include <future>
-#include <iostream>
 #include <ostream>
 #include <sstream>
 #include <stdexcept>
@@ -15,14 +14,15 @@
 
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/trim.hpp>
-#include <boost/asio/read.hpp>
-#include <boost/asio/read_until.hpp>
 #include <boost/asio/write.hpp>
 #include <boost/bind.hpp>
 
+#include <protocol/log/log.hpp>
 #include <protocol/service/singleton.hpp>
 #include <protocol/tcp/client/http_post.hpp>
 #include <protocol/tcp/socket/buffer.hpp>
+#include <protocol/tcp/socket/buffer_pool.hpp>
+#include <protocol/tcp/socket/endpoint.hpp>
 
 #include <boost/asio/coroutine.hpp>  // Attention on the order including these two
 #include <boost/asio/yield.hpp>      // changing it may result in compilation errors
@@ -48,6 +48,7 @@ using std::vector;
 using boost::system::error_code;
 
 using ::protocol::tcp::socket::Buffer;
+using ::protocol::tcp::socket::BufferPool;
 
 /// A type of input stream character iterator
 using ichar_iter = std::istream_iterator<istringstream::char_type>;
@@ -55,6 +56,8 @@ using ichar_iter = std::istream_iterator<istringstream::char_type>;
 #define BIND(x) boost::bind(&HTTPPost::x, shared_from_this())               ///< Helper bind to member method
 #define BIND2(x, y, z) boost::bind(&HTTPPost::x, shared_from_this(), y, z)  ///< Helper bind to member method
 
+static const size_t kReadSize = 16384;  ///< Number of bytes requested per read
+
 http_post::Ptr HTTPPost::Create(protocol::tcp::socket::sock::Ptr sock, std::string path, const Callback& on_done,
                                 Headers headers = Headers(), std::string body = "") {
   http_post::Ptr new_(new HTTPPost(sock, std::move(path), on_done, std::move(headers), std::move(body)));
@@ -65,16 +68,32 @@ HTTPPost::HTTPPost(protocol::tcp::socket::sock::Ptr sock, std::string path, cons
                    std::string body)
     : stopped_(true),
       sock_(sock),
-      buffer_(Buffer::Create("")),
+      buffer_(BufferPool::Acquire()),
       on_done_callback_(on_done),
+      on_body_callback_(),
       path_(std::move(path)),
       request_headers_(headers),
       request_content_(body),
       response_status_code_(-1),
       response_headers_(),
-      response_content_() {
+      response_trailers_(),
+      response_content_(),
+      parser_([this](int status, boost::string_ref) { response_status_code_ = status; },
+              [this](boost::string_ref name, boost::string_ref value) {
+                response_headers_.emplace_back(name.to_string(), value.to_string());
+              },
+              [this](boost::string_ref data) {
+                if (on_body_callback_) {
+                  on_body_callback_(data, shared_from_this());
+                } else {
+                  response_content_.append(data.data(), data.size());
+                }
+              },
+              [this](boost::string_ref name, boost::string_ref value) {
+                response_trailers_.emplace_back(name.to_string(), value.to_string());
+              }) {
   if (!sock_) throw std::invalid_argument("Socket can't be null");
-  deadline_ = std::shared_ptr<ba::deadline_timer>(new ba::deadline_timer(sock_->get_io_service()));
+  deadline_.reset(new service::Timer(sock_->get_io_service()));
 }
 
 void HTTPPost::Start(const size_t timeout_ms) {
@@ -83,11 +102,11 @@ void HTTPPost::Start(const size_t timeout_ms) {
   stopped_ = false;
   response_status_code_ = -1;
   response_headers_.clear();
+  response_trailers_.clear();
   response_content_.clear();
 
   if (timeout_ms) {
-    deadline_->expires_from_now(boost::posix_time::milliseconds(timeout_ms));
-    deadline_->async_wait(BIND(OnTimeout));
+    deadline_->Arm(timeout_ms, BIND(OnTimeout));
   }
 
   operator()(bs::error_code(), 0);
@@ -96,7 +115,7 @@ void HTTPPost::Start(const size_t timeout_ms) {
 void HTTPPost::Stop() {
   if (!stopped_) stopped_ = true;
 
-  deadline_->cancel();
+  deadline_->Cancel();
 }
 
 const protocol::tcp::socket::sock::Ptr HTTPPost::GetSock() const {
@@ -107,10 +126,10 @@ protocol::tcp::socket::buffer::Ptr HTTPPost::GetBuffer() {
   return buffer_;
 }
 
-void HTTPPost::operator()(bs::error_code error = bs::error_code(), std::size_t = 0) {
+void HTTPPost::operator()(bs::error_code error = bs::error_code(), std::size_t bytes = 0) {
   if (stopped_) return;
 
-  if (error) {
+  if (error && error != ba::error::eof) {
     Stop();
     on_done_callback_(make_exception_ptr(std::system_error(error.value(), system_category(), error.message())),
                       shared_from_this());
@@ -123,7 +142,7 @@ void HTTPPost::operator()(bs::error_code error = bs::error_code(), std::size_t =
         // Send the request
         buffer_->Reset();
         *buffer_ << "POST " << path_ << " HTTP/1.1\r\n"
-             << "Host: " << sock_->remote_endpoint().address().to_string() << "\r\n"
+             << "Host: " << socket::GetHost(sock_->remote_endpoint()) << "\r\n"
              << "Content-Length: " << request_content_.size() << "\r\n"
              << "Connection: Keep-Alive\r\n";
 
@@ -137,72 +156,51 @@ void HTTPPost::operator()(bs::error_code error = bs::error_code(), std::size_t =
 
         ba::async_write(*sock_, **buffer_, BIND2(operator(), _1, _2));
       }
-      yield {
-        // Read the response header
-        buffer_->Reset();
-        ba::async_read_until(*sock_, **buffer_, "\r\n\r\n", BIND2(operator(), _1, _2));
-      }
-      yield {
-        // Parse the response header and read the content in existent
-        std::string key, value;
-        *buffer_ >> key;
-        *buffer_ >> response_status_code_;
-        std::cout << "HTTP Post response status<" << response_status_code_ << ">" << std::endl;
-
-        // Get header fields
-        while (true) {
-          key.clear();
-          value.clear();
-          *buffer_ >> key;
-          getline(buffer_->GetIStream(), value);
-          std::cout << "Found header field <" << key << ", " << value << ">" << std::endl;
-          if (key.empty() || value.empty()) {
-            break;
-          }
-          response_headers_.push_back({key, value});
-          if (*boost::asio::buffers_begin((**buffer_).data()) == '\r') {
-            (**buffer_).consume(2);
-            break;
-          }
-        }
 
-        response_content_ = buffer_->ToString();
-        buffer_->Reset();
+      buffer_->Reset();
+      parser_.Reset();
+      response_status_code_ = -1;
+      response_headers_.clear();
+      response_trailers_.clear();
+      response_content_.clear();
+      do {
+        yield sock_->async_read_some((**buffer_).prepare(kReadSize), BIND2(operator(), _1, _2));
+        (**buffer_).commit(bytes);
+        if (!ParseResponse(error == ba::error::eof)) return;
+      } while (!parser_.IsComplete());
 
-        int content_length = 0;
-        try {
-          content_length = stoi(GetHeaderField(response_headers_, "Content-Length"));
-        } catch (const std::exception &e) {
-          std::cout <<" Failed to get content length" << std::endl;
-        }
-
-        if (static_cast<int>(response_content_.size()) > content_length) {
-          std::cout << "Got invalid content length" << std::endl;
-          content_length = response_content_.size();
-        }
-
-        size_t to_read = content_length - response_content_.size();
-        ba::async_read(*sock_, **buffer_, ba::transfer_exactly(to_read), BIND2(operator(), _1, _2));
-      }
       yield {
         // Perform callback
         Stop();
-        response_content_ = response_content_ + buffer_->ToString();
-        std::cout << "HTTP Post successful, returned content: " << buffer_->ToString() << std::endl;
+        PROTOCOL_LOG_DEBUG("HTTP Post response status<" << response_status_code_ << ">, " << response_headers_.size()
+                           << " headers, " << response_content_.size() << " bytes of content");
+        PROTOCOL_LOG_TRACE("HTTP Post successful, returned content: " << response_content_);
+        buffer_->Reset();
         on_done_callback_(nullptr, shared_from_this());
       }
     }
   }
 }
 
+bool HTTPPost::ParseResponse(bool eof) {
+  try {
+    const auto data = (**buffer_).data();
+    (**buffer_).consume(parser_.Parse(ba::buffer_cast<const char*>(data), ba::buffer_size(data)));
+    if (eof) parser_.Finish();
+  } catch (const std::exception&) {
+    Stop();
+    on_done_callback_(std::current_exception(), shared_from_this());
+    return false;
+  }
+  return true;
+}
+
 void HTTPPost::OnTimeout() {
   if (stopped_) return;
 
-  if (deadline_->expires_at() <= ba::deadline_timer::traits_type::now()) {
-    Stop();
-    on_done_callback_(make_exception_ptr(system_error(ETIMEDOUT, system_category(), "Operation timed out")),
-                      shared_from_this());
-  }
+  Stop();
+  on_done_callback_(make_exception_ptr(system_error(ETIMEDOUT, system_category(), "Operation timed out")),
+                    shared_from_this());
 }
 
 const std::string& HTTPPost::GetRequestBody() const {
@@ -225,10 +223,18 @@ const Headers& HTTPPost::GetResponseHeaders() const {
   return response_headers_;
 }
 
+const Headers& HTTPPost::GetResponseTrailers() const {
+  return response_trailers_;
+}
+
 int HTTPPost::GetResponseStatusCode() const {
   return response_status_code_;
 }
 
+bool HTTPPost::IsPersistent() const {
+  return parser_.IsComplete() && parser_.IsPersistent();
+}
+
 void HTTPPost::SetRequestBody(std::string content) {
   request_content_ = std::move(content);
 }
@@ -237,6 +243,10 @@ void HTTPPost::SetRequestHeaders(Headers headers) {
   request_headers_ = std::move(headers);
 }
 
+void HTTPPost::SetOnBodyCallback(const BodyCallback& callback) {
+  on_body_callback_ = callback;
+}
+
 void HTTPPost::SetOnDoneCallback(const Callback& callback) {
   on_done_callback_ = callback;
 }
@@ -0,0 +1,45 @@
+/**
+ * @file   protocol/tcp/client/src/lease.cpp
+ * @brief  Class definition of protocol::tcp::client::Lease
+ */
+
+#include <utility>
+
+#include <protocol/tcp/client/connection_pool.hpp>
+#include <protocol/tcp/client/lease.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace client {
+
+Lease::Lease(connection_pool::WeakPtr pool, std::string key, socket::sock::Ptr sock, bool reused)
+    : pool_(std::move(pool)), key_(std::move(key)), sock_(std::move(sock)), reused_(reused) {
+}
+
+Lease::~Lease() {
+  Return(false);
+}
+
+const socket::sock::Ptr& Lease::GetSock() const {
+  return sock_;
+}
+
+bool Lease::IsReused() const {
+  return reused_;
+}
+
+void Lease::Release() {
+  Return(true);
+}
+
+void Lease::Return(bool reusable) {
+  if (!sock_) return;
+  socket::sock::Ptr sock;
+  sock.swap(sock_);
+  connection_pool::Ptr pool = pool_.lock();
+  if (pool) pool->Return(key_, sock, reusable);
+}
+
+}  // namespace client
+}  // namespace tcp
+}  // namespace protocol
@@ -0,0 +1,302 @@
+/**
+ * @file   protocol/tcp/client/src/response_parser.cpp
+ * @brief  Class definition of protocol::tcp::client::http::ResponseParser
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include <protocol/tcp/client/response_parser.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace client {
+namespace http {
+
+using boost::string_ref;
+
+const size_t ResponseParser::kMaxLineSize;
+const size_t ResponseParser::kMaxFields;
+const size_t ResponseParser::kMaxHeaderSize;
+
+namespace {
+
+/**
+ * Compare an ASCII string with a lower case one, ignoring case
+ * @param str   String
+ * @param lower Lower case string
+ * @return True if equal
+ */
+bool IEquals(string_ref str, string_ref lower) {
+  if (str.size() != lower.size()) return false;
+  for (size_t i = 0; i < str.size(); ++i) {
+    const char c = str[i];
+    if ((c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c) != lower[i]) return false;
+  }
+  return true;
+}
+
+/**
+ * Strip the spaces and tabs surrounding a string
+ * @param str String
+ * @return Stripped string
+ */
+string_ref Trim(string_ref str) {
+  while (!str.empty() && (str.front() == ' ' || str.front() == '\t')) str.remove_prefix(1);
+  while (!str.empty() && (str.back() == ' ' || str.back() == '\t')) str.remove_suffix(1);
+  return str;
+}
+
+/**
+ * Check whether a comma separated list holds a token, ignoring case
+ * @param list  List
+ * @param token Lower case token
+ * @return True if found
+ */
+bool HasToken(string_ref list, string_ref token) {
+  while (!list.empty()) {
+    const size_t comma = std::min(list.find(','), list.size());
+    if (IEquals(Trim(list.substr(0, comma)), token)) return true;
+    list.remove_prefix(std::min(comma + 1, list.size()));
+  }
+  return false;
+}
+
+/**
+ * Check whether a character is a decimal digit
+ * @param c Character
+ * @return True for a digit
+ */
+bool IsDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+/**
+ * Get the value of a hexadecimal digit
+ * @param c Character
+ * @return Value, -1 for a character that isn't a hexadecimal digit
+ */
+int HexValue(char c) {
+  if (IsDigit(c)) return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+}  // namespace
+
+ResponseParser::ResponseParser(const StatusCallback& on_status, const HeaderCallback& on_header,
+                               const BodyCallback& on_body, const HeaderCallback& on_trailer)
+    : on_status_(on_status),
+      on_header_(on_header),
+      on_body_(on_body),
+      on_trailer_(on_trailer),
+      state_(State::kStatusLine),
+      status_(-1),
+      http10_(false),
+      has_length_(false),
+      chunked_(false),
+      remaining_(0),
+      close_(false),
+      keep_alive_(false),
+      fields_(0),
+      header_size_(0) {
+}
+
+size_t ResponseParser::Parse(const char* data, size_t size) {
+  size_t parsed = 0;
+  while (parsed < size && state_ != State::kComplete) {
+    const char* begin = data + parsed;
+    const size_t left = size - parsed;
+    switch (state_) {
+      case State::kStatusLine:
+      case State::kHeaders:
+      case State::kChunkSize:
+      case State::kChunkEnd:
+      case State::kTrailers: {
+        const char* end = static_cast<const char*>(std::memchr(begin, '\n', std::min(left, kMaxLineSize + 1)));
+        if (!end) {
+          if (left > kMaxLineSize) throw std::runtime_error("HTTP response line too long");
+          return parsed;
+        }
+        string_ref line(begin, end - begin);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        parsed += end - begin + 1;
+        if (state_ != State::kChunkSize && state_ != State::kChunkEnd &&
+            (header_size_ += end - begin + 1) > kMaxHeaderSize) {
+          throw std::runtime_error("HTTP response headers too large");
+        }
+        if (state_ == State::kStatusLine) {
+          ParseStatus(line);
+        } else if (state_ == State::kHeaders) {
+          ParseHeader(line);
+        } else {
+          ParseChunk(line);
+        }
+        break;
+      }
+      case State::kBody: {
+        const size_t slice = static_cast<size_t>(std::min<uint64_t>(left, remaining_));
+        if (on_body_) on_body_(string_ref(begin, slice));
+        parsed += slice;
+        remaining_ -= slice;
+        if (!remaining_) state_ = chunked_ ? State::kChunkEnd : State::kComplete;
+        break;
+      }
+      case State::kBodyToEof:
+        if (on_body_) on_body_(string_ref(begin, left));
+        parsed = size;
+        break;
+      case State::kComplete:
+        break;
+    }
+  }
+  return parsed;
+}
+
+void ResponseParser::Finish() {
+  if (state_ == State::kBodyToEof) {
+    // The body ended with the connection
+    close_ = true;
+    state_ = State::kComplete;
+  }
+  if (state_ != State::kComplete) throw std::runtime_error("HTTP response truncated");
+}
+
+void ResponseParser::Reset() {
+  Restart();
+  fields_ = 0;
+  header_size_ = 0;
+}
+
+void ResponseParser::Restart() {
+  state_ = State::kStatusLine;
+  status_ = -1;
+  http10_ = false;
+  has_length_ = false;
+  chunked_ = false;
+  remaining_ = 0;
+  close_ = false;
+  keep_alive_ = false;
+}
+
+bool ResponseParser::IsComplete() const {
+  return state_ == State::kComplete;
+}
+
+bool ResponseParser::IsHeaderComplete() const {
+  return state_ != State::kStatusLine && state_ != State::kHeaders;
+}
+
+int ResponseParser::GetStatus() const {
+  return status_;
+}
+
+bool ResponseParser::IsPersistent() const {
+  if (close_ || state_ == State::kBodyToEof || (chunked_ && has_length_)) return false;
+  return !http10_ || keep_alive_;
+}
+
+void ResponseParser::ParseStatus(string_ref line) {
+  // HTTP/1.x SP 3DIGIT [SP reason-phrase]
+  if (line.size() < 12 || line.substr(0, 7) != "HTTP/1." || !IsDigit(line[7]) || line[8] != ' ' ||
+      !IsDigit(line[9]) || !IsDigit(line[10]) || !IsDigit(line[11]) || (line.size() > 12 && line[12] != ' ')) {
+    throw std::runtime_error("Malformed HTTP status line");
+  }
+  http10_ = line[7] == '0';
+  status_ = (line[9] - '0') * 100 + (line[10] - '0') * 10 + (line[11] - '0');
+  state_ = State::kHeaders;
+  if (on_status_) on_status_(status_, line.size() > 12 ? line.substr(13) : string_ref());
+}
+
+void ResponseParser::ParseHeader(string_ref line) {
+  if (line.empty()) {
+    if (status_ < 200) {
+      // Interim response, the final one follows
+      Restart();
+    } else if (status_ == 204 || status_ == 304) {
+      state_ = State::kComplete;
+    } else if (chunked_) {
+      // The chunked coding takes precedence over Content-Length
+      state_ = State::kChunkSize;
+    } else if (has_length_ && !remaining_) {
+      state_ = State::kComplete;
+    } else {
+      state_ = has_length_ ? State::kBody : State::kBodyToEof;
+    }
+    return;
+  }
+
+  string_ref name;
+  const string_ref value = ParseField(line, name, on_header_);
+  if (IEquals(name, "content-length")) {
+    uint64_t length = 0;
+    if (value.empty()) throw std::runtime_error("Malformed HTTP Content-Length");
+    for (char c : value) {
+      if (!IsDigit(c) || length > (std::numeric_limits<uint64_t>::max() - 9) / 10) {
+        throw std::runtime_error("Malformed HTTP Content-Length");
+      }
+      length = length * 10 + (c - '0');
+    }
+    if (has_length_ && length != remaining_) throw std::runtime_error("Conflicting HTTP Content-Length");
+    has_length_ = true;
+    remaining_ = length;
+  } else if (IEquals(name, "transfer-encoding")) {
+    // Compressed transfer codings aren't decoded, and chunked must come last
+    for (string_ref list = value; !list.empty();) {
+      const size_t comma = std::min(list.find(','), list.size());
+      const string_ref coding = Trim(list.substr(0, comma));
+      if (chunked_ || (!IEquals(coding, "identity") && !IEquals(coding, "chunked"))) {
+        throw std::runtime_error("Unsupported HTTP Transfer-Encoding");
+      }
+      chunked_ = IEquals(coding, "chunked");
+      list.remove_prefix(std::min(comma + 1, list.size()));
+    }
+  } else if (IEquals(name, "connection")) {
+    close_ = close_ || HasToken(value, "close");
+    keep_alive_ = keep_alive_ || HasToken(value, "keep-alive");
+  }
+}
+
+void ResponseParser::ParseChunk(string_ref line) {
+  if (state_ == State::kChunkEnd) {
+    if (!line.empty()) throw std::runtime_error("Malformed HTTP chunk");
+    state_ = State::kChunkSize;
+  } else if (state_ == State::kChunkSize) {
+    // chunk-size [; chunk-ext]
+    const string_ref size = Trim(line.substr(0, std::min(line.find(';'), line.size())));
+    if (size.empty()) throw std::runtime_error("Malformed HTTP chunk size");
+    uint64_t length = 0;
+    for (char c : size) {
+      const int digit = HexValue(c);
+      if (digit < 0 || length > (std::numeric_limits<uint64_t>::max() >> 4)) {
+        throw std::runtime_error("Malformed HTTP chunk size");
+      }
+      length = (length << 4) | static_cast<uint64_t>(digit);
+    }
+    remaining_ = length;
+    state_ = length ? State::kBody : State::kTrailers;
+  } else if (line.empty()) {
+    state_ = State::kComplete;
+  } else {
+    string_ref name;
+    ParseField(line, name, on_trailer_);
+  }
+}
+
+string_ref ResponseParser::ParseField(string_ref line, string_ref& name, const HeaderCallback& on_field) {
+  const size_t colon = line.find(':');
+  if (colon == string_ref::npos || !colon) throw std::runtime_error("Malformed HTTP header");
+  if (++fields_ > kMaxFields) throw std::runtime_error("Too many HTTP header fields");
+  name = line.substr(0, colon);
+  const string_ref value = Trim(line.substr(colon + 1));
+  if (on_field) on_field(name, value);
+  return value;
+}
+
+}  // namespace http
+}  // namespace client
+}  // namespace tcp
+}  // namespace protocol
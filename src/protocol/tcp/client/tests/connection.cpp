@@ -4,10 +4,14 @@
  * @brief Unit tests for protocol::tcp::client::Connection
  */
 
+#include <sys/socket.h>
+
 #include <cerrno>
 #include <chrono>
 #include <future>
+#include <system_error>
 #include <thread>
+#include <vector>
 
 #include <boost/system/system_error.hpp>
 #include <gtest/gtest.h>
@@ -68,6 +72,102 @@ TEST(Connection, NoEndpoint) {
   connection->Stop();
 }
 
+/**
+ * Listening socket whose backlog is full, connection attempts to it hang
+ */
+class BlackHole {
+ public:
+  BlackHole() : service_(), acceptor_(service_), filler_(service_) {
+    acceptor_.open(tcp::v4());
+    acceptor_.bind(tcp::endpoint(ba::ip::address_v4::loopback(), 0));
+    acceptor_.listen(0);
+    filler_.connect(acceptor_.local_endpoint());
+  }
+
+  /**
+   * Get the endpoint of the black hole
+   * @return Endpoint
+   */
+  tcp::endpoint GetEndpoint() const {
+    return acceptor_.local_endpoint();
+  }
+
+ private:
+  ba::io_service service_;  ///< io_service of the sockets
+  tcp::acceptor acceptor_;  ///< Listening socket with a backlog of 0
+  tcp::socket filler_;      ///< Connection filling the backlog
+};
+
+/**
+ * Connect to a list of endpoints
+ * @param endpoints  Endpoints
+ * @param timeout_ms Timeout
+ * @param config     Connection configuration
+ * @param sock       Set to the socket of the connection
+ * @return Error of the connection
+ */
+bs::error_code ConnectAll(const std::vector<socket::Endpoint>& endpoints, size_t timeout_ms,
+                          const connection::Config& config, socket::sock::Ptr& sock) {
+  promise<bs::error_code> result;
+  auto connection = Connection::Start(endpoints, timeout_ms, [&](exception_ptr eptr, socket::sock::Ptr connected) {
+    sock = connected;
+    try {
+      if (eptr) std::rethrow_exception(eptr);
+      result.set_value(bs::error_code());
+    } catch (const std::system_error& e) {
+      result.set_value(bs::error_code(e.code().value(), bs::system_category()));
+    }
+  }, socket::Options(), config);
+  return result.get_future().get();
+}
+
+/**
+ * @test A black-holed endpoint doesn't hold back the next one
+ */
+TEST(Connection, HappyEyeballs) {
+  BlackHole black_hole;
+  ba::io_service service;
+  tcp::acceptor live(service, tcp::endpoint(ba::ip::address_v4::loopback(), 0));
+  connection::Config config;
+  config.attempt_delay_ms = 50;
+
+  socket::sock::Ptr sock;
+  const auto start = sc::steady_clock::now();
+  ASSERT_FALSE(ConnectAll({black_hole.GetEndpoint(), live.local_endpoint()}, 2000, config, sock));
+  ASSERT_GT(sc::milliseconds(1000), sc::steady_clock::now() - start);
+  ASSERT_EQ(socket::ToString(live.local_endpoint()), socket::ToString(sock->remote_endpoint()));
+
+  // Tried one after the other, the black hole uses up the timeout
+  config.attempt_delay_ms = 0;
+  ASSERT_EQ(ETIMEDOUT, ConnectAll({black_hole.GetEndpoint(), live.local_endpoint()}, 300, config, sock).value());
+}
+
+/**
+ * @test A failed attempt starts the next one without waiting for the delay
+ */
+TEST(Connection, AttemptFailure) {
+  ba::io_service service;
+  tcp::acceptor live(service, tcp::endpoint(ba::ip::address_v4::loopback(), 0));
+  const tcp::endpoint refused(ba::ip::address_v4::loopback(), utility::GetAvailablePort());
+  connection::Config config;
+  config.attempt_delay_ms = 5000;
+
+  socket::sock::Ptr sock;
+  const auto start = sc::steady_clock::now();
+  ASSERT_FALSE(ConnectAll({refused, live.local_endpoint()}, 2000, config, sock));
+  ASSERT_GT(sc::milliseconds(1000), sc::steady_clock::now() - start);
+  ASSERT_EQ(ECONNREFUSED, ConnectAll({refused, refused}, 2000, config, sock).value());
+
+  // A socket that can't be opened is a failed attempt too, whether it comes first or later
+  sockaddr_storage storage = {};
+  storage.ss_family = AF_UNSPEC;
+  const socket::Endpoint unsupported(&storage, sizeof(storage));
+  ASSERT_FALSE(ConnectAll({unsupported, live.local_endpoint()}, 2000, config, sock));
+  ASSERT_FALSE(ConnectAll({refused, unsupported, live.local_endpoint()}, 2000, config, sock));
+  ASSERT_EQ(socket::ToString(live.local_endpoint()), socket::ToString(sock->remote_endpoint()));
+  ASSERT_EQ(EAFNOSUPPORT, ConnectAll({refused, unsupported}, 2000, config, sock).value());
+}
+
 /**
  * @test Tests timeout
  */
@@ -0,0 +1,233 @@
+/**
+ * @cond  internal
+ * @file  protocol/tcp/client/tests/connection_pool.cpp
+ * @brief Unit tests for protocol::tcp::client::ConnectionPool
+ */
+
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/write.hpp>
+#include <gtest/gtest.h>
+
+#include <protocol/tcp/client/connection_pool.hpp>
+#include <protocol/tcp/client/lease.hpp>
+#include <protocol/tcp/server/acceptor.hpp>
+
+#include "protocol/utility/get_available_port.hpp"
+
+namespace protocol {
+namespace tcp {
+namespace client {
+
+using std::exception_ptr;
+namespace sc = std::chrono;
+namespace ba = boost::asio;
+namespace bs = boost::system;
+
+namespace {
+
+/**
+ * Server keeping every accepted socket
+ */
+class Server {
+ public:
+  Server()
+      : port_(utility::GetAvailablePort()),
+        mutex_(),
+        accepted_(),
+        acceptor_(port_, [this](bs::error_code ec, server::Acceptor &, socket::sock::Ptr sock) {
+          if (ec) return;
+          std::lock_guard<std::mutex> lock(mutex_);
+          accepted_.push_back(sock);
+        }) {}
+
+  uint16_t GetPort() const {
+    return port_;
+  }
+
+  /**
+   * Wait until a number of connections were accepted
+   * @param count Number of connections
+   * @return The accepted socket of the last one
+   */
+  socket::sock::Ptr WaitFor(size_t count) {
+    for (size_t i = 0; i < 200; ++i) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (accepted_.size() >= count) return accepted_[count - 1];
+      }
+      std::this_thread::sleep_for(sc::milliseconds(10));
+    }
+    return socket::sock::Ptr();
+  }
+
+ private:
+  uint16_t port_;
+  std::mutex mutex_;
+  std::vector<socket::sock::Ptr> accepted_;
+  server::Acceptor acceptor_;
+};
+
+/**
+ * Lease a socket and wait for it
+ * @param pool Pool to lease from
+ * @param port Port of the local server
+ * @return The lease
+ */
+lease::Ptr Lend(const connection_pool::Ptr &pool, uint16_t port) {
+  std::promise<lease::Ptr> leased;
+  pool->Acquire("127.0.0.1", port, [&](exception_ptr eptr, lease::Ptr lease) {
+    if (eptr) {
+      leased.set_exception(eptr);
+    } else {
+      leased.set_value(lease);
+    }
+  });
+  return leased.get_future().get();
+}
+
+}  // namespace
+
+/**
+ * @test A released socket is lent again, a dropped one is closed
+ */
+TEST(ConnectionPool, Reuse) {
+  Server server;
+  connection_pool::Ptr pool = ConnectionPool::Create();
+
+  lease::Ptr first = Lend(pool, server.GetPort());
+  ASSERT_FALSE(first->IsReused());
+  socket::sock::Ptr sock = first->GetSock();
+  ASSERT_TRUE(sock->is_open());
+  first->Release();
+  ASSERT_FALSE(first->GetSock());
+  ASSERT_EQ(1u, pool->GetStats().idle);
+
+  lease::Ptr second = Lend(pool, server.GetPort());
+  ASSERT_TRUE(second->IsReused());
+  ASSERT_EQ(sock, second->GetSock());
+  // The handler that delivered the lease may still hold it for a moment
+  second.reset();
+  std::this_thread::sleep_for(sc::milliseconds(50));
+  ASSERT_FALSE(sock->is_open());
+  ASSERT_EQ(0u, pool->GetStats().idle);
+
+  lease::Ptr third = Lend(pool, server.GetPort());
+  ASSERT_FALSE(third->IsReused());
+  ASSERT_TRUE(server.WaitFor(2));
+  auto stats = pool->GetStats();
+  ASSERT_EQ(1u, stats.hits);
+  ASSERT_EQ(2u, stats.connects);
+}
+
+/**
+ * @test Idle sockets closed by the peer, or with unread data, fail the check on checkout
+ */
+TEST(ConnectionPool, HealthCheck) {
+  Server server;
+  connection_pool::Ptr pool = ConnectionPool::Create();
+
+  Lend(pool, server.GetPort())->Release();
+  server.WaitFor(1)->close();
+  std::this_thread::sleep_for(sc::milliseconds(50));
+  lease::Ptr lease = Lend(pool, server.GetPort());
+  ASSERT_FALSE(lease->IsReused());
+  ASSERT_EQ(1u, pool->GetStats().failed_checks);
+
+  lease->Release();
+  ba::write(*server.WaitFor(2), ba::buffer("x", 1));
+  std::this_thread::sleep_for(sc::milliseconds(50));
+  ASSERT_FALSE(Lend(pool, server.GetPort())->IsReused());
+  auto stats = pool->GetStats();
+  ASSERT_EQ(2u, stats.failed_checks);
+  ASSERT_EQ(0u, stats.hits);
+}
+
+/**
+ * @test Requests above max_per_host wait for a socket to be released
+ */
+TEST(ConnectionPool, MaxPerHost) {
+  Server server;
+  connection_pool::Config config;
+  config.max_per_host = 1;
+  connection_pool::Ptr pool = ConnectionPool::Create(config);
+
+  lease::Ptr first = Lend(pool, server.GetPort());
+  std::promise<lease::Ptr> leased;
+  pool->Acquire("127.0.0.1", server.GetPort(), [&](exception_ptr eptr, lease::Ptr lease) {
+    ASSERT_FALSE(eptr);
+    leased.set_value(lease);
+  });
+  auto waiting = leased.get_future();
+  ASSERT_EQ(std::future_status::timeout, waiting.wait_for(sc::milliseconds(100)));
+
+  socket::sock::Ptr sock = first->GetSock();
+  first->Release();
+  ASSERT_EQ(std::future_status::ready, waiting.wait_for(sc::milliseconds(500)));
+  lease::Ptr second = waiting.get();
+  ASSERT_TRUE(second->IsReused());
+  ASSERT_EQ(sock, second->GetSock());
+  auto stats = pool->GetStats();
+  ASSERT_EQ(1u, stats.waited);
+  ASSERT_EQ(1u, stats.connects);
+}
+
+/**
+ * @test Destroying the pool fails the waiting requests with operation_aborted
+ */
+TEST(ConnectionPool, DestroyWithWaiters) {
+  Server server;
+  connection_pool::Config config;
+  config.max_per_host = 1;
+  connection_pool::Ptr pool = ConnectionPool::Create(config);
+
+  lease::Ptr first = Lend(pool, server.GetPort());
+  std::promise<exception_ptr> failed;
+  pool->Acquire("127.0.0.1", server.GetPort(), [&](exception_ptr eptr, lease::Ptr) {
+    failed.set_value(eptr);
+  });
+  pool.reset();
+
+  auto waiting = failed.get_future();
+  ASSERT_EQ(std::future_status::ready, waiting.wait_for(sc::milliseconds(500)));
+  exception_ptr eptr = waiting.get();
+  ASSERT_TRUE(eptr);
+  try {
+    std::rethrow_exception(eptr);
+  } catch (const std::system_error& error) {
+    ASSERT_EQ(ba::error::operation_aborted, error.code().value());
+  }
+  first->Release();
+}
+
+/**
+ * @test Idle sockets are closed after the idle timeout, and leases outlive the pool
+ */
+TEST(ConnectionPool, IdleTimeout) {
+  Server server;
+  connection_pool::Config config;
+  config.idle_timeout_ms = 50;
+  connection_pool::Ptr pool = ConnectionPool::Create(config);
+
+  Lend(pool, server.GetPort())->Release();
+  std::this_thread::sleep_for(sc::milliseconds(300));
+  auto stats = pool->GetStats();
+  ASSERT_EQ(1u, stats.evicted);
+  ASSERT_EQ(0u, stats.idle);
+
+  lease::Ptr lease = Lend(pool, server.GetPort());
+  ASSERT_FALSE(lease->IsReused());
+  pool.reset();
+  lease->Release();
+}
+
+}  // namespace client
+}  // namespace tcp
+}  // namespace protocol
+
+/// @endcond internal
@@ -0,0 +1,191 @@
+/**
+ * @cond  internal
+ * @file  protocol/tcp/client/tests/dns_cache.cpp
+ * @brief Unit tests for protocol::tcp::client::DnsCache
+ */
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/io_service.hpp>
+#include <gtest/gtest.h>
+
+#include <protocol/service/singleton.hpp>
+#include <protocol/tcp/client/dns_cache.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace client {
+
+namespace sc = std::chrono;
+namespace ba = boost::asio;
+namespace bs = boost::system;
+
+class DnsCacheTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    config_ = DnsCache::GetConfig();
+    DnsCache::Clear();
+    before_ = DnsCache::GetStats();
+  }
+
+  virtual void TearDown() {
+    DnsCache::Configure(config_);
+    DnsCache::Clear();
+  }
+
+  /**
+   * Get the counters changed since the test started
+   * @return Counters
+   */
+  dns_cache::Stats GetStats() const {
+    dns_cache::Stats stats = DnsCache::GetStats();
+    stats.hits -= before_.hits;
+    stats.negative_hits -= before_.negative_hits;
+    stats.misses -= before_.misses;
+    stats.coalesced -= before_.coalesced;
+    stats.refreshes -= before_.refreshes;
+    return stats;
+  }
+
+  /**
+   * Resolve a name on a private io_service
+   * @param host Name to resolve
+   * @param port Port of the endpoints
+   * @param ec   Set to the lookup error
+   * @return Endpoints
+   */
+  DnsCache::Endpoints Resolve(const std::string& host, uint16_t port, bs::error_code& ec) {
+    ba::io_service service;
+    DnsCache::Endpoints endpoints;
+    DnsCache::Resolve(service, host, port, [&](const bs::error_code& error, const DnsCache::Endpoints& resolved) {
+      ec = error;
+      endpoints = resolved;
+    });
+    service.run();
+    return endpoints;
+  }
+
+  dns_cache::Config config_;  ///< Configuration restored after the test
+  dns_cache::Stats before_;   ///< Counters when the test started
+};
+
+/**
+ * @test Numeric addresses don't need a lookup
+ */
+TEST_F(DnsCacheTest, Numeric) {
+  bs::error_code ec;
+  DnsCache::Endpoints endpoints = Resolve("127.0.0.1", 80, ec);
+  ASSERT_FALSE(ec);
+  ASSERT_EQ(1u, endpoints.size());
+  ASSERT_EQ("127.0.0.1", endpoints[0].address().to_string());
+  ASSERT_EQ(80, endpoints[0].port());
+  ASSERT_EQ(1u, Resolve("::1", 80, ec).size());
+  ASSERT_EQ(0u, GetStats().misses);
+  ASSERT_EQ(0u, GetStats().entries);
+}
+
+/**
+ * @test Concurrent requests share one lookup and later ones are served from the cache, whatever their port
+ */
+TEST_F(DnsCacheTest, Coalescing) {
+  ba::io_service service;
+  std::vector<DnsCache::Endpoints> results;
+  for (uint16_t port = 1; port <= 8; ++port) {
+    DnsCache::Resolve(service, "localhost", port, [&](const bs::error_code& ec, const DnsCache::Endpoints& endpoints) {
+      ASSERT_FALSE(ec);
+      results.push_back(endpoints);
+    });
+  }
+  auto stats = GetStats();
+  ASSERT_EQ(1u, stats.misses);
+  ASSERT_EQ(7u, stats.coalesced);
+  service.run();
+  ASSERT_EQ(8u, results.size());
+  for (auto& endpoints : results) {
+    ASSERT_FALSE(endpoints.empty());
+    ASSERT_TRUE(endpoints[0].address().is_loopback());
+  }
+
+  bs::error_code ec;
+  DnsCache::Endpoints endpoints = Resolve("localhost", 443, ec);
+  ASSERT_FALSE(ec);
+  ASSERT_EQ(443, endpoints[0].port());
+  stats = GetStats();
+  ASSERT_EQ(1u, stats.hits);
+  ASSERT_EQ(1u, stats.misses);
+  ASSERT_EQ(1u, stats.entries);
+}
+
+/**
+ * @test Failed lookups are cached for the negative TTL
+ */
+TEST_F(DnsCacheTest, Negative) {
+  dns_cache::Config config;
+  config.negative_ttl_ms = 100;
+  DnsCache::Configure(config);
+
+  bs::error_code ec;
+  ASSERT_TRUE(Resolve("invalid_host!", 80, ec).empty());
+  ASSERT_TRUE(ec);
+  ec = bs::error_code();
+  Resolve("invalid_host!", 80, ec);
+  ASSERT_TRUE(ec);
+  auto stats = GetStats();
+  ASSERT_EQ(1u, stats.misses);
+  ASSERT_EQ(1u, stats.negative_hits);
+
+  std::this_thread::sleep_for(sc::milliseconds(150));
+  Resolve("invalid_host!", 80, ec);
+  ASSERT_EQ(2u, GetStats().misses);
+}
+
+/**
+ * @test A name requested close to its expiry is refreshed in the background, a TTL of 0 disables caching
+ */
+TEST_F(DnsCacheTest, RefreshAndTtl) {
+  dns_cache::Config config;
+  config.ttl_ms = 1000;
+  config.refresh_ahead_ms = 1000;
+  DnsCache::Configure(config);
+
+  bs::error_code ec;
+  Resolve("localhost", 80, ec);
+  Resolve("localhost", 80, ec);
+  ASSERT_FALSE(ec);
+  auto stats = GetStats();
+  ASSERT_EQ(1u, stats.misses);
+  ASSERT_EQ(1u, stats.hits);
+  ASSERT_EQ(1u, stats.refreshes);
+
+  config.ttl_ms = 0;
+  DnsCache::Configure(config);
+  DnsCache::Clear();
+  Resolve("localhost", 80, ec);
+  Resolve("localhost", 80, ec);
+  ASSERT_EQ(3u, GetStats().misses);
+  ASSERT_EQ(0u, GetStats().entries);
+}
+
+/**
+ * @test Pre-warmed names are served from the cache on first use
+ */
+TEST_F(DnsCacheTest, Prewarm) {
+  DnsCache::Prewarm({"localhost", "127.0.0.1"});
+  ASSERT_EQ(1u, GetStats().refreshes);
+  for (size_t i = 0; i < 100 && DnsCache::GetStats().hits == before_.hits; ++i) {
+    bs::error_code ec;
+    Resolve("localhost", 80, ec);
+    std::this_thread::sleep_for(sc::milliseconds(10));
+  }
+  ASSERT_EQ(0u, GetStats().misses);
+  ASSERT_LE(1u, GetStats().hits);
+  service::singleton::TearDown();
+}
+
+}  // namespace client
+}  // namespace tcp
+}  // namespace protocol
+
+/// @endcond internal
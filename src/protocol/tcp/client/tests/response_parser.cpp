@@ -0,0 +1,219 @@
+/**
+ * @cond  internal
+ * @file  protocol/tcp/client/tests/response_parser.cpp
+ * @brief Unit tests for protocol::tcp::client::http::ResponseParser
+ */
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <protocol/tcp/client/response_parser.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace client {
+namespace http {
+
+/**
+ * Collects what a ResponseParser reports
+ */
+struct Response {
+  Response()
+      : parser([this](int code, boost::string_ref text) {
+                 status.push_back(code);
+                 reason = text.to_string();
+               },
+               [this](boost::string_ref name, boost::string_ref value) {
+                 headers.push_back(std::make_pair(name.to_string(), value.to_string()));
+               },
+               [this](boost::string_ref data) {
+                 body.append(data.data(), data.size());
+                 ++slices;
+               },
+               [this](boost::string_ref name, boost::string_ref value) {
+                 trailers.push_back(std::make_pair(name.to_string(), value.to_string()));
+               }),
+        status(),
+        reason(),
+        headers(),
+        trailers(),
+        body(),
+        slices(0) {}
+
+  /**
+   * Feed bytes in pieces, keeping the unconsumed bytes like a receive buffer does
+   * @param bytes Bytes
+   * @param piece Size of the pieces
+   * @return Bytes left after the response
+   */
+  std::string Feed(const std::string& bytes, size_t piece) {
+    std::string pending;
+    size_t pos = 0;
+    for (; pos < bytes.size() && !parser.IsComplete(); pos += piece) {
+      pending.append(bytes, pos, piece);
+      pending.erase(0, parser.Parse(pending.data(), pending.size()));
+    }
+    return pending + bytes.substr(std::min(pos, bytes.size()));
+  }
+
+  ResponseParser parser;                                      ///< Parser
+  std::vector<int> status;                                    ///< Status codes reported
+  std::string reason;                                         ///< Last reason phrase
+  std::vector<std::pair<std::string, std::string>> headers;   ///< Headers reported
+  std::vector<std::pair<std::string, std::string>> trailers;  ///< Trailers reported
+  std::string body;                                           ///< Body
+  size_t slices;                                              ///< Number of body slices
+};
+
+/**
+ * @test A response is parsed the same whatever the size of the pieces it arrives in
+ */
+TEST(ResponseParser, Pieces) {
+  const std::string bytes(
+      "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\ncontent-length:  11 \r\nX-Empty:\r\n\r\nhello worldHTTP/1.1");
+  for (size_t piece : {bytes.size(), size_t(1), size_t(7)}) {
+    Response response;
+    ASSERT_EQ("HTTP/1.1", response.Feed(bytes, piece).substr(0, 8));
+    ASSERT_TRUE(response.parser.IsComplete());
+    ASSERT_EQ(std::vector<int>{200}, response.status);
+    ASSERT_EQ("OK", response.reason);
+    ASSERT_EQ(3u, response.headers.size());
+    ASSERT_EQ("content-length", response.headers[1].first);
+    ASSERT_EQ("11", response.headers[1].second);
+    ASSERT_EQ("", response.headers[2].second);
+    ASSERT_EQ("hello world", response.body);
+    ASSERT_TRUE(response.parser.IsPersistent());
+  }
+}
+
+/**
+ * @test Bodies delimited by the end of the stream, empty bodies and interim responses
+ */
+TEST(ResponseParser, Delimiting) {
+  Response to_eof;
+  to_eof.Feed("HTTP/1.1 200 OK\r\n\r\nuntil the end", 5);
+  ASSERT_TRUE(to_eof.parser.IsHeaderComplete());
+  ASSERT_FALSE(to_eof.parser.IsComplete());
+  to_eof.parser.Finish();
+  ASSERT_TRUE(to_eof.parser.IsComplete());
+  ASSERT_EQ("until the end", to_eof.body);
+  ASSERT_FALSE(to_eof.parser.IsPersistent());
+
+  Response no_content;
+  ASSERT_EQ("next", no_content.Feed("HTTP/1.1 204 No Content\r\n\r\nnext", 64));
+  ASSERT_TRUE(no_content.parser.IsComplete());
+  ASSERT_EQ(0u, no_content.slices);
+
+  Response interim;
+  interim.Feed("HTTP/1.1 100 Continue\r\n\r\nHTTP/1.0 200 OK\r\nConnection: Keep-Alive\r\nContent-Length: 0\r\n\r\n", 64);
+  ASSERT_TRUE(interim.parser.IsComplete());
+  ASSERT_EQ((std::vector<int>{100, 200}), interim.status);
+  ASSERT_TRUE(interim.parser.IsPersistent());
+
+  Response close;
+  close.Feed("HTTP/1.1 200 OK\r\nConnection: foo, close\r\nContent-Length: 0\r\n\r\n", 64);
+  ASSERT_TRUE(close.parser.IsComplete());
+  ASSERT_FALSE(close.parser.IsPersistent());
+
+  Response truncated;
+  truncated.Feed("HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\nshort", 64);
+  ASSERT_THROW(truncated.parser.Finish(), std::runtime_error);
+
+  // The parser is reused for the next response on the connection
+  close.parser.Reset();
+  close.body.clear();
+  close.Feed("HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok", 64);
+  ASSERT_EQ("ok", close.body);
+  ASSERT_TRUE(close.parser.IsPersistent());
+}
+
+/**
+ * @test Malformed responses are rejected
+ */
+TEST(ResponseParser, Malformed) {
+  for (const char* bytes : {"HTTP/2 200 OK\r\n", "HTTP/1.1 2000 OK\r\n", "HTTP/1.1 200 OK\r\nno colon\r\n",
+                            "HTTP/1.1 200 OK\r\n: empty name\r\n", "HTTP/1.1 200 OK\r\nContent-Length: 1x\r\n",
+                            "HTTP/1.1 200 OK\r\nContent-Length: 99999999999999999999\r\n",
+                            "HTTP/1.1 200 OK\r\nContent-Length: 1\r\nContent-Length: 2\r\n"}) {
+    Response response;
+    ASSERT_THROW(response.Feed(bytes, 64), std::runtime_error) << bytes;
+  }
+
+  Response too_long;
+  ASSERT_THROW(too_long.Feed("HTTP/1.1 200 OK\r\nX: " + std::string(ResponseParser::kMaxLineSize, 'x'), 4096),
+               std::runtime_error);
+
+  // The fields of a response are bounded in number and in size, interim responses and trailers included
+  std::string many("HTTP/1.1 100 Continue\r\n");
+  for (size_t i = 0; i < ResponseParser::kMaxFields / 2; ++i) many += "X: 1\r\n";
+  many += "\r\nHTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n";
+  for (size_t i = 0; i < ResponseParser::kMaxFields / 2; ++i) many += "X: 1\r\n";
+  Response too_many;
+  ASSERT_THROW(too_many.Feed(many + "\r\n", 4096), std::runtime_error);
+
+  std::string large("HTTP/1.1 200 OK\r\n");
+  const std::string field = "X: " + std::string(ResponseParser::kMaxLineSize / 2, 'x') + "\r\n";
+  while (large.size() <= ResponseParser::kMaxHeaderSize) large += field;
+  Response too_large;
+  ASSERT_THROW(too_large.Feed(large + "\r\n", 4096), std::runtime_error);
+
+  // Reset() starts counting anew for the next response
+  too_large.parser.Reset();
+  ASSERT_EQ("", too_large.Feed("HTTP/1.1 200 OK\r\n" + field + "Content-Length: 0\r\n\r\n", 4096));
+  ASSERT_TRUE(too_large.parser.IsComplete());
+}
+
+/**
+ * @test Chunked bodies are decoded whatever the size of the pieces they arrive in, trailers are reported apart from
+ * the headers
+ */
+TEST(ResponseParser, Chunked) {
+  const std::string bytes(
+      "HTTP/1.1 200 OK\r\nTransfer-Encoding: identity, Chunked\r\nContent-Length: 3\r\n\r\n"
+      "5\r\nhello\r\n1;name=value\r\n \r\nA \r\n0123456789\r\n0\r\nX-Trailer: done\r\n\r\nnext");
+  for (size_t piece : {bytes.size(), size_t(1), size_t(3)}) {
+    Response response;
+    ASSERT_EQ("next", response.Feed(bytes, piece));
+    ASSERT_TRUE(response.parser.IsComplete());
+    ASSERT_EQ("hello 0123456789", response.body);
+    ASSERT_EQ(2u, response.headers.size());
+    ASSERT_EQ(1u, response.trailers.size());
+    ASSERT_EQ("X-Trailer", response.trailers[0].first);
+    ASSERT_EQ("done", response.trailers[0].second);
+    // Framed by the chunked coding here, an intermediary may have used the Content-Length
+    ASSERT_FALSE(response.parser.IsPersistent());
+  }
+
+  Response chunked;
+  ASSERT_EQ("", chunked.Feed("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n2\r\nok\r\n0\r\n\r\n", 64));
+  ASSERT_EQ("ok", chunked.body);
+  ASSERT_TRUE(chunked.trailers.empty());
+  ASSERT_TRUE(chunked.parser.IsPersistent());
+
+  // The data of a chunk is handed over as it arrives
+  Response partial;
+  partial.Feed("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n10\r\nsome", 64);
+  ASSERT_EQ("some", partial.body);
+  ASSERT_THROW(partial.parser.Finish(), std::runtime_error);
+
+  for (const char* malformed : {"HTTP/1.1 200 OK\r\nTransfer-Encoding: gzip\r\n",
+                                "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked, identity\r\n",
+                                "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nx\r\n",
+                                "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n11111111111111111\r\n",
+                                "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n1\r\nab\r\n"}) {
+    Response response;
+    ASSERT_THROW(response.Feed(malformed, 64), std::runtime_error) << malformed;
+  }
+}
+
+}  // namespace http
+}  // namespace client
+}  // namespace tcp
+}  // namespace protocol
+
+/// @endcond internal
@@ -0,0 +1,125 @@
+#pragma once
+/**
+ * @file   protocol/tcp/server/admission.hpp
+ * @brief  Class declaration of protocol::tcp::server::Admission
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
+#include <boost/asio/ip/address.hpp>
+
+#include <protocol/tcp/server/acceptor/config.hpp>
+#include <protocol/tcp/server/acceptor/stats.hpp>
+#include "protocol/tcp/server/ip_table.hpp"
+
+namespace protocol {
+namespace tcp {
+namespace server {
+
+/**
+ * Admission control of an Acceptor, shared by its listeners and by the sockets it handed over. A listener checks the
+ * limits before starting an accept, so that it stops accepting at the connection limit or above the accept rate
+ * instead of closing what it accepted, and reserves a slot once a connection is there, so that idle accepts don't
+ * hold slots other listeners need. The slot is released when the connection is rejected or its socket destroyed.
+ */
+class Admission {
+ public:
+  /**
+   * Outcome of a reservation
+   */
+  enum class Verdict {
+    kAdmit,      ///< A slot was reserved
+    kFull,       ///< max_connections is reached, Release() reports when to resume
+    kThrottled,  ///< The accept rate is exceeded, retry after the reported delay
+  };
+
+  /**
+   * Ctor
+   * @param config Acceptor configuration
+   */
+  explicit Admission(const acceptor::Config& config);
+
+  /**
+   * Check whether a connection could be reserved, without reserving it. A kFull verdict makes Release() report when
+   * to resume
+   * @param wait_ms Set to the delay before a token is available when throttled
+   * @return Verdict
+   */
+  Verdict Check(size_t* wait_ms);
+
+  /**
+   * Reserve a slot and an accept rate token for one connection
+   * @param wait_ms Set to the delay before a token is available when throttled. Null if the caller won't wait, the
+   *                throttling then isn't counted
+   * @return Verdict
+   */
+  Verdict Reserve(size_t* wait_ms);
+
+  /**
+   * Give back a reservation that didn't yield a connection
+   * @return True if the acceptor paused at max_connections and should resume
+   */
+  bool Cancel();
+
+  /**
+   * Check the source address of a reserved connection, cancels the reservation if the address reached its limit
+   * @param address Source address, unspecified for peers without one (Unix domain sockets), which aren't limited
+   * @param resume  Set to true if the connection is rejected while the acceptor paused at max_connections, which
+   *                should then resume
+   * @return True if the connection is admitted
+   */
+  bool Admit(const boost::asio::ip::address& address, bool& resume);
+
+  /**
+   * Release the slot of an admitted connection
+   * @param address Source address given to Admit()
+   * @return True if the acceptor paused at max_connections and should resume
+   */
+  bool Release(const boost::asio::ip::address& address);
+
+  /**
+   * Get the counters
+   * @return Counters
+   */
+  acceptor::Stats GetStats();
+
+ private:
+  using Clock = std::chrono::steady_clock;  ///< Clock of the token bucket
+
+  /**
+   * Add the tokens earned since the last refill
+   */
+  void Refill();
+
+  /**
+   * Apply the limits, mutex_ must be held
+   * @param wait_ms Set to the delay before a token is available when throttled, null if the caller won't wait
+   * @return Verdict
+   */
+  Verdict Limit(size_t* wait_ms);
+
+  /**
+   * Free a slot, mutex_ must be held
+   * @return True if the acceptor paused at max_connections and should resume
+   */
+  bool Free();
+
+  const size_t max_connections_;         ///< Most connections alive at once, 0 for no limit
+  const size_t max_connections_per_ip_;  ///< Most connections alive at once per address, 0 for no limit
+  const double rate_;                    ///< Tokens earned per second, 0 for no limit
+  const double burst_;                   ///< Most tokens held
+
+  std::mutex mutex_;        ///< Protects the members below
+  size_t reserved_;         ///< Slots taken by pending accepts and alive connections
+  bool full_;               ///< Whether a listener is waiting for a slot
+  double tokens_;           ///< Tokens left
+  Clock::time_point last_;  ///< Time of the last refill
+  IpTable addresses_;       ///< Alive connections per source address
+  acceptor::Stats stats_;   ///< Counters
+};
+
+}  // namespace server
+}  // namespace tcp
+}  // namespace protocol
@@ -0,0 +1,92 @@
+#pragma once
+/**
+ * @file   protocol/tcp/server/ip_table.hpp
+ * @brief  Class declaration of protocol::tcp::server::IpTable
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <boost/asio/ip/address.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace server {
+
+/**
+ * Number of connections per source address, in an open addressing hash table with linear probing. Entries are 20
+ * bytes stored inline and removed with backward shifting, so the table neither allocates per address nor fills up
+ * with tombstones under churn.
+ */
+class IpTable {
+ public:
+  using Key = std::array<uint8_t, 16>;  ///< IPv6 address, IPv4 addresses are mapped
+
+  /**
+   * Get the key of an address
+   * @param address IPv4 or IPv6 address
+   * @return Key
+   */
+  static Key MakeKey(const boost::asio::ip::address& address);
+
+  /**
+   * Default ctor
+   */
+  IpTable();
+
+  /**
+   * Count one more connection from an address
+   * @param key Address key
+   * @return Number of connections from the address, including this one
+   */
+  uint32_t Increment(const Key& key);
+
+  /**
+   * Count one connection less from an address, the address is removed when it has none left
+   * @param key Address key
+   */
+  void Decrement(const Key& key);
+
+  /**
+   * Get the number of connections from an address
+   * @param key Address key
+   * @return Number of connections
+   */
+  uint32_t Get(const Key& key) const;
+
+  /**
+   * Get the number of addresses with connections
+   * @return Number of addresses
+   */
+  size_t GetSize() const;
+
+ private:
+  /**
+   * A slot of the table, free when count is 0
+   */
+  struct Entry {
+    Key key;         ///< Address key
+    uint32_t count;  ///< Number of connections
+  };
+
+  /**
+   * Get the slot holding a key, or the free slot where it would be inserted
+   * @param key Address key
+   * @return Slot index
+   */
+  size_t Find(const Key& key) const;
+
+  /**
+   * Double the number of slots
+   */
+  void Grow();
+
+  std::vector<Entry> entries_;  ///< Slots, the count is a power of 2
+  size_t size_;                 ///< Number of used slots
+};
+
+}  // namespace server
+}  // namespace tcp
+}  // namespace protocol
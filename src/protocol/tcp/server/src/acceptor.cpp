@@ -3,13 +3,29 @@
  * @brief  Class definition of protocol::tcp::server::Acceptor
  */
 
-#include <iostream>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ip/v6_only.hpp>
+#include <boost/asio/socket_base.hpp>
 #include <boost/bind.hpp>
+#include <boost/system/system_error.hpp>
 #include <cppunit/extensions/HelperMacros.h>
 
+#include <protocol/log/log.hpp>
 #include <protocol/service/singleton.hpp>
 #include <protocol/tcp/server/acceptor.hpp>
+#include "protocol/tcp/server/admission.hpp"
 
 namespace protocol {
 namespace tcp {
@@ -19,41 +35,307 @@ namespace ba = boost::asio;
 namespace bs = boost::system;
 using ba::ip::tcp;
 
-Acceptor::Acceptor(uint16_t port, Callback on_new_client)
+namespace {
+
+#ifdef SO_REUSEPORT
+using ReusePort = ba::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;  ///< Share a port between sockets
+#endif
+
+/**
+ * Build a configuration holding the given socket options
+ * @param options Socket options
+ * @return Configuration
+ */
+acceptor::Config MakeConfig(const socket::Options& options) {
+  acceptor::Config config;
+  config.options = options;
+  return config;
+}
+
+}  // namespace
+
+Acceptor::Acceptor(uint16_t port, Callback on_new_client, const socket::Options& options)
+  : Acceptor(port, on_new_client, MakeConfig(options)) {
+}
+
+Acceptor::Acceptor(uint16_t port, Callback on_new_client, const acceptor::Config& config)
+  : Acceptor(tcp::endpoint(tcp::v4(), port), on_new_client, config) {
+}
+
+Acceptor::Acceptor(const socket::Endpoint& endpoint, Callback on_new_client, const acceptor::Config& config)
   : stopped_(false),
-    acceptor_(service::singleton::Instance(), tcp::endpoint(tcp::v4(), port)),
-    on_new_client_(on_new_client) {
-  socket::sock::Ptr sock_(new ba::ip::tcp::socket(acceptor_.get_io_service()));
-  acceptor_.async_accept(*sock_, boost::bind(&Acceptor::HandleAccept, this, _1, sock_));
+    listeners_(),
+    on_new_client_(on_new_client),
+    config_(config),
+    guard_(std::make_shared<Guard>()),
+    admission_(std::make_shared<Admission>(config)),
+    path_() {
+  Listen(endpoint);
 }
 
 Acceptor::~Acceptor() {
   if (!stopped_) Stop();
+  std::unique_lock<std::mutex> lock(guard_->mutex);
+  guard_->alive = false;
+  guard_->idle.wait(lock, [this]() { return 0 == guard_->running; });
+  if (!path_.empty()) ::unlink(path_.c_str());
+}
+
+void Acceptor::Listen(socket::Endpoint endpoint) {
+  const bool ip = socket::IsIp(endpoint);
+  const size_t workers = service::singleton::GetTopology().size();
+  const size_t count = config_.listeners ? config_.listeners : workers;
+  if (!ip && config_.listeners != 1) throw std::invalid_argument("A Unix domain socket takes a single listener");
+  if (count == 1) {
+    listeners_.emplace_back(new Listener(service::singleton::Instance(), -1));
+  } else {
+#ifndef SO_REUSEPORT
+    throw bs::system_error(ba::error::operation_not_supported, "SO_REUSEPORT");
+#endif
+    for (size_t i = 0; i < count; ++i) {
+      listeners_.emplace_back(
+          new Listener(service::singleton::Instance(i % workers), static_cast<int>(i % workers)));
+    }
+  }
+
+  // A socket file outlives the process that bound it and would make the bind fail. Only a socket nobody listens on
+  // any more, which refuses connections, is replaced. Abstract sockets, whose path starts with a null character,
+  // have no file
+  std::string path = socket::GetPath(endpoint);
+  if (!path.empty() && path[0] == '\0') path.clear();
+  struct stat info;
+  if (!path.empty() && ::stat(path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) {
+    socket::sock::Socket probe(listeners_.front()->acceptor.get_io_service());
+    bs::error_code ec;
+    probe.connect(endpoint, ec);
+    if (!ec) throw bs::system_error(ba::error::address_in_use, path);
+    if (ec == ba::error::connection_refused) ::unlink(path.c_str());
+  }
+
+  for (auto& listener : listeners_) {
+    Listening& acceptor = listener->acceptor;
+    acceptor.open(endpoint.protocol());
+    if (ip) acceptor.set_option(ba::socket_base::reuse_address(true));
+    if (endpoint.protocol().family() == AF_INET6) acceptor.set_option(ba::ip::v6_only(config_.v6_only));
+#ifdef SO_REUSEPORT
+    if (count > 1) acceptor.set_option(ReusePort(true));
+#endif
+    if (config_.options.send_buffer_size) {
+      acceptor.set_option(ba::socket_base::send_buffer_size(static_cast<int>(config_.options.send_buffer_size)));
+    }
+    if (config_.options.receive_buffer_size) {
+      acceptor.set_option(
+          ba::socket_base::receive_buffer_size(static_cast<int>(config_.options.receive_buffer_size)));
+    }
+    acceptor.bind(endpoint);
+    path_ = path;
+    acceptor.listen();
+    // Lets Drain() take the backlog without blocking, asynchronous accepts are unaffected
+    acceptor.non_blocking(true);
+    // An ephemeral port is chosen by the first bind, the other listeners join it
+    endpoint = acceptor.local_endpoint();
+  }
+
+  for (auto& listener : listeners_) {
+    Arm(*listener);
+  }
 }
 
 void Acceptor::Stop() {
-  if (stopped_) return;
+  if (stopped_.exchange(true)) return;
+
+  // Drain() accepts synchronously on the worker of each listener, so a listener is closed there, in between
+  std::vector<std::pair<ba::io_service *, std::future<void>>> closing;
+  for (auto &listener : listeners_) {
+    ba::io_service &service = listener->acceptor.get_io_service();
+    if (service::singleton::RunsInThisThread(service) || service.stopped()) {
+      Close(*listener);
+      continue;
+    }
+    auto closed = std::make_shared<std::promise<void>>();
+    closing.emplace_back(&service, closed->get_future());
+    Listener *target = listener.get();
+    service.post([target, closed]() {
+      Close(*target);
+      closed->set_value();
+    });
+  }
+  // A stopped io_service drops the handler, nothing then runs on the listener
+  for (auto &close : closing) {
+    while (close.second.wait_for(std::chrono::milliseconds(10)) != std::future_status::ready) {
+      if (close.first->stopped()) break;
+    }
+  }
+}
+
+void Acceptor::Close(Listener &listener) {
+  bs::error_code ec;
+  listener.throttle.cancel(ec);
+  listener.acceptor.cancel(ec);
+  if (listener.acceptor.is_open()) listener.acceptor.close(ec);
+  listener.parked.clear();
+}
+
+uint16_t Acceptor::GetPort() const {
+  return socket::GetPort(GetEndpoint());
+}
+
+socket::Endpoint Acceptor::GetEndpoint() const {
+  bs::error_code ec;
+  return listeners_.front()->acceptor.local_endpoint(ec);
+}
+
+size_t Acceptor::GetListeners() const {
+  return listeners_.size();
+}
 
-  stopped_ = true;
-  acceptor_.cancel();
-  if (acceptor_.is_open())
-    acceptor_.close();
+acceptor::Stats Acceptor::GetStats() const {
+  return admission_->GetStats();
 }
 
-void Acceptor::HandleAccept(const bs::error_code &ec, std::shared_ptr<ba::ip::tcp::socket> sock) {
+void Acceptor::HandleAccept(Listener &listener, const bs::error_code &ec, socket::sock::Ptr sock) {
+  --listener.pending;
   if (stopped_) return;
 
   if (ec) {
-    std::cout << "Error accepting connection: " << ec.message() << std::endl;
-    on_new_client_(ec, *this, sock);
-  } else {
+    PROTOCOL_LOG_WARNING("Error accepting connection: " << ec.message());
     on_new_client_(ec, *this, sock);
+    if (!stopped_) Arm(listener);
+    return;
   }
 
-  if (stopped_) return;
+  // Take the rest of the backlog and re-arm before handing over, so that accepting doesn't wait on the callbacks.
+  // The connection waits with the parked ones until admission control lets it through
+  listener.parked.push_back(sock);
+  Drain(listener);
+  Arm(listener);
+  HandOver(listener);
+}
+
+void Acceptor::Arm(Listener &listener) {
+  while (!stopped_ && !listener.throttled && listener.pending < std::max<size_t>(config_.pending_accepts, 1)) {
+    size_t wait_ms = 0;
+    const Admission::Verdict verdict = admission_->Check(&wait_ms);
+    if (verdict == Admission::Verdict::kFull) return;
+    if (verdict == Admission::Verdict::kThrottled) {
+      Throttle(listener, wait_ms);
+      return;
+    }
+    Accept(listener);
+  }
+}
+
+void Acceptor::Accept(Listener &listener) {
+  socket::sock::Ptr sock_(NewSocket(listener));
+  ++listener.pending;
+  listener.acceptor.async_accept(*sock_, boost::bind(&Acceptor::OnAccept, guard_, this, &listener, _1, sock_));
+}
+
+void Acceptor::Drain(Listener &listener) {
+  const size_t batch_size = std::max<size_t>(config_.accept_batch, 1);
+  while (!listener.parked.empty() && listener.batch.size() < batch_size) {
+    size_t wait_ms = 0;
+    const Admission::Verdict verdict = admission_->Reserve(&wait_ms);
+    if (verdict == Admission::Verdict::kThrottled && !listener.throttled) Throttle(listener, wait_ms);
+    if (verdict != Admission::Verdict::kAdmit) return;
+    listener.batch.push_back(listener.parked.front());
+    listener.parked.pop_front();
+  }
+
+  while (listener.batch.size() < batch_size) {
+    if (admission_->Reserve(nullptr) != Admission::Verdict::kAdmit) return;
+    socket::sock::Ptr sock_(NewSocket(listener));
+    bs::error_code ec;
+    listener.acceptor.accept(*sock_, ec);
+    if (ec) {
+      // would_block once the backlog is empty, other errors are left to the next asynchronous accept
+      if (admission_->Cancel()) Resume(guard_, this);
+      listener.spare = sock_;
+      return;
+    }
+    listener.batch.push_back(sock_);
+  }
+}
+
+void Acceptor::HandOver(Listener &listener) {
+  // Completions of a listener all run on its worker, so the batch isn't touched until the callbacks returned
+  for (auto& accepted : listener.batch) {
+    if (stopped_) break;
+    bs::error_code error;
+    socket::sock::Ptr admitted = Admit(accepted, error);
+    if (!error && !admitted) continue;
+    if (!error) error = socket::Apply(config_.options, *admitted);
+    if (error) PROTOCOL_LOG_WARNING("Error accepting connection: " << error.message());
+    on_new_client_(error, *this, admitted ? admitted : accepted);
+  }
+  listener.batch.clear();
+}
 
-  socket::sock::Ptr sock_(new ba::ip::tcp::socket(acceptor_.get_io_service()));
-  acceptor_.async_accept(*sock_, boost::bind(&Acceptor::HandleAccept, this, _1, sock_));
+void Acceptor::Throttle(Listener &listener, size_t wait_ms) {
+  listener.throttled = true;
+  listener.throttle.expires_from_now(std::chrono::milliseconds(wait_ms));
+  listener.throttle.async_wait(boost::bind(&Acceptor::OnResume, guard_, this, &listener, true));
+}
+
+socket::sock::Ptr Acceptor::NewSocket(Listener &listener) {
+  socket::sock::Ptr sock_;
+  sock_.swap(listener.spare);
+  if (sock_) return sock_;
+  return listener.worker < 0 ? service::singleton::NewSocket()
+                             : service::singleton::NewSocket(static_cast<size_t>(listener.worker));
+}
+
+socket::sock::Ptr Acceptor::Admit(const socket::sock::Ptr &sock, bs::error_code &ec) {
+  // Unix domain socket peers have no address, which leaves them out of the per address limit
+  const ba::ip::address address = socket::GetAddress(sock->remote_endpoint(ec));
+  if (ec) {
+    if (admission_->Cancel()) Resume(guard_, this);
+    return socket::sock::Ptr();
+  }
+  bool resume = false;
+  if (!admission_->Admit(address, resume)) {
+    if (resume) Resume(guard_, this);
+    return socket::sock::Ptr();
+  }
+
+  // The handed over pointer shares the socket and releases its slot once the last reference is dropped
+  std::shared_ptr<Guard> guard = guard_;
+  std::shared_ptr<Admission> admission = admission_;
+  Acceptor *self = this;
+  socket::sock::Ptr owner = sock;
+  return socket::sock::Ptr(sock.get(), [guard, admission, self, owner, address](socket::sock::Socket *) mutable {
+    owner.reset();
+    if (admission->Release(address)) Resume(guard, self);
+  });
+}
+
+void Acceptor::OnAccept(const std::shared_ptr<Guard> &guard, Acceptor *acceptor, Listener *listener,
+                        const bs::error_code &ec, socket::sock::Ptr sock) {
+  if (!guard->Enter()) return;
+  acceptor->HandleAccept(*listener, ec, sock);
+  guard->Leave();
+}
+
+void Acceptor::OnResume(const std::shared_ptr<Guard> &guard, Acceptor *acceptor, Listener *listener, bool expired) {
+  if (!guard->Enter()) return;
+  if (expired) listener->throttled = false;
+  if (!acceptor->stopped_ && !listener->parked.empty()) {
+    acceptor->Drain(*listener);
+    acceptor->Arm(*listener);
+    acceptor->HandOver(*listener);
+  } else {
+    acceptor->Arm(*listener);
+  }
+  guard->Leave();
+}
+
+void Acceptor::Resume(const std::shared_ptr<Guard> &guard, Acceptor *acceptor) {
+  // Holding the guard keeps the acceptor from being destroyed while its listeners are read
+  std::lock_guard<std::mutex> lock(guard->mutex);
+  if (!guard->alive) return;
+  for (auto &listener : acceptor->listeners_) {
+    listener->acceptor.get_io_service().post(boost::bind(&Acceptor::OnResume, guard, acceptor, listener.get(), false));
+  }
 }
 
 }  // namespace server
@@ -0,0 +1,110 @@
+/**
+ * @file   protocol/tcp/server/src/admission.cpp
+ * @brief  Class definition of protocol::tcp::server::Admission
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "protocol/tcp/server/admission.hpp"
+
+namespace protocol {
+namespace tcp {
+namespace server {
+
+Admission::Admission(const acceptor::Config& config)
+  : max_connections_(config.max_connections),
+    max_connections_per_ip_(config.max_connections_per_ip),
+    rate_(config.accept_rate > 0 ? config.accept_rate : 0),
+    burst_(config.accept_burst ? static_cast<double>(config.accept_burst) : std::max(rate_, 1.0)),
+    reserved_(0),
+    full_(false),
+    tokens_(burst_),
+    last_(Clock::now()),
+    addresses_(),
+    stats_{0, 0, 0, 0, 0} {
+}
+
+Admission::Verdict Admission::Check(size_t* wait_ms) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return Limit(wait_ms);
+}
+
+Admission::Verdict Admission::Reserve(size_t* wait_ms) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const Verdict verdict = Limit(wait_ms);
+  if (Verdict::kAdmit != verdict) return verdict;
+  if (rate_) tokens_ -= 1;
+  ++reserved_;
+  return Verdict::kAdmit;
+}
+
+bool Admission::Cancel() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (rate_) tokens_ = std::min(tokens_ + 1, burst_);
+  return Free();
+}
+
+bool Admission::Admit(const boost::asio::ip::address& address, bool& resume) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (max_connections_per_ip_ && !address.is_unspecified() &&
+      addresses_.Increment(IpTable::MakeKey(address)) > max_connections_per_ip_) {
+    addresses_.Decrement(IpTable::MakeKey(address));
+    ++stats_.rejected;
+    resume = Free();
+    return false;
+  }
+  ++stats_.accepted;
+  ++stats_.active;
+  resume = false;
+  return true;
+}
+
+bool Admission::Release(const boost::asio::ip::address& address) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (max_connections_per_ip_ && !address.is_unspecified()) addresses_.Decrement(IpTable::MakeKey(address));
+  --stats_.active;
+  return Free();
+}
+
+acceptor::Stats Admission::GetStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void Admission::Refill() {
+  const Clock::time_point now = Clock::now();
+  const double elapsed = std::chrono::duration<double>(now - last_).count();
+  tokens_ = std::min(tokens_ + elapsed * rate_, burst_);
+  last_ = now;
+}
+
+Admission::Verdict Admission::Limit(size_t* wait_ms) {
+  if (max_connections_ && reserved_ >= max_connections_) {
+    if (!full_) ++stats_.paused;
+    full_ = true;
+    return Verdict::kFull;
+  }
+  if (rate_) {
+    Refill();
+    if (tokens_ < 1) {
+      if (wait_ms) {
+        ++stats_.throttled;
+        *wait_ms = static_cast<size_t>(std::ceil((1 - tokens_) * 1000 / rate_));
+      }
+      return Verdict::kThrottled;
+    }
+  }
+  return Verdict::kAdmit;
+}
+
+bool Admission::Free() {
+  --reserved_;
+  if (!full_) return false;
+  full_ = false;
+  return true;
+}
+
+}  // namespace server
+}  // namespace tcp
+}  // namespace protocol
@@ -0,0 +1,102 @@
+/**
+ * @file   protocol/tcp/server/src/ip_table.cpp
+ * @brief  Class definition of protocol::tcp::server::IpTable
+ */
+
+#include <cstring>
+#include <utility>
+
+#include "protocol/tcp/server/ip_table.hpp"
+
+namespace protocol {
+namespace tcp {
+namespace server {
+
+namespace {
+
+const size_t kInitialSlots = 64;  ///< Slots of an empty table
+
+/**
+ * Hash a key, FNV-1a over its 16 bytes
+ * @param key Address key
+ * @return Hash
+ */
+size_t Hash(const IpTable::Key& key) {
+  uint64_t hash = 14695981039346656037ull;
+  for (uint8_t byte : key) {
+    hash ^= byte;
+    hash *= 1099511628211ull;
+  }
+  return static_cast<size_t>(hash ^ (hash >> 32));
+}
+
+}  // namespace
+
+IpTable::Key IpTable::MakeKey(const boost::asio::ip::address& address) {
+  const boost::asio::ip::address_v6 v6 = address.is_v4()
+      ? boost::asio::ip::address_v6::v4_mapped(address.to_v4())
+      : address.to_v6();
+  const auto bytes = v6.to_bytes();
+  Key key;
+  std::memcpy(key.data(), bytes.data(), key.size());
+  return key;
+}
+
+IpTable::IpTable() : entries_(kInitialSlots, Entry{Key(), 0}), size_(0) {
+}
+
+uint32_t IpTable::Increment(const Key& key) {
+  // Kept at most half full so that probe sequences stay short
+  if ((size_ + 1) * 2 > entries_.size()) Grow();
+  Entry& entry = entries_[Find(key)];
+  if (!entry.count) {
+    entry.key = key;
+    ++size_;
+  }
+  return ++entry.count;
+}
+
+void IpTable::Decrement(const Key& key) {
+  size_t hole = Find(key);
+  if (!entries_[hole].count || --entries_[hole].count) return;
+
+  // Shift back the entries whose probe sequence went through the freed slot
+  --size_;
+  const size_t mask = entries_.size() - 1;
+  for (size_t next = (hole + 1) & mask; entries_[next].count; next = (next + 1) & mask) {
+    const size_t home = Hash(entries_[next].key) & mask;
+    // Movable if its home slot isn't cyclically within (hole, next]
+    if (((next - home) & mask) >= ((next - hole) & mask)) {
+      entries_[hole] = entries_[next];
+      entries_[next].count = 0;
+      hole = next;
+    }
+  }
+}
+
+uint32_t IpTable::Get(const Key& key) const {
+  return entries_[Find(key)].count;
+}
+
+size_t IpTable::GetSize() const {
+  return size_;
+}
+
+size_t IpTable::Find(const Key& key) const {
+  const size_t mask = entries_.size() - 1;
+  size_t slot = Hash(key) & mask;
+  while (entries_[slot].count && entries_[slot].key != key) slot = (slot + 1) & mask;
+  return slot;
+}
+
+void IpTable::Grow() {
+  std::vector<Entry> old(entries_.size() * 2, Entry{Key(), 0});
+  old.swap(entries_);
+  for (const Entry& entry : old) {
+    if (entry.count) entries_[Find(entry.key)] = entry;
+  }
+}
+
+}  // namespace server
+}  // namespace tcp
+}  // namespace protocol
@@ -5,14 +5,22 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <future>
 #include <iostream>
+#include <mutex>
+#include <set>
 #include <thread>
+#include <vector>
 
+#include <boost/asio/ip/tcp.hpp>
 #include <boost/system/system_error.hpp>
 #include <gtest/gtest.h>
 
+#include <protocol/service/singleton.hpp>
 #include <protocol/tcp/server/acceptor.hpp>
+#include <protocol/tcp/socket/endpoint.hpp>
 #include "protocol/utility/get_available_port.hpp"
 
 namespace protocol {
@@ -67,6 +75,221 @@ TEST(Acceptor, BindError) {
   }}), boost::exception);
 }
 
+/**
+ * @test Several listeners share one port, the kernel spreads connections over them and each one hands over sockets
+ * bound to its own worker
+ */
+TEST(Acceptor, ReusePort) {
+  // As many workers as listeners whatever the machine, so that the io_service of a socket tells its listener
+  service::Config pool;
+  pool.num_threads = 4;
+  service::singleton::TearDown();
+  service::singleton::Configure(pool);
+
+  const size_t kConnections = 64;
+  acceptor::Config config;
+  config.listeners = 4;
+
+  std::mutex mutex;
+  std::set<ba::io_service *> services;
+  std::vector<socket::sock::Ptr> accepted;
+  {
+    std::promise<void> done;
+    Acceptor acceptor(0, {[&](bs::error_code ec, Acceptor &acceptor, socket::sock::Ptr sock) {
+      ASSERT_FALSE(ec);
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        services.insert(&sock->get_io_service());
+        accepted.push_back(sock);
+        if (accepted.size() < kConnections) return;
+      }
+      acceptor.Stop();
+      done.set_value();
+    }}, config);
+    ASSERT_EQ(4u, acceptor.GetListeners());
+    ASSERT_NE(0, acceptor.GetPort());
+
+    ba::io_service service;
+    std::vector<ba::ip::tcp::socket> clients;
+    for (size_t i = 0; i < kConnections; ++i) {
+      clients.emplace_back(service);
+      clients.back().connect(ba::ip::tcp::endpoint(ba::ip::address_v4::loopback(), acceptor.GetPort()));
+    }
+    ASSERT_EQ(std::future_status::ready, done.get_future().wait_for(sc::seconds(10)));
+  }
+
+  // The listener of a connection is picked from a hash of its addresses, all of them landing on one is unlikely
+  ASSERT_EQ(kConnections, accepted.size());
+  ASSERT_LT(1u, services.size());
+  accepted.clear();
+  service::singleton::Configure(service::Config());
+  service::singleton::TearDown();
+}
+
+/**
+ * @test Connections waiting in the backlog are taken in batches by several outstanding accepts, a batch of 0 takes
+ * them one at a time
+ */
+TEST(Acceptor, Backlog) {
+  const size_t kConnections = 100;
+  for (const size_t batch : {8, 0}) {
+    acceptor::Config config;
+    config.pending_accepts = 4;
+    config.accept_batch = batch;
+
+    std::atomic<size_t> accepted(0);
+    std::promise<void> done;
+    Acceptor acceptor(0, {[&](bs::error_code ec, Acceptor &acceptor, socket::sock::Ptr sock) {
+      ASSERT_FALSE(ec);
+      ASSERT_TRUE(sock->is_open());
+      if (++accepted == kConnections) {
+        acceptor.Stop();
+        done.set_value();
+      }
+    }}, config);
+
+    ba::io_service service;
+    std::vector<ba::ip::tcp::socket> clients;
+    for (size_t i = 0; i < kConnections; ++i) {
+      clients.emplace_back(service);
+      clients.back().connect(ba::ip::tcp::endpoint(ba::ip::address_v4::loopback(), acceptor.GetPort()));
+    }
+    ASSERT_EQ(std::future_status::ready, done.get_future().wait_for(sc::seconds(10)));
+    ASSERT_EQ(kConnections, accepted.load());
+  }
+}
+
+/**
+ * @test Accepting pauses at max_connections and resumes once a handed over socket is released
+ */
+TEST(Acceptor, MaxConnections) {
+  acceptor::Config config;
+  config.max_connections = 2;
+  config.max_connections_per_ip = 1;
+  config.pending_accepts = 4;
+
+  std::mutex mutex;
+  std::vector<socket::sock::Ptr> accepted;
+  Acceptor acceptor(0, {[&](bs::error_code ec, Acceptor &, socket::sock::Ptr sock) {
+    ASSERT_FALSE(ec);
+    std::lock_guard<std::mutex> lock(mutex);
+    accepted.push_back(sock);
+  }}, config);
+  const auto count = [&]() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return accepted.size();
+  };
+  const auto wait_for = [&](size_t expected) {
+    for (int i = 0; i < 1000 && count() < expected; ++i) std::this_thread::sleep_for(sc::milliseconds(1));
+    return count();
+  };
+
+  // Loopback clients all come from 127.0.0.1, so the per address limit is lifted through a second address
+  ba::io_service service;
+  std::vector<ba::ip::tcp::socket> clients;
+  for (size_t i = 0; i < 3; ++i) {
+    clients.emplace_back(service);
+    clients.back().open(ba::ip::tcp::v4());
+    clients.back().bind(ba::ip::tcp::endpoint(ba::ip::address_v4((127u << 24) | (i + 1)), 0));
+    clients.back().connect(ba::ip::tcp::endpoint(ba::ip::address_v4::loopback(), acceptor.GetPort()));
+  }
+  ASSERT_EQ(2u, wait_for(2));
+  std::this_thread::sleep_for(sc::milliseconds(50));
+  ASSERT_EQ(2u, count());
+  ASSERT_EQ(1u, acceptor.GetStats().paused);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    accepted.erase(accepted.begin());
+  }
+  ASSERT_EQ(2u, wait_for(2));
+  auto stats = acceptor.GetStats();
+  ASSERT_EQ(3u, stats.accepted);
+  ASSERT_EQ(2u, stats.active);
+
+  // A second connection from an address already connected is closed right away
+  ba::ip::address connected;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    accepted.pop_back();
+    connected = socket::GetAddress(accepted.front()->remote_endpoint());
+  }
+  clients.emplace_back(service);
+  clients.back().open(ba::ip::tcp::v4());
+  clients.back().bind(ba::ip::tcp::endpoint(connected, 0));
+  clients.back().connect(ba::ip::tcp::endpoint(ba::ip::address_v4::loopback(), acceptor.GetPort()));
+  char byte;
+  bs::error_code ec;
+  clients.back().read_some(ba::buffer(&byte, 1), ec);
+  ASSERT_EQ(ba::error::eof, ec);
+  ASSERT_EQ(1u, acceptor.GetStats().rejected);
+  acceptor.Stop();
+}
+
+/**
+ * @test Outstanding accepts hold no slot, so that listeners beyond max_connections / pending_accepts still hand over
+ * the connections the kernel gives them
+ */
+TEST(Acceptor, ReusePortMaxConnections) {
+  service::Config pool;
+  pool.num_threads = 4;
+  service::singleton::TearDown();
+  service::singleton::Configure(pool);
+
+  const size_t kConnections = 64;
+  acceptor::Config config;
+  config.listeners = 4;
+  config.pending_accepts = 4;
+  config.max_connections = 2;
+
+  std::atomic<size_t> accepted(0);
+  {
+    std::promise<void> done;
+    Acceptor acceptor(0, {[&](bs::error_code ec, Acceptor &, socket::sock::Ptr) {
+      ASSERT_FALSE(ec);
+      if (++accepted == kConnections) done.set_value();
+    }}, config);
+
+    ba::io_service service;
+    std::vector<ba::ip::tcp::socket> clients;
+    for (size_t i = 0; i < kConnections; ++i) {
+      clients.emplace_back(service);
+      clients.back().connect(ba::ip::tcp::endpoint(ba::ip::address_v4::loopback(), acceptor.GetPort()));
+    }
+    ASSERT_EQ(std::future_status::ready, done.get_future().wait_for(sc::seconds(10)));
+    ASSERT_EQ(0u, acceptor.GetStats().active);
+    acceptor.Stop();
+  }
+
+  ASSERT_EQ(kConnections, accepted.load());
+  service::singleton::Configure(service::Config());
+  service::singleton::TearDown();
+}
+
+/**
+ * @test An acceptor destroyed while connections complete on its workers doesn't call back or touch freed memory
+ */
+TEST(Acceptor, DestroyWhileAccepting) {
+  ba::io_service service;
+  for (int round = 0; round < 50; ++round) {
+    std::atomic<bool> destroyed(false);
+    std::atomic<bool> late(false);
+    std::vector<ba::ip::tcp::socket> clients;
+    {
+      Acceptor acceptor(0, {[&](bs::error_code, Acceptor &, socket::sock::Ptr) {
+        if (destroyed) late = true;
+      }});
+      for (int i = 0; i < 4; ++i) {
+        clients.emplace_back(service);
+        clients.back().connect(ba::ip::tcp::endpoint(ba::ip::address_v4::loopback(), acceptor.GetPort()));
+      }
+    }
+    destroyed = true;
+    std::this_thread::sleep_for(sc::milliseconds(1));
+    ASSERT_FALSE(late);
+  }
+}
+
 }  // namespace server
 }  // namespace tcp
 }  // namespace protocol
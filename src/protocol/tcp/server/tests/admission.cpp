@@ -0,0 +1,156 @@
+/**
+ * @cond   internal
+ * @file   protocol/tcp/server/tests/admission.cpp
+ * @brief  Unit tests for protocol::tcp::server::Admission and protocol::tcp::server::IpTable
+ */
+
+#include <cstdlib>
+#include <map>
+
+#include <boost/asio/ip/address.hpp>
+#include <gtest/gtest.h>
+
+#include "protocol/tcp/server/admission.hpp"
+#include "protocol/tcp/server/ip_table.hpp"
+
+namespace protocol {
+namespace tcp {
+namespace server {
+
+namespace ba = boost::asio;
+
+/**
+ * @test Counts follow a reference map through growth and backward shift deletions
+ */
+TEST(IpTable, Churn) {
+  ASSERT_EQ(IpTable::MakeKey(ba::ip::address::from_string("10.0.0.1")),
+            IpTable::MakeKey(ba::ip::address::from_string("::ffff:10.0.0.1")));
+
+  IpTable table;
+  std::map<IpTable::Key, uint32_t> expected;
+  std::srand(7);
+  for (int i = 0; i < 20000; ++i) {
+    const IpTable::Key key = IpTable::MakeKey(ba::ip::address_v4(static_cast<uint32_t>(std::rand() % 300)));
+    if (std::rand() % 3 && expected[key]) {
+      table.Decrement(key);
+      if (!--expected[key]) expected.erase(key);
+    } else {
+      ASSERT_EQ(++expected[key], table.Increment(key));
+    }
+  }
+  ASSERT_EQ(expected.size(), table.GetSize());
+  for (const auto& entry : expected) ASSERT_EQ(entry.second, table.Get(entry.first));
+}
+
+/**
+ * @test Reservations stop at max_connections and resume once a connection is released
+ */
+TEST(Admission, MaxConnections) {
+  acceptor::Config config;
+  config.max_connections = 2;
+  Admission admission(config);
+  const auto address = ba::ip::address::from_string("10.0.0.1");
+
+  size_t wait_ms = 0;
+  bool resume = true;
+  ASSERT_EQ(Admission::Verdict::kAdmit, admission.Reserve(&wait_ms));
+  ASSERT_EQ(Admission::Verdict::kAdmit, admission.Reserve(&wait_ms));
+  ASSERT_EQ(Admission::Verdict::kFull, admission.Reserve(&wait_ms));
+  ASSERT_TRUE(admission.Admit(address, resume));
+  ASSERT_FALSE(resume);
+  ASSERT_TRUE(admission.Admit(address, resume));
+  ASSERT_TRUE(admission.Release(address));
+  ASSERT_FALSE(admission.Release(address));
+  ASSERT_EQ(Admission::Verdict::kAdmit, admission.Reserve(&wait_ms));
+  admission.Cancel();
+
+  const auto stats = admission.GetStats();
+  ASSERT_EQ(2u, stats.accepted);
+  ASSERT_EQ(0u, stats.active);
+  ASSERT_EQ(1u, stats.paused);
+}
+
+/**
+ * @test Giving back a reservation at max_connections, cancelled or rejected, reports that accepting should resume
+ */
+TEST(Admission, Resume) {
+  acceptor::Config config;
+  config.max_connections = 2;
+  config.max_connections_per_ip = 1;
+  Admission admission(config);
+  const auto address = ba::ip::address::from_string("10.0.0.1");
+
+  // Checking reserves nothing
+  size_t wait_ms = 0;
+  bool resume = false;
+  ASSERT_EQ(Admission::Verdict::kAdmit, admission.Check(&wait_ms));
+  ASSERT_EQ(Admission::Verdict::kAdmit, admission.Reserve(&wait_ms));
+  ASSERT_TRUE(admission.Admit(address, resume));
+  ASSERT_EQ(Admission::Verdict::kAdmit, admission.Reserve(&wait_ms));
+  ASSERT_FALSE(admission.Cancel());
+
+  ASSERT_EQ(Admission::Verdict::kAdmit, admission.Reserve(&wait_ms));
+  ASSERT_EQ(Admission::Verdict::kFull, admission.Check(&wait_ms));
+  ASSERT_TRUE(admission.Cancel());
+
+  ASSERT_EQ(Admission::Verdict::kAdmit, admission.Reserve(&wait_ms));
+  ASSERT_EQ(Admission::Verdict::kFull, admission.Reserve(&wait_ms));
+  ASSERT_FALSE(admission.Admit(address, resume));
+  ASSERT_TRUE(resume);
+  ASSERT_EQ(Admission::Verdict::kAdmit, admission.Check(&wait_ms));
+}
+
+/**
+ * @test Connections above the per address limit are rejected without affecting other addresses
+ */
+TEST(Admission, PerAddress) {
+  acceptor::Config config;
+  config.max_connections_per_ip = 1;
+  Admission admission(config);
+  const auto first = ba::ip::address::from_string("10.0.0.1");
+  const auto second = ba::ip::address::from_string("fe80::1");
+
+  size_t wait_ms = 0;
+  bool resume = false;
+  for (int i = 0; i < 3; ++i) admission.Reserve(&wait_ms);
+  ASSERT_TRUE(admission.Admit(first, resume));
+  ASSERT_FALSE(admission.Admit(first, resume));
+  ASSERT_TRUE(admission.Admit(second, resume));
+  admission.Release(first);
+  ASSERT_EQ(Admission::Verdict::kAdmit, admission.Reserve(&wait_ms));
+  ASSERT_TRUE(admission.Admit(first, resume));
+
+  const auto stats = admission.GetStats();
+  ASSERT_EQ(3u, stats.accepted);
+  ASSERT_EQ(2u, stats.active);
+  ASSERT_EQ(1u, stats.rejected);
+}
+
+/**
+ * @test The token bucket lets a burst through, then reports how long to wait
+ */
+TEST(Admission, Rate) {
+  acceptor::Config config;
+  config.accept_rate = 10;
+  config.accept_burst = 2;
+  Admission admission(config);
+
+  size_t wait_ms = 0;
+  ASSERT_EQ(Admission::Verdict::kAdmit, admission.Reserve(&wait_ms));
+  ASSERT_EQ(Admission::Verdict::kAdmit, admission.Reserve(&wait_ms));
+  ASSERT_EQ(Admission::Verdict::kThrottled, admission.Reserve(nullptr));
+  ASSERT_EQ(Admission::Verdict::kThrottled, admission.Reserve(&wait_ms));
+  ASSERT_LT(0u, wait_ms);
+  ASSERT_GE(100u, wait_ms);
+  ASSERT_EQ(1u, admission.GetStats().throttled);
+
+  // A cancelled reservation gives its token back
+  admission.Cancel();
+  ASSERT_EQ(Admission::Verdict::kAdmit, admission.Reserve(&wait_ms));
+}
+
+}  // namespace server
+}  // namespace tcp
+}  // namespace protocol
+
+/// @endcond internal
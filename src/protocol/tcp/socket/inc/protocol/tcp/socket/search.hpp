@@ -0,0 +1,67 @@
+#pragma once
+/**
+ * @file   protocol/tcp/socket/search.hpp
+ * @brief  Free method declarations for substring search in contiguous memory
+ */
+
+#include <cstddef>
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+namespace search {
+
+using FindFn = const char* (*)(const char*, const char*, const char*, size_t);  ///< Find() implementation type
+
+/**
+ * Find the first occurrence of a token, using the fastest implementation the CPU supports
+ * @param begin Start of the searched memory
+ * @param end   End of the searched memory
+ * @param token Token to find
+ * @param size  Token size, must not be 0
+ * @return Pointer to the first occurrence or end if none
+ */
+const char* Find(const char* begin, const char* end, const char* token, size_t size);
+
+/**
+ * Portable implementation of Find()
+ * @param begin Start of the searched memory
+ * @param end   End of the searched memory
+ * @param token Token to find
+ * @param size  Token size, must not be 0
+ * @return Pointer to the first occurrence or end if none
+ */
+const char* FindScalar(const char* begin, const char* end, const char* token, size_t size);
+
+/**
+ * SSE2 implementation of Find(), compares the first and last token bytes 16 positions at a time. Falls back to
+ * FindScalar() where SSE2 isn't available at compile time
+ * @param begin Start of the searched memory
+ * @param end   End of the searched memory
+ * @param token Token to find
+ * @param size  Token size, must not be 0
+ * @return Pointer to the first occurrence or end if none
+ */
+const char* FindSse2(const char* begin, const char* end, const char* token, size_t size);
+
+/**
+ * AVX2 implementation of Find(), compares the first and last token bytes 32 positions at a time. Must only be called
+ * if HasAvx2() is true
+ * @param begin Start of the searched memory
+ * @param end   End of the searched memory
+ * @param token Token to find
+ * @param size  Token size, must not be 0
+ * @return Pointer to the first occurrence or end if none
+ */
+const char* FindAvx2(const char* begin, const char* end, const char* token, size_t size);
+
+/**
+ * Check whether the CPU supports FindAvx2()
+ * @return True if supported
+ */
+bool HasAvx2();
+
+}  // namespace search
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
@@ -0,0 +1,32 @@
+#pragma once
+/**
+ * @file   protocol/tcp/socket/socket_pair.hpp
+ * @brief  Connected pair of loopback sockets
+ */
+
+#include <boost/asio/io_service.hpp>
+
+#include <protocol/tcp/socket/ptr.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+
+/**
+ * Two TCP sockets connected to each other over the loopback interface
+ */
+struct SocketPair {
+  /**
+   * Connect the sockets synchronously
+   * @param service Service the sockets run on
+   * @throws boost::system::system_error
+   */
+  explicit SocketPair(boost::asio::io_service& service);
+
+  sock::Ptr client;  ///< Connecting side
+  sock::Ptr server;  ///< Accepting side
+};
+
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
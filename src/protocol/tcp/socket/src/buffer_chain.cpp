@@ -0,0 +1,65 @@
+/**
+ * @file   protocol/tcp/socket/src/buffer_chain.cpp
+ * @brief  Class definition of protocol::tcp::socket::BufferChain
+ */
+
+#include <stdexcept>
+#include <utility>
+
+#include <protocol/tcp/socket/buffer.hpp>
+#include <protocol/tcp/socket/buffer_chain.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+
+namespace ba = boost::asio;
+
+buffer_chain::Ptr BufferChain::Create() {
+  return buffer_chain::Ptr(new BufferChain());
+}
+
+BufferChain& BufferChain::Append(const void* data, size_t size, Owner owner) {
+  if (!size) return *this;
+  buffers_.push_back(ba::const_buffer(data, size));
+  if (owner) owners_.push_back(std::move(owner));
+  size_ += size;
+  return *this;
+}
+
+BufferChain& BufferChain::Append(const buffer::Ptr& buffer) {
+  if (!buffer) throw std::invalid_argument("Buffer can't be null");
+  const auto data = (**buffer).data();
+  for (auto it = data.begin(); it != data.end(); ++it) {
+    Append(ba::buffer_cast<const void*>(*it), ba::buffer_size(*it));
+  }
+  owners_.push_back(buffer);
+  return *this;
+}
+
+BufferChain& BufferChain::Append(const boost::shared_ptr<const std::string>& str) {
+  if (!str) throw std::invalid_argument("String can't be null");
+  return Append(str->data(), str->size(), str);
+}
+
+void BufferChain::Clear() {
+  buffers_.clear();
+  owners_.clear();
+  size_ = 0;
+}
+
+BufferChain::ConstBuffers BufferChain::GetBuffers() const {
+  return ConstBuffers(buffers_);
+}
+
+size_t BufferChain::GetCount() const {
+  return buffers_.size();
+}
+
+size_t BufferChain::GetSize() const {
+  return size_;
+}
+
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
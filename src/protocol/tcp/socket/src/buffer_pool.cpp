@@ -0,0 +1,163 @@
+/**
+ * @file   protocol/tcp/socket/src/buffer_pool.cpp
+ * @brief  Class definition of protocol::tcp::socket::BufferPool
+ */
+
+#include <atomic>
+#include <vector>
+
+#include <protocol/tcp/socket/buffer.hpp>
+#include <protocol/tcp/socket/buffer_pool.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+
+const size_t BufferPool::kClassSizes[BufferPool::kNumClasses] = {512, 4096, 65536, 1048576};
+
+namespace {
+
+std::atomic<size_t> capacity(64);  ///< Maximum number of buffers per thread and size class
+std::atomic<size_t> hits(0);       ///< Acquisitions served from a free list
+std::atomic<size_t> misses(0);     ///< Acquisitions that created a Buffer
+std::atomic<size_t> recycled(0);   ///< Releases that went back to a free list
+std::atomic<size_t> dropped(0);    ///< Releases that destroyed the Buffer
+
+/**
+ * Free lists of one thread
+ */
+struct Cache {
+  std::vector<Buffer*> lists[BufferPool::kNumClasses];  ///< One free list per size class
+
+  /**
+   * Dtor, destroys the kept buffers
+   */
+  ~Cache();
+
+  /**
+   * Destroy the kept buffers
+   */
+  void Clear() {
+    for (auto& list : lists) {
+      for (Buffer* buffer : list) delete buffer;
+      list.clear();
+    }
+  }
+};
+
+thread_local bool cache_destroyed = false;  ///< Buffers released during thread exit can't be recycled
+
+Cache::~Cache() {
+  Clear();
+  cache_destroyed = true;
+}
+
+/**
+ * Get the free lists of the calling thread
+ * @return The free lists
+ */
+Cache& GetCache() {
+  thread_local Cache cache;
+  return cache;
+}
+
+/**
+ * Get the smallest size class that holds a number of bytes
+ * @param size Number of bytes
+ * @return Size class index, kNumClasses if none does
+ */
+size_t GetSizeClass(size_t size) {
+  size_t size_class = 0;
+  while (size_class < BufferPool::kNumClasses && BufferPool::kClassSizes[size_class] < size) ++size_class;
+  return size_class;
+}
+
+/**
+ * Get the largest size class a buffer's storage holds, so that any buffer in a free list holds its class size
+ * @param capacity Storage size
+ * @return Size class index, kNumClasses if the storage is smaller than the first class or larger than the last one
+ */
+size_t GetStorageClass(size_t capacity) {
+  if (capacity > BufferPool::kClassSizes[BufferPool::kNumClasses - 1]) return BufferPool::kNumClasses;
+  size_t size_class = BufferPool::kNumClasses;
+  while (size_class > 0 && BufferPool::kClassSizes[size_class - 1] > capacity) --size_class;
+  return size_class ? size_class - 1 : BufferPool::kNumClasses;
+}
+
+/**
+ * shared_ptr deleter that hands the Buffer back to the pool
+ */
+struct Recycle {
+  /**
+   * Return a buffer to the free list of the calling thread
+   * @param buffer Buffer being released
+   */
+  void operator()(Buffer* buffer) const {
+    // The content size says nothing of the storage a reset buffer keeps
+    const size_t index = GetStorageClass(buffer->GetCapacity());
+    if (cache_destroyed || index == BufferPool::kNumClasses) {
+      ++dropped;
+      delete buffer;
+      return;
+    }
+
+    std::vector<Buffer*>& list = GetCache().lists[index];
+    if (list.size() >= capacity) {
+      ++dropped;
+      delete buffer;
+      return;
+    }
+
+    buffer->Reset();
+    buffer->GetIStream().clear();
+    buffer->GetOStream().clear();
+    list.push_back(buffer);
+    ++recycled;
+  }
+};
+
+}  // namespace
+
+buffer::Ptr BufferPool::Acquire(size_t size_hint) {
+  const size_t size_class = GetSizeClass(size_hint);
+  if (size_class == kNumClasses) {
+    ++misses;
+    return buffer::Ptr(new Buffer());
+  }
+
+  if (!cache_destroyed) {
+    std::vector<Buffer*>& list = GetCache().lists[size_class];
+    if (!list.empty()) {
+      Buffer* buffer = list.back();
+      list.pop_back();
+      ++hits;
+      return buffer::Ptr(buffer, Recycle());
+    }
+  }
+
+  ++misses;
+  buffer::Ptr new_(new Buffer(), Recycle());
+  // Reserve the class storage up front so the buffer doesn't reallocate while it fills
+  (**new_).prepare(kClassSizes[size_class]);
+  return new_;
+}
+
+void BufferPool::SetCapacity(size_t max_buffers) {
+  capacity = max_buffers;
+}
+
+size_t BufferPool::GetCapacity() {
+  return capacity;
+}
+
+void BufferPool::Clear() {
+  if (!cache_destroyed) GetCache().Clear();
+}
+
+BufferPool::Stats BufferPool::GetStats() {
+  return Stats{hits, misses, recycled, dropped};
+}
+
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
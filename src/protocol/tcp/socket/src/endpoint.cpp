@@ -0,0 +1,75 @@
+/**
+ * @file   protocol/tcp/socket/src/endpoint.cpp
+ * @brief  Definition of protocol::tcp::socket::Endpoint helpers
+ */
+
+#include <sys/socket.h>
+
+#include <cstring>
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+
+#include <protocol/tcp/socket/endpoint.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+
+namespace ba = boost::asio;
+
+namespace {
+
+/**
+ * Copy the raw address of a generic endpoint into a typed one of the same family
+ * @param endpoint Generic endpoint
+ * @return Typed endpoint
+ */
+template <typename Typed>
+Typed Convert(const Endpoint& endpoint) {
+  Typed typed;
+  if (endpoint.size() <= typed.capacity()) {
+    std::memcpy(typed.data(), endpoint.data(), endpoint.size());
+    typed.resize(endpoint.size());
+  }
+  return typed;
+}
+
+}  // namespace
+
+bool IsIp(const Endpoint& endpoint) {
+  const int family = endpoint.protocol().family();
+  return family == AF_INET || family == AF_INET6;
+}
+
+ba::ip::address GetAddress(const Endpoint& endpoint) {
+  if (!IsIp(endpoint)) return ba::ip::address();
+  const ba::ip::address address = Convert<ba::ip::tcp::endpoint>(endpoint).address();
+  if (address.is_v6() && address.to_v6().is_v4_mapped()) return address.to_v6().to_v4();
+  return address;
+}
+
+uint16_t GetPort(const Endpoint& endpoint) {
+  return IsIp(endpoint) ? Convert<ba::ip::tcp::endpoint>(endpoint).port() : 0;
+}
+
+std::string GetPath(const Endpoint& endpoint) {
+  if (endpoint.protocol().family() != AF_UNIX) return std::string();
+  return Convert<ba::local::stream_protocol::endpoint>(endpoint).path();
+}
+
+std::string GetHost(const Endpoint& endpoint) {
+  if (!IsIp(endpoint)) return "localhost";
+  const ba::ip::address address = GetAddress(endpoint);
+  return address.is_v6() ? "[" + address.to_string() + "]" : address.to_string();
+}
+
+std::string ToString(const Endpoint& endpoint) {
+  if (endpoint.protocol().family() == AF_UNIX) return "unix:" + GetPath(endpoint);
+  if (!IsIp(endpoint)) return "family " + std::to_string(endpoint.protocol().family());
+  return GetHost(endpoint) + ":" + std::to_string(GetPort(endpoint));
+}
+
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
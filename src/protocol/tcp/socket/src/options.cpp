@@ -0,0 +1,156 @@
+/**
+ * @file   protocol/tcp/socket/src/options.cpp
+ * @brief  Definition of protocol::tcp::socket::Options helpers
+ */
+
+#include <atomic>
+#include <cerrno>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/socket_base.hpp>
+
+#include <protocol/log/log.hpp>
+#include <protocol/tcp/socket/endpoint.hpp>
+#include <protocol/tcp/socket/options.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+
+namespace ba = boost::asio;
+namespace bs = boost::system;
+
+namespace {
+
+/**
+ * Set an integer option that asio doesn't name
+ * @param sock  Socket in the open state
+ * @param level Option level
+ * @param name  Option name
+ * @param value Option value
+ * @return Error
+ */
+bs::error_code SetInteger(sock::Socket& sock, int level, int name, int value) {
+  if (setsockopt(sock.native_handle(), level, name, &value, sizeof(value)) != 0) {
+    return bs::error_code(errno, bs::system_category());
+  }
+  return bs::error_code();
+}
+
+/**
+ * Set an integer option when the platform has it
+ * @param sock  Socket in the open state
+ * @param level Option level
+ * @param name  Option name, negative if the platform lacks the option
+ * @param value Option value, 0 leaves the option untouched
+ * @return Error
+ */
+bs::error_code SetOptional(sock::Socket& sock, int level, int name, unsigned value) {
+  if (!value) return bs::error_code();
+  if (name < 0) return ba::error::operation_not_supported;
+  return SetInteger(sock, level, name, static_cast<int>(value));
+}
+
+/**
+ * Whether options set at the TCP level are requested
+ * @param options Options to apply
+ * @return True if any TCP level option is set
+ */
+bool HasTcpLevel(const Options& options) {
+  return options.no_delay || options.quick_ack || options.keep_alive_idle_s || options.keep_alive_interval_s ||
+         options.keep_alive_count || options.user_timeout_ms;
+}
+
+#ifdef TCP_QUICKACK
+const int kQuickAck = TCP_QUICKACK;  ///< Platform name of the quick ACK option
+#else
+const int kQuickAck = -1;
+#endif
+
+#if defined(TCP_KEEPIDLE)
+const int kKeepIdle = TCP_KEEPIDLE;  ///< Platform name of the keepalive idle time option
+#elif defined(TCP_KEEPALIVE)
+const int kKeepIdle = TCP_KEEPALIVE;
+#else
+const int kKeepIdle = -1;
+#endif
+
+#ifdef TCP_KEEPINTVL
+const int kKeepInterval = TCP_KEEPINTVL;  ///< Platform name of the keepalive interval option
+#else
+const int kKeepInterval = -1;
+#endif
+
+#ifdef TCP_KEEPCNT
+const int kKeepCount = TCP_KEEPCNT;  ///< Platform name of the keepalive probe count option
+#else
+const int kKeepCount = -1;
+#endif
+
+#ifdef TCP_USER_TIMEOUT
+const int kUserTimeout = TCP_USER_TIMEOUT;  ///< Platform name of the user timeout option
+#else
+const int kUserTimeout = -1;
+#endif
+
+#ifdef SO_BUSY_POLL
+const int kBusyPoll = SO_BUSY_POLL;  ///< Platform name of the busy poll option
+#else
+const int kBusyPoll = -1;
+#endif
+
+#if defined(TCP_CORK)
+const int kCork = TCP_CORK;  ///< Platform name of the cork option
+#elif defined(TCP_NOPUSH)
+const int kCork = TCP_NOPUSH;
+#else
+const int kCork = -1;
+#endif
+
+}  // namespace
+
+bs::error_code Apply(const Options& options, sock::Socket& sock) {
+  bs::error_code ec;
+  if (options.send_buffer_size &&
+      sock.set_option(ba::socket_base::send_buffer_size(static_cast<int>(options.send_buffer_size)), ec)) {
+    return ec;
+  }
+  if (options.receive_buffer_size &&
+      sock.set_option(ba::socket_base::receive_buffer_size(static_cast<int>(options.receive_buffer_size)), ec)) {
+    return ec;
+  }
+  if (options.keep_alive && sock.set_option(ba::socket_base::keep_alive(true), ec)) return ec;
+  ec = SetOptional(sock, SOL_SOCKET, kBusyPoll, options.busy_poll_us);
+  if (ec == bs::errc::operation_not_permitted) {
+    // Raising the busy poll time needs CAP_NET_ADMIN. It is only a latency optimisation, the socket works without
+    static std::atomic<bool> warned(false);
+    if (!warned.exchange(true)) PROTOCOL_LOG_WARNING("SO_BUSY_POLL left unset: " << ec.message());
+    ec.clear();
+  } else if (ec) {
+    return ec;
+  }
+
+  // Unix domain sockets have no TCP level, the same options then apply to sockets of either family
+  if (!HasTcpLevel(options)) return ec;
+  const Endpoint local = sock.local_endpoint(ec);
+  if (ec || !IsIp(local)) return ec;
+  if (options.no_delay && sock.set_option(ba::ip::tcp::no_delay(true), ec)) return ec;
+  if ((ec = SetOptional(sock, IPPROTO_TCP, kQuickAck, options.quick_ack))) return ec;
+  if ((ec = SetOptional(sock, IPPROTO_TCP, kKeepIdle, options.keep_alive_idle_s))) return ec;
+  if ((ec = SetOptional(sock, IPPROTO_TCP, kKeepInterval, options.keep_alive_interval_s))) return ec;
+  if ((ec = SetOptional(sock, IPPROTO_TCP, kKeepCount, options.keep_alive_count))) return ec;
+  return SetOptional(sock, IPPROTO_TCP, kUserTimeout, options.user_timeout_ms);
+}
+
+bs::error_code SetCork(sock::Socket& sock, bool corked) {
+  if (kCork < 0) return ba::error::operation_not_supported;
+  return SetInteger(sock, IPPROTO_TCP, kCork, corked ? 1 : 0);
+}
+
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
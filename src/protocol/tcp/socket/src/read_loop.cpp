@@ -0,0 +1,144 @@
+/**
+ * @file   protocol/tcp/socket/src/read_loop.cpp
+ * @brief  Class definition of protocol::tcp::socket::ReadLoop
+ */
+
+#include <boost/bind.hpp>
+#include <stdexcept>
+
+#include <protocol/tcp/socket/buffer.hpp>
+#include <protocol/tcp/socket/buffer_pool.hpp>
+#include <protocol/tcp/socket/read_loop.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+
+namespace ba = boost::asio;
+namespace bs = boost::system;
+
+#define BIND(x) boost::bind(&ReadLoop::x, shared_from_this())               ///< Helper bind to member method
+#define BIND2(x, y, z) boost::bind(&ReadLoop::x, shared_from_this(), y, z)  ///< Helper bind to member method
+
+read_loop::Ptr ReadLoop::Start(sock::Ptr sock, const ReadOne::StreamCondition& stream_condition,
+                               const Callback& on_frame, const size_t timeout_ms) {
+  read_loop::Ptr new_(new ReadLoop(sock, stream_condition, on_frame));
+  new_->Start(timeout_ms);
+  return new_;
+}
+
+ReadLoop::ReadLoop(sock::Ptr sock, const ReadOne::StreamCondition& stream_condition, const Callback& on_frame)
+  : stopped_(false),
+    sock_(sock),
+    buffer_(BufferPool::Acquire(ReadOne::kStreamReadSize)),
+    stream_condition_(stream_condition),
+    scanned_(0),
+    frame_size_(0),
+    timeout_ms_(0),
+    last_read_(),
+    on_frame_callback_(on_frame) {
+  if (!sock_) throw std::invalid_argument("Socket can't be null");
+  if (!stream_condition_) throw std::invalid_argument("Stream condition can't be empty");
+  deadline_.reset(new service::Timer(sock_->get_io_service()));
+}
+
+void ReadLoop::Start(const size_t timeout_ms) {
+  timeout_ms_ = timeout_ms;
+  if (timeout_ms_) {
+    last_read_ = Clock::now();
+    deadline_->Arm(timeout_ms_, BIND(OnTimeout));
+  }
+  Read();
+}
+
+void ReadLoop::Stop() {
+  if (!stopped_) {
+    stopped_ = true;
+  }
+  deadline_->Cancel();
+}
+
+const sock::Ptr& ReadLoop::GetSock() const {
+  return sock_;
+}
+
+const socket::buffer::Ptr ReadLoop::GetBuffer() const {
+  return buffer_;
+}
+
+ba::const_buffer ReadLoop::GetFrame() const {
+  return ba::const_buffer(ba::buffer_cast<const char*>((**buffer_).data()), frame_size_);
+}
+
+const HandlerMemory& ReadLoop::GetHandlerMemory() const {
+  return handler_memory_;
+}
+
+void ReadLoop::Read() {
+  ba::streambuf& buffer = **buffer_;
+  while (!stopped_ && scanned_ < buffer.size()) {
+    // Bytes before scanned_ were already passed to the condition, which keeps its own state
+    const char* data = ba::buffer_cast<const char*>(buffer.data());
+    const auto result = stream_condition_(data + scanned_, buffer.size() - scanned_);
+    if (!result.second) {
+      scanned_ = buffer.size();
+      break;
+    }
+
+    frame_size_ = scanned_ + result.first;
+    if (!frame_size_) {
+      // An empty frame consumes nothing, the condition would match it forever
+      Stop();
+      on_frame_callback_(bs::error_code(bs::errc::invalid_argument, bs::system_category()), shared_from_this());
+      return;
+    }
+    on_frame_callback_(bs::error_code(), shared_from_this());
+    buffer.consume(frame_size_);
+    frame_size_ = 0;
+    scanned_ = 0;
+  }
+  if (stopped_) {
+    return;
+  }
+
+  sock_->async_read_some(
+      buffer.prepare(ReadOne::kStreamReadSize), MakeAllocHandler(handler_memory_, BIND2(OnRead, _1, _2)));
+}
+
+void ReadLoop::OnRead(const bs::error_code& ec, std::size_t bytes) {
+  if (stopped_) {
+    return;
+  }
+
+  if (ec) {
+    Stop();
+    on_frame_callback_(ec, shared_from_this());
+    return;
+  }
+
+  (**buffer_).commit(bytes);
+  if (timeout_ms_) {
+    last_read_ = Clock::now();
+  }
+  Read();
+}
+
+void ReadLoop::OnTimeout() {
+  if (stopped_) {
+    return;
+  }
+
+  // The timer isn't re-armed on every read, it is pushed back to the last read when it expires
+  const auto idle_ms = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - last_read_).count();
+  if (static_cast<size_t>(idle_ms) < timeout_ms_) {
+    deadline_->Arm(timeout_ms_ - idle_ms, BIND(OnTimeout));
+    return;
+  }
+
+  Stop();
+  on_frame_callback_(bs::error_code(bs::errc::timed_out, bs::system_category()), shared_from_this());
+}
+
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
@@ -5,12 +5,12 @@
 
 #include <boost/asio/read_until.hpp>
 #include <boost/bind.hpp>
-#include <protocol/service/singleton.hpp>
 #include <protocol/tcp/socket/read_one.hpp>
 #include <boost/asio/coroutine.hpp>
 #include <boost/asio/yield.hpp>
 
 #include <protocol/tcp/socket/buffer.hpp>
+#include <protocol/tcp/socket/buffer_pool.hpp>
 
 namespace protocol {
 namespace tcp {
@@ -20,29 +20,89 @@ namespace ba = boost::asio;
 namespace bs = boost::system;
 
 #define BIND(x) boost::bind(&ReadOne::x, shared_from_this())               ///< Helper bind to member method
+#define BIND1(x, y) boost::bind(&ReadOne::x, shared_from_this(), y)        ///< Helper bind to member method
 #define BIND2(x, y, z) boost::bind(&ReadOne::x, shared_from_this(), y, z)  ///< Helper bind to member method
 
+namespace {
+
+/**
+ * Match condition referring to the stop condition of a ReadOne. async_read_until copies its match condition each
+ * time a read completes, copying this one doesn't allocate.
+ */
+class StopConditionRef {
+ public:
+  typedef std::pair<ReadOne::Iterator, bool> result_type;  ///< Marks the type as a match condition for asio
+
+  /**
+   * Ctor
+   * @param condition Stop condition, must outlive the read
+   */
+  explicit StopConditionRef(const ReadOne::StopCondition& condition) : condition_(&condition) {}
+
+  /**
+   * Forward the match to the stop condition
+   * @param begin Start of the input sequence
+   * @param end   End of the input sequence
+   * @return The result of the stop condition
+   */
+  result_type operator()(ReadOne::Iterator begin, ReadOne::Iterator end) const {
+    return (*condition_)(begin, end);
+  }
+
+ private:
+  const ReadOne::StopCondition* condition_;  ///< Referred stop condition
+};
+
+}  // namespace
+
 read_one::Ptr ReadOne::Start(socket::sock::Ptr sock, const StopCondition& completion_match_codition,
-    const Callback& on_done, const size_t timeout_ms) {
-  read_one::Ptr new_(new ReadOne(sock, completion_match_codition, on_done));
+    const Callback& on_done, const size_t timeout_ms, const Dispatch& dispatch) {
+  read_one::Ptr new_(new ReadOne(sock, completion_match_codition, on_done, dispatch));
   new_->Start(timeout_ms);
   return new_;
 }
 
-ReadOne::ReadOne(socket::sock::Ptr sock, const StopCondition& completion_match_codition, const Callback& on_done)
+read_one::Ptr ReadOne::StartStreaming(socket::sock::Ptr sock, const StreamCondition& stream_condition,
+    const Callback& on_done, const size_t timeout_ms, const Dispatch& dispatch) {
+  read_one::Ptr new_(new ReadOne(sock, stream_condition, on_done, dispatch));
+  new_->Start(timeout_ms);
+  return new_;
+}
+
+ReadOne::ReadOne(socket::sock::Ptr sock, const StopCondition& completion_match_codition, const Callback& on_done,
+                 const Dispatch& dispatch)
   : stopped_(false),
     sock_(sock),
-    buffer_(new Buffer()),
+    buffer_(BufferPool::Acquire()),
     stop_condition_(completion_match_codition),
-    on_done_callback_(on_done) {
+    stream_condition_(),
+    scanned_(0),
+    match_size_(0),
+    on_done_callback_(on_done),
+    dispatch_(dispatch) {
+  if (!sock_) throw std::invalid_argument("Socket can't be null");
+  deadline_.reset(new service::Timer(sock_->get_io_service()));
+}
+
+ReadOne::ReadOne(socket::sock::Ptr sock, const StreamCondition& stream_condition, const Callback& on_done,
+                 const Dispatch& dispatch)
+  : stopped_(false),
+    sock_(sock),
+    buffer_(BufferPool::Acquire(kStreamReadSize)),
+    stop_condition_(),
+    stream_condition_(stream_condition),
+    scanned_(0),
+    match_size_(0),
+    on_done_callback_(on_done),
+    dispatch_(dispatch) {
   if (!sock_) throw std::invalid_argument("Socket can't be null");
-  deadline_ = std::shared_ptr<ba::deadline_timer>(new ba::deadline_timer(sock_->get_io_service()));
+  if (!stream_condition_) throw std::invalid_argument("Stream condition can't be empty");
+  deadline_.reset(new service::Timer(sock_->get_io_service()));
 }
 
 void ReadOne::Start(const size_t timeout_ms) {
   if (timeout_ms) {
-    deadline_->expires_from_now(boost::posix_time::milliseconds(timeout_ms));
-    deadline_->async_wait(BIND(OnTimeout));
+    deadline_->Arm(timeout_ms, BIND(OnTimeout));
   }
   operator()(bs::error_code(), 0);
 }
@@ -51,25 +111,39 @@ void ReadOne::Stop() {
   if (!stopped_) {
     stopped_ = true;
   }
-  deadline_->cancel();
+  deadline_->Cancel();
 }
 
 const sock::Ptr& ReadOne::GetSock() const {
   return sock_;
 }
 
-void ReadOne::operator()(bs::error_code ec = bs::error_code(), std::size_t = 0) {
+const HandlerMemory& ReadOne::GetHandlerMemory() const {
+  return handler_memory_;
+}
+
+void ReadOne::operator()(bs::error_code ec = bs::error_code(), std::size_t bytes = 0) {
   if (stopped_) {
     return;
   }
 
   if (ec) {
-    on_done_callback_(ec, shared_from_this());
+    dispatch_.Invoke(sock_->get_io_service(), MakeAllocHandler(handler_memory_, BIND1(Notify, ec)));
   } else {
     reenter(this) {
       for (;;) {
-        yield ba::async_read_until(*sock_, **buffer_, stop_condition_, BIND2(operator(), _1, _2));
-        yield service::singleton::Instance().post(boost::bind(on_done_callback_, ec, shared_from_this()));
+        if (stream_condition_) {
+          do {
+            yield sock_->async_read_some(
+                (**buffer_).prepare(kStreamReadSize), MakeAllocHandler(handler_memory_, BIND2(operator(), _1, _2)));
+            (**buffer_).commit(bytes);
+          } while (!Scan());
+        } else {
+          yield ba::async_read_until(
+              *sock_, **buffer_, StopConditionRef(stop_condition_), MakeAllocHandler(handler_memory_, BIND2(operator(), _1, _2)));
+          match_size_ = bytes;
+        }
+        yield dispatch_.Invoke(sock_->get_io_service(), MakeAllocHandler(handler_memory_, BIND1(Notify, ec)));
       }
     }
   }
@@ -79,15 +153,37 @@ const socket::buffer::Ptr ReadOne::GetBuffer() const {
   return buffer_;
 }
 
+size_t ReadOne::GetMatchSize() const {
+  return match_size_;
+}
+
+bool ReadOne::Scan() {
+  // The streambuf input sequence is contiguous, offsets stay valid when it grows
+  const auto data = (**buffer_).data();
+  const char* begin = ba::buffer_cast<const char*>(data);
+  const size_t size = ba::buffer_size(data);
+  const auto result = stream_condition_(begin + scanned_, size - scanned_);
+  if (result.second) {
+    match_size_ = scanned_ + result.first;
+    scanned_ = 0;
+    return true;
+  }
+  scanned_ = size;
+  return false;
+}
+
+void ReadOne::Notify(bs::error_code ec) {
+  on_done_callback_(ec, shared_from_this());
+}
+
 void ReadOne::OnTimeout() {
   if (stopped_) {
     return;
   }
 
-  if (deadline_->expires_at() <= ba::deadline_timer::traits_type::now()) {
-    Stop();
-    on_done_callback_(bs::error_code(bs::errc::timed_out, bs::system_category()), shared_from_this());
-  }
+  Stop();
+  // The pending operation may still hold the handler memory, the notification is allocated from the heap
+  dispatch_.Invoke(sock_->get_io_service(), BIND1(Notify, bs::error_code(bs::errc::timed_out, bs::system_category())));
 }
 
 }  // namespace socket
@@ -0,0 +1,100 @@
+/**
+ * @file   tcp/socket/src/read_one_framing.cpp
+ * @brief  Definition of length-prefixed framing functors to use as a protocol::tcp::socket::ReadOne::StopCondition
+ */
+
+#include <protocol/tcp/socket/read_one_framing.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+namespace read_one {
+namespace handlers {
+
+const size_t VarintPrefix::kMaxHeaderSize;
+
+VarintPrefix::VarintPrefix(size_t max_frame_size)
+    : max_frame_size_(max_frame_size), frame_{0, 0, false}, value_(0), header_size_(0), sized_(false), missing_(0) {}
+
+bool VarintPrefix::Decode(const char* data, size_t size, Frame& frame) const {
+  uint64_t value = 0;
+  for (size_t i = 0; i < std::min(size, kMaxHeaderSize); ++i) {
+    const unsigned char byte = data[i];
+    // The last byte only holds the top bit of a 64 bit value
+    if (kMaxHeaderSize - 1 == i && byte > 1) {
+      frame = Frame{kMaxHeaderSize, 0, false};
+      return true;
+    }
+    value |= static_cast<uint64_t>(byte & 0x7f) << (7 * i);
+    if (byte & 0x80) continue;
+
+    frame = MakeFrame(i + 1, value);
+    return true;
+  }
+  return false;
+}
+
+Frame VarintPrefix::MakeFrame(size_t header_size, uint64_t value) const {
+  if (header_size > max_frame_size_ || value > max_frame_size_ - header_size) return Frame{header_size, 0, false};
+  return Frame{header_size, static_cast<size_t>(value), true};
+}
+
+std::pair<ReadOne::Iterator, bool> VarintPrefix::operator()(ReadOne::Iterator begin, ReadOne::Iterator end) {
+  const size_t size = end - begin;
+  Frame frame{0, 0, false};
+  if (!size || !Decode(&*begin, size, frame)) return std::make_pair(begin, false);
+
+  const size_t frame_size = frame.header_size + frame.payload_size;
+  if (size < frame_size) return std::make_pair(begin, false);
+  frame_ = frame;
+  return std::make_pair(begin + frame_size, true);
+}
+
+std::pair<size_t, bool> VarintPrefix::operator()(const char* data, size_t size) {
+  size_t i = 0;
+  while (!sized_ && i < size) {
+    const unsigned char byte = data[i++];
+    if (kMaxHeaderSize - 1 == header_size_ && byte > 1) {
+      frame_ = Frame{kMaxHeaderSize, 0, false};
+      value_ = header_size_ = 0;
+      return std::make_pair(i, true);
+    }
+    value_ |= static_cast<uint64_t>(byte & 0x7f) << (7 * header_size_++);
+    if (byte & 0x80) continue;
+
+    const Frame frame = MakeFrame(header_size_, value_);
+    if (!frame.valid) {
+      frame_ = frame;
+      value_ = header_size_ = 0;
+      return std::make_pair(i, true);
+    }
+    sized_ = true;
+    missing_ = frame.payload_size;
+  }
+  if (!sized_ || size - i < missing_) {
+    if (sized_) missing_ -= size - i;
+    return std::make_pair(size, false);
+  }
+
+  frame_ = Frame{header_size_, static_cast<size_t>(value_), true};
+  i += missing_;
+  value_ = header_size_ = 0;
+  sized_ = false;
+  return std::make_pair(i, true);
+}
+
+const Frame& VarintPrefix::GetFrame() const {
+  return frame_;
+}
+
+Frame VarintPrefix::GetFrame(const char* data, size_t size) const {
+  Frame frame{0, 0, false};
+  Decode(data, size, frame);
+  return frame;
+}
+
+}  // namespace handlers
+}  // namespace read_one
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
@@ -3,8 +3,13 @@
  * @brief  Definition of some functors to use as a protocol::tcp::socket::ReadOne::StopCondition
  */
 
+#include <algorithm>
+#include <queue>
+
 #include <protocol/tcp/socket/read_one_handlers.hpp>
 
+#include "protocol/tcp/socket/search.hpp"
+
 namespace protocol {
 namespace tcp {
 namespace socket {
@@ -12,7 +17,7 @@ namespace read_one {
 namespace handlers {
 
 ByteCount::ByteCount(size_t bytes)
-    : bytes_(bytes) {
+    : bytes_(bytes), seen_(0) {
 }
 
 std::pair<ReadOne::Iterator, bool> ByteCount::operator()(ReadOne::Iterator begin, ReadOne::Iterator end) {
@@ -22,29 +27,169 @@ std::pair<ReadOne::Iterator, bool> ByteCount::operator()(ReadOne::Iterator begin
   return std::make_pair(begin + bytes_, true);
 }
 
+std::pair<size_t, bool> ByteCount::operator()(const char*, size_t size) {
+  const size_t missing = bytes_ - seen_;
+  if (size < missing) {
+    seen_ += size;
+    return std::make_pair(size, false);
+  }
+  seen_ = 0;
+  return std::make_pair(missing, true);
+}
+
 std::pair<ReadOne::Iterator, bool> Substring::operator()(ReadOne::Iterator begin, ReadOne::Iterator end) {
-  ReadOne::Iterator i = begin;
-  while (true) {
-    while ((i != end) && (*i != tail_[0])) ++i;
-    const int size = tail_.size();
-    if (std::distance(i, end) < size) {
-      return std::make_pair(i, false);
+  const size_t size = end - begin;
+  if (size < tail_.size()) {
+    return std::make_pair(begin, false);
+  }
+
+  const char* data = &*begin;
+  const char* found = search::Find(data, data + size, tail_.data(), tail_.size());
+  if (found != data + size) {
+    return std::make_pair(begin + (found - data + tail_.size()), true);
+  }
+  // Resume where a match could still start once more bytes arrive
+  return std::make_pair(end - (tail_.size() - 1), false);
+}
+
+std::pair<size_t, bool> Substring::operator()(const char* data, size_t size) {
+  size_t i = 0;
+  // Finish a match started in previous bytes
+  for (; i < size && matched_; ++i) {
+    while (matched_ && tail_[matched_] != data[i]) matched_ = prefix_[matched_ - 1];
+    if (tail_[matched_] == data[i]) ++matched_;
+    if (matched_ == tail_.size()) {
+      matched_ = 0;
+      return std::make_pair(i + 1, true);
     }
+  }
+
+  const char* found = search::Find(data + i, data + size, tail_.data(), tail_.size());
+  if (found != data + size) {
+    return std::make_pair(found - data + tail_.size(), true);
+  }
+
+  // No match starts in [i, size), only a token prefix at the very end carries over to the next call
+  const size_t carry = tail_.size() - 1;
+  for (i = std::max(i, size > carry ? size - carry : 0); i < size; ++i) {
+    while (matched_ && tail_[matched_] != data[i]) matched_ = prefix_[matched_ - 1];
+    if (tail_[matched_] == data[i]) ++matched_;
+  }
+  return std::make_pair(size, false);
+}
+
+void Substring::BuildPrefix() {
+  prefix_.assign(tail_.size(), 0);
+  size_t length = 0;
+  for (size_t i = 1; i < tail_.size(); ++i) {
+    while (length && tail_[i] != tail_[length]) length = prefix_[length - 1];
+    if (tail_[i] == tail_[length]) ++length;
+    prefix_[i] = length;
+  }
+}
+
+AnyOf::AnyOf(const std::vector<std::string>& tokens)
+    : automaton_(), node_(0), match_(-1) {
+  if (tokens.empty()) throw std::runtime_error("At least one token is required");
 
-    size_t tail_idx;
-    for (tail_idx = 1; tail_idx < tail_.size(); ++tail_idx) {
-      if (*(i + tail_idx) != tail_[tail_idx]) {
-        break;
+  // Build the trie, -1 marks a missing edge
+  auto automaton = std::make_shared<Automaton>();
+  Automaton& state = *automaton;
+  state.next.assign(256, -1);
+  state.output.assign(1, -1);
+  state.longest = 0;
+  for (size_t index = 0; index < tokens.size(); ++index) {
+    const std::string& token = tokens[index];
+    if (token.empty()) throw std::runtime_error("Token can't be empty");
+    int32_t node = 0;
+    for (unsigned char c : token) {
+      if (state.next[node * 256 + c] < 0) {
+        state.next[node * 256 + c] = static_cast<int32_t>(state.output.size());
+        state.next.resize(state.next.size() + 256, -1);
+        state.output.push_back(-1);
       }
+      node = state.next[node * 256 + c];
     }
+    if (state.output[node] < 0) state.output[node] = static_cast<int32_t>(index);
+    state.longest = std::max(state.longest, token.size());
+  }
+
+  // Turn the trie into a DFA breadth first, missing edges follow the failure links. A node without a token of its own
+  // reports the longest token ending there, which is the one of its failure node
+  std::vector<int32_t> fail(state.output.size(), 0);
+  std::queue<int32_t> pending;
+  for (int c = 0; c < 256; ++c) {
+    int32_t& child = state.next[c];
+    if (child < 0) {
+      child = 0;
+    } else {
+      pending.push(child);
+    }
+  }
+  while (!pending.empty()) {
+    const int32_t node = pending.front();
+    pending.pop();
+    if (state.output[node] < 0) state.output[node] = state.output[fail[node]];
+    for (int c = 0; c < 256; ++c) {
+      int32_t& child = state.next[node * 256 + c];
+      if (child < 0) {
+        child = state.next[fail[node] * 256 + c];
+      } else {
+        fail[child] = state.next[fail[node] * 256 + c];
+        pending.push(child);
+      }
+    }
+  }
+  automaton_ = automaton;
+}
 
-    if (tail_idx != tail_.size()) {
-      ++i;
-      continue;
+size_t AnyOf::Scan(const char* data, size_t size, int32_t& node) {
+  const Automaton& state = *automaton_;
+  for (size_t i = 0; i < size; ++i) {
+    node = state.next[node * 256 + static_cast<unsigned char>(data[i])];
+    if (state.output[node] >= 0) {
+      match_ = state.output[node];
+      return i + 1;
     }
+  }
+  return size + 1;
+}
 
-    return std::make_pair(i + tail_.size(), true);
+std::pair<ReadOne::Iterator, bool> AnyOf::operator()(ReadOne::Iterator begin, ReadOne::Iterator end) {
+  const size_t size = end - begin;
+  if (!size) {
+    return std::make_pair(begin, false);
+  }
+
+  int32_t node = 0;
+  const size_t found = Scan(&*begin, size, node);
+  if (found <= size) {
+    return std::make_pair(begin + found, true);
+  }
+  // No pattern is longer than longest, so the bytes before the last longest - 1 can't start a match
+  return std::make_pair(end - std::min(size, automaton_->longest - 1), false);
+}
+
+std::pair<size_t, bool> AnyOf::operator()(const char* data, size_t size) {
+  const size_t found = Scan(data, size, node_);
+  if (found <= size) {
+    node_ = 0;
+    return std::make_pair(found, true);
   }
+  return std::make_pair(size, false);
+}
+
+int AnyOf::GetMatch() const {
+  return match_;
+}
+
+int AnyOf::GetMatch(const char* data, size_t size) const {
+  // A token the bytes end with is among their last longest bytes
+  const Automaton& state = *automaton_;
+  const size_t skip = size - std::min(size, state.longest);
+  int32_t node = 0;
+  for (size_t i = skip; i < size; ++i) node = state.next[node * 256 + static_cast<unsigned char>(data[i])];
+  return state.output[node];
 }
 
 }  // namespace handlers
@@ -0,0 +1,130 @@
+/**
+ * @file   protocol/tcp/socket/src/search.cpp
+ * @brief  Free method definitions for substring search in contiguous memory
+ */
+
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PROTOCOL_SEARCH_X86  ///< x86 intrinsics and function multiversioning are available
+#include <immintrin.h>
+#endif
+
+#include "protocol/tcp/socket/search.hpp"
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+namespace search {
+
+namespace {
+
+/**
+ * Find a single byte
+ * @param begin Start of the searched memory
+ * @param end   End of the searched memory
+ * @param byte  Byte to find
+ * @return Pointer to the first occurrence or end if none
+ */
+const char* FindByte(const char* begin, const char* end, char byte) {
+  const void* found = memchr(begin, byte, end - begin);
+  return found ? static_cast<const char*>(found) : end;
+}
+
+/**
+ * Select the Find() implementation for this CPU
+ * @return The implementation
+ */
+FindFn Select() {
+  return HasAvx2() ? FindAvx2 : FindSse2;
+}
+
+}  // namespace
+
+const char* Find(const char* begin, const char* end, const char* token, size_t size) {
+  static const FindFn impl = Select();
+  return impl(begin, end, token, size);
+}
+
+const char* FindScalar(const char* begin, const char* end, const char* token, size_t size) {
+  if (static_cast<size_t>(end - begin) < size) return end;
+
+  const char* last = end - size;
+  for (const char* i = begin; i <= last; ++i) {
+    i = FindByte(i, last + 1, token[0]);
+    if (i > last) break;
+    if (!memcmp(i + 1, token + 1, size - 1)) return i;
+  }
+  return end;
+}
+
+#if defined(PROTOCOL_SEARCH_X86) && defined(__SSE2__)
+const char* FindSse2(const char* begin, const char* end, const char* token, size_t size) {
+  if (static_cast<size_t>(end - begin) < size) return end;
+  if (1 == size) return FindByte(begin, end, token[0]);
+
+  // Positions where both the first and the last token bytes match are candidates, only those are compared in full
+  const __m128i first = _mm_set1_epi8(token[0]);
+  const __m128i last = _mm_set1_epi8(token[size - 1]);
+  const char* stop = end - size + 1;
+  const char* i = begin;
+  for (; i + 16 <= stop; i += 16) {
+    const __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(i));
+    const __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(i + size - 1));
+    unsigned mask = static_cast<unsigned>(
+        _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, block_first), _mm_cmpeq_epi8(last, block_last))));
+    while (mask) {
+      const unsigned bit = __builtin_ctz(mask);
+      if (!memcmp(i + bit + 1, token + 1, size - 2)) return i + bit;
+      mask &= mask - 1;
+    }
+  }
+  return FindScalar(i, end, token, size);
+}
+#else
+const char* FindSse2(const char* begin, const char* end, const char* token, size_t size) {
+  return FindScalar(begin, end, token, size);
+}
+#endif
+
+#if defined(PROTOCOL_SEARCH_X86)
+__attribute__((target("avx2")))
+const char* FindAvx2(const char* begin, const char* end, const char* token, size_t size) {
+  if (static_cast<size_t>(end - begin) < size) return end;
+  if (1 == size) return FindByte(begin, end, token[0]);
+
+  const __m256i first = _mm256_set1_epi8(token[0]);
+  const __m256i last = _mm256_set1_epi8(token[size - 1]);
+  const char* stop = end - size + 1;
+  const char* i = begin;
+  for (; i + 32 <= stop; i += 32) {
+    const __m256i block_first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(i));
+    const __m256i block_last = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(i + size - 1));
+    unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+        _mm256_and_si256(_mm256_cmpeq_epi8(first, block_first), _mm256_cmpeq_epi8(last, block_last))));
+    while (mask) {
+      const unsigned bit = __builtin_ctz(mask);
+      if (!memcmp(i + bit + 1, token + 1, size - 2)) return i + bit;
+      mask &= mask - 1;
+    }
+  }
+  return FindSse2(i, end, token, size);
+}
+
+bool HasAvx2() {
+  return __builtin_cpu_supports("avx2");
+}
+#else
+const char* FindAvx2(const char* begin, const char* end, const char* token, size_t size) {
+  return FindScalar(begin, end, token, size);
+}
+
+bool HasAvx2() {
+  return false;
+}
+#endif
+
+}  // namespace search
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
@@ -6,9 +6,9 @@
 #include <boost/asio/write.hpp>
 #include <boost/bind.hpp>
 
-#include <protocol/service/singleton.hpp>
 #include <protocol/tcp/socket/write_one.hpp>
 #include <protocol/tcp/socket/buffer.hpp>
+#include <protocol/tcp/socket/buffer_chain.hpp>
 
 #include <boost/asio/coroutine.hpp>
 #include <boost/asio/yield.hpp>
@@ -22,25 +22,55 @@ namespace bs = boost::system;
 using std::vector;
 
 #define BIND(x) boost::bind(&WriteOne::x, shared_from_this())               ///< Helper bind to member method
+#define BIND1(x, y) boost::bind(&WriteOne::x, shared_from_this(), y)        ///< Helper bind to member method
 #define BIND2(x, y, z) boost::bind(&WriteOne::x, shared_from_this(), y, z)  ///< Helper bind to member method
 
 write_one::Ptr WriteOne::Start(
-    socket::sock::Ptr sock, buffer::Ptr buffer, const Callback& on_done, const size_t timeout_ms) {
-  write_one::Ptr new_(new WriteOne(sock, buffer, on_done));
+    socket::sock::Ptr sock, buffer::Ptr buffer, const Callback& on_done, const size_t timeout_ms,
+    const Dispatch& dispatch, Cork cork) {
+  write_one::Ptr new_(new WriteOne(sock, buffer, on_done, dispatch, cork));
   new_->Start(timeout_ms);
   return new_;
 }
 
-WriteOne::WriteOne(socket::sock::Ptr sock, buffer::Ptr buffer, const Callback& on_done)
-  : stopped_(false), sock_(sock), write_buffer_(buffer), on_done_callback_(on_done) {
+write_one::Ptr WriteOne::Start(
+    socket::sock::Ptr sock, buffer_chain::Ptr chain, const Callback& on_done, const size_t timeout_ms,
+    const Dispatch& dispatch, Cork cork) {
+  write_one::Ptr new_(new WriteOne(sock, chain, on_done, dispatch, cork));
+  new_->Start(timeout_ms);
+  return new_;
+}
+
+WriteOne::WriteOne(
+    socket::sock::Ptr sock, buffer::Ptr buffer, const Callback& on_done, const Dispatch& dispatch, Cork cork)
+  : stopped_(false),
+    sock_(sock),
+    write_buffer_(buffer),
+    write_chain_(),
+    on_done_callback_(on_done),
+    dispatch_(dispatch),
+    cork_(cork) {
   if (!sock_) throw std::invalid_argument("Socket can't be null");
-  deadline_ = std::shared_ptr<ba::deadline_timer>(new ba::deadline_timer(sock_->get_io_service()));
+  deadline_.reset(new service::Timer(sock_->get_io_service()));
+}
+
+WriteOne::WriteOne(
+    socket::sock::Ptr sock, buffer_chain::Ptr chain, const Callback& on_done, const Dispatch& dispatch, Cork cork)
+  : stopped_(false),
+    sock_(sock),
+    write_buffer_(),
+    write_chain_(chain),
+    on_done_callback_(on_done),
+    dispatch_(dispatch),
+    cork_(cork) {
+  if (!sock_) throw std::invalid_argument("Socket can't be null");
+  if (!write_chain_) throw std::invalid_argument("Buffer chain can't be null");
+  deadline_.reset(new service::Timer(sock_->get_io_service()));
 }
 
 void WriteOne::Start(const size_t timeout_ms) {
   if (timeout_ms) {
-    deadline_->expires_from_now(boost::posix_time::milliseconds(timeout_ms));
-    deadline_->async_wait(BIND(OnTimeout));
+    deadline_->Arm(timeout_ms, BIND(OnTimeout));
   }
   operator()(bs::error_code(), 0);
 }
@@ -49,39 +79,57 @@ void WriteOne::Stop() {
   if (!stopped_) {
     stopped_ = true;
   }
-  deadline_->cancel();
+  deadline_->Cancel();
 }
 
 const sock::Ptr& WriteOne::GetSock() const {
   return sock_;
 }
 
+const HandlerMemory& WriteOne::GetHandlerMemory() const {
+  return handler_memory_;
+}
+
 void WriteOne::operator()(bs::error_code ec = bs::error_code(), std::size_t = 0) {
   if (stopped_) {
     return;
   }
 
   if (ec) {
-    on_done_callback_(ec, shared_from_this());
+    dispatch_.Invoke(sock_->get_io_service(), MakeAllocHandler(handler_memory_, BIND1(Notify, ec)));
   } else {
     reenter(this) {
       for (;;) {
-        yield ba::async_write(*sock_, **write_buffer_, BIND2(operator(), _1, _2));
-        yield service::singleton::Instance().post(boost::bind(on_done_callback_, ec, shared_from_this()));
+        // Corking only merges segments, a socket that can't be corked still sends the same bytes
+        if (cork_ == Cork::kCork) SetCork(*sock_, true);
+        yield {
+          if (write_chain_) {
+            ba::async_write(
+                *sock_, write_chain_->GetBuffers(), MakeAllocHandler(handler_memory_, BIND2(operator(), _1, _2)));
+          } else {
+            ba::async_write(
+                *sock_, **write_buffer_, MakeAllocHandler(handler_memory_, BIND2(operator(), _1, _2)));
+          }
+        }
+        if (cork_ == Cork::kUncork) SetCork(*sock_, false);
+        yield dispatch_.Invoke(sock_->get_io_service(), MakeAllocHandler(handler_memory_, BIND1(Notify, ec)));
       }
     }
   }
 }
 
+void WriteOne::Notify(bs::error_code ec) {
+  on_done_callback_(ec, shared_from_this());
+}
+
 void WriteOne::OnTimeout() {
   if (stopped_) {
     return;
   }
 
-  if (deadline_->expires_at() <= ba::deadline_timer::traits_type::now()) {
-    Stop();
-    on_done_callback_(bs::error_code(bs::errc::timed_out, bs::system_category()), shared_from_this());
-  }
+  Stop();
+  // The pending operation may still hold the handler memory, the notification is allocated from the heap
+  dispatch_.Invoke(sock_->get_io_service(), BIND1(Notify, bs::error_code(bs::errc::timed_out, bs::system_category())));
 }
 
 }  // namespace socket
@@ -0,0 +1,213 @@
+/**
+ * @file   protocol/tcp/socket/src/write_queue.cpp
+ * @brief  Class definition of protocol::tcp::socket::WriteQueue
+ */
+
+#include <boost/asio/write.hpp>
+#include <boost/bind.hpp>
+#include <stdexcept>
+#include <utility>
+
+#include <protocol/tcp/socket/buffer.hpp>
+#include <protocol/tcp/socket/buffer_chain.hpp>
+#include <protocol/tcp/socket/write_queue.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+
+namespace ba = boost::asio;
+namespace bs = boost::system;
+
+#define BIND(x) boost::bind(&WriteQueue::x, shared_from_this())               ///< Helper bind to member method
+#define BIND2(x, y, z) boost::bind(&WriteQueue::x, shared_from_this(), y, z)  ///< Helper bind to member method
+
+write_queue::Ptr WriteQueue::Create(
+    sock::Ptr sock, const write_queue::Config& config, const BackpressureCallback& on_backpressure) {
+  return write_queue::Ptr(new WriteQueue(sock, config, on_backpressure));
+}
+
+WriteQueue::WriteQueue(sock::Ptr sock, const write_queue::Config& config, const BackpressureCallback& on_backpressure)
+  : sock_(sock),
+    config_(config),
+    on_backpressure_callback_(on_backpressure),
+    pending_(),
+    queued_bytes_(0),
+    paused_(false),
+    stopped_(false),
+    writing_(false),
+    stats_{0, 0},
+    batch_(),
+    slices_(),
+    batch_bytes_(0),
+    batch_reported_(false) {
+  if (!sock_) throw std::invalid_argument("Socket can't be null");
+  if (config_.low_water_mark > config_.high_water_mark) {
+    throw std::invalid_argument("Low-water mark can't be above the high-water mark");
+  }
+  if (!config_.max_batch_messages) throw std::invalid_argument("A batch needs at least one message");
+  deadline_.reset(new service::Timer(sock_->get_io_service()));
+  strand_.reset(new ba::io_service::strand(sock_->get_io_service()));
+}
+
+bool WriteQueue::Push(buffer::Ptr buffer, const Callback& on_done) {
+  if (!buffer) throw std::invalid_argument("Buffer can't be null");
+  const size_t size = (**buffer).size();
+  return Push(Message{std::move(buffer), buffer_chain::Ptr(), size, on_done});
+}
+
+bool WriteQueue::Push(buffer_chain::Ptr chain, const Callback& on_done) {
+  if (!chain) throw std::invalid_argument("Buffer chain can't be null");
+  const size_t size = chain->GetSize();
+  return Push(Message{buffer::Ptr(), std::move(chain), size, on_done});
+}
+
+bool WriteQueue::Push(Message&& message) {
+  bool start = false;
+  bool accept = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopped_) {
+      if (message.on_done) {
+        sock_->get_io_service().post(
+            boost::bind(message.on_done, bs::error_code(ba::error::operation_aborted), shared_from_this()));
+      }
+      return false;
+    }
+
+    queued_bytes_ += message.size;
+    pending_.push_back(std::move(message));
+    if (!writing_) {
+      writing_ = true;
+      start = true;
+    }
+    if (!paused_ && queued_bytes_ > config_.high_water_mark) {
+      paused_ = true;
+      Signal(true);
+    }
+    accept = !paused_;
+  }
+
+  if (start) {
+    sock_->get_io_service().post(MakeAllocHandler(handler_memory_, BIND(Flush)));
+  }
+  return accept;
+}
+
+void WriteQueue::Stop() {
+  Fail(ba::error::operation_aborted);
+}
+
+size_t WriteQueue::GetQueuedBytes() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return queued_bytes_;
+}
+
+WriteQueue::Stats WriteQueue::GetStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+const sock::Ptr& WriteQueue::GetSock() const {
+  return sock_;
+}
+
+void WriteQueue::Flush() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopped_ || pending_.empty()) {
+      writing_ = false;
+      return;
+    }
+
+    // Coalesce what queued up while the previous write was in flight
+    batch_bytes_ = 0;
+    while (!pending_.empty() && batch_.size() < config_.max_batch_messages &&
+           (batch_.empty() || batch_bytes_ < config_.max_batch_bytes)) {
+      batch_bytes_ += pending_.front().size;
+      batch_.push_back(std::move(pending_.front()));
+      pending_.pop_front();
+    }
+    ++stats_.writes;
+  }
+
+  slices_.clear();
+  for (const Message& message : batch_) {
+    if (message.buffer) {
+      const auto data = (**message.buffer).data();
+      slices_.insert(slices_.end(), data.begin(), data.end());
+    } else {
+      const auto buffers = message.chain->GetBuffers();
+      slices_.insert(slices_.end(), buffers.begin(), buffers.end());
+    }
+  }
+
+  if (config_.timeout_ms) {
+    deadline_->Arm(config_.timeout_ms, BIND(OnTimeout));
+  }
+  ba::async_write(*sock_, BufferChain::ConstBuffers(slices_),
+                  MakeAllocHandler(handler_memory_, BIND2(OnWrite, _1, _2)));
+}
+
+void WriteQueue::OnWrite(const bs::error_code& ec, std::size_t) {
+  deadline_->Cancel();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queued_bytes_ -= batch_bytes_;
+    if (!ec) stats_.messages += batch_.size();
+    if (paused_ && queued_bytes_ <= config_.low_water_mark) {
+      paused_ = false;
+      if (!stopped_ && !ec) Signal(false);
+    }
+  }
+
+  std::vector<Message> batch;
+  batch.swap(batch_);
+  for (Message& message : batch) {
+    if (!ec && message.buffer) (**message.buffer).consume(message.size);
+    if (!batch_reported_ && message.on_done) message.on_done(ec, shared_from_this());
+  }
+  // The vector is swapped back afterwards to keep its capacity
+  batch.clear();
+  batch_.swap(batch);
+  batch_reported_ = false;
+
+  if (ec) Fail(ec);
+  Flush();
+}
+
+void WriteQueue::OnTimeout() {
+  // Closing the socket aborts the write, its completion then only releases the batch
+  const bs::error_code ec(bs::errc::timed_out, bs::system_category());
+  batch_reported_ = true;
+  for (Message& message : batch_) {
+    if (message.on_done) message.on_done(ec, shared_from_this());
+  }
+  Fail(ec);
+  bs::error_code ignored;
+  sock_->close(ignored);
+}
+
+void WriteQueue::Signal(bool pause) {
+  // Posted with mutex_ held, so the strand runs the calls in the order the water marks were crossed
+  if (on_backpressure_callback_) strand_->post(boost::bind(on_backpressure_callback_, pause, shared_from_this()));
+}
+
+void WriteQueue::Fail(const bs::error_code& ec) {
+  std::deque<Message> pending;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopped_) return;
+    stopped_ = true;
+    pending.swap(pending_);
+    for (const Message& message : pending) queued_bytes_ -= message.size;
+  }
+
+  for (Message& message : pending) {
+    if (message.on_done) message.on_done(ec, shared_from_this());
+  }
+}
+
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
@@ -0,0 +1,84 @@
+/**
+ * @cond   internal
+ * @file   tests/buffer_chain.cpp
+ * @brief  Unit tests for protocol::tcp::socket::BufferChain
+ */
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/make_shared.hpp>
+#include <gtest/gtest.h>
+
+#include <protocol/tcp/socket/buffer.hpp>
+#include <protocol/tcp/socket/buffer_chain.hpp>
+#include <protocol/tcp/socket/socket_pair.hpp>
+#include <protocol/tcp/socket/write_one.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+
+namespace ba = boost::asio;
+namespace bs = boost::system;
+
+/**
+ * @test Slices are borrowed and kept alive by their owners
+ */
+TEST(BufferChain, Basics) {
+  auto chain = BufferChain::Create();
+  ASSERT_THROW(chain->Append(buffer::Ptr()), std::invalid_argument);
+
+  auto body = boost::make_shared<const std::string>("body");
+  boost::weak_ptr<const std::string> weak = body;
+  chain->Append(Buffer::Create("head ")).Append(body).Append("", 0);
+  body.reset();
+  ASSERT_FALSE(weak.expired());
+  ASSERT_EQ(2u, chain->GetCount());
+  ASSERT_EQ(9u, chain->GetSize());
+  ASSERT_EQ(9u, ba::buffer_size(chain->GetBuffers()));
+
+  chain->Clear();
+  ASSERT_TRUE(weak.expired());
+  ASSERT_EQ(0u, chain->GetSize());
+}
+
+/**
+ * @test A chain is sent in order with WriteOne
+ */
+TEST(BufferChain, Write) {
+  ba::io_service service;
+  SocketPair pair(service);
+  sock::Ptr client = pair.client;
+  sock::Socket& server = *pair.server;
+
+  static const char kHeader[] = "HTTP/1.1 200 OK\r\n\r\n";
+  auto body = boost::make_shared<const std::string>(1 << 20, 'x');
+  auto chain = BufferChain::Create();
+  chain->Append(kHeader, sizeof(kHeader) - 1).Append(body).Append(Buffer::Create("trailer"));
+  const std::string expected = kHeader + *body + "trailer";
+  body.reset();
+
+  bool written = false;
+  WriteOne::Start(client, chain, [&](bs::error_code ec, write_one::Ptr) {
+    ASSERT_FALSE(ec);
+    written = true;
+  }, 0);
+  std::string received(expected.size(), '\0');
+  ba::async_read(server, ba::buffer(&received[0], received.size()), [](bs::error_code ec, size_t) {
+    ASSERT_FALSE(ec);
+  });
+  service.run();
+
+  ASSERT_TRUE(written);
+  ASSERT_EQ(expected, received);
+}
+
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
+
+/// @endcond internal
@@ -0,0 +1,108 @@
+/**
+ * @cond   internal
+ * @file   tests/buffer_pool.cpp
+ * @brief  Unit tests for protocol::tcp::socket::BufferPool
+ */
+
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <protocol/tcp/socket/buffer.hpp>
+#include <protocol/tcp/socket/buffer_pool.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+
+/**
+ * @test Released buffers are handed out again, empty and with usable streams
+ */
+TEST(BufferPool, Recycle) {
+  BufferPool::Clear();
+  Buffer* first = nullptr;
+  {
+    auto buffer = Buffer::Create("Hello world!");
+    first = buffer.get();
+    std::string hello;
+    *buffer >> hello >> hello >> hello;  // Leaves the input stream failed
+  }
+  auto before = BufferPool::GetStats();
+  auto buffer = BufferPool::Acquire();
+  ASSERT_EQ(first, buffer.get());
+  ASSERT_EQ(before.hits + 1, BufferPool::GetStats().hits);
+  ASSERT_EQ(0u, (**buffer).size());
+
+  *buffer << 12345;
+  int number = 0;
+  *buffer >> number;
+  ASSERT_EQ(12345, number);
+}
+
+/**
+ * @test Buffers go to the size class their storage grew into and the capacity bounds the free lists
+ */
+TEST(BufferPool, SizeClassesAndCapacity) {
+  BufferPool::Clear();
+  Buffer* grown;
+  {
+    auto buffer = BufferPool::Acquire();
+    grown = buffer.get();
+    *buffer << std::string(BufferPool::kClassSizes[1], 'x');
+    buffer->Reset();
+  }
+  auto small = BufferPool::Acquire();
+  auto large = BufferPool::Acquire(BufferPool::kClassSizes[1]);
+  auto stats = BufferPool::GetStats();
+  ASSERT_NE(small.get(), large.get());
+  ASSERT_EQ(grown, large.get());
+  ASSERT_LE(BufferPool::kClassSizes[1], large->GetCapacity());
+
+  const size_t capacity = BufferPool::GetCapacity();
+  BufferPool::SetCapacity(0);
+  small.reset();
+  ASSERT_EQ(stats.dropped + 1, BufferPool::GetStats().dropped);
+  BufferPool::SetCapacity(capacity);
+  large.reset();
+  ASSERT_EQ(stats.recycled + 1, BufferPool::GetStats().recycled);
+}
+
+/**
+ * @test Buffers released on another thread go to that thread's free lists
+ */
+TEST(BufferPool, PerThread) {
+  BufferPool::Clear();
+  auto buffer = BufferPool::Acquire();
+  Buffer* raw = buffer.get();
+  buffer::Ptr reacquired;
+  std::thread([&]() {
+    buffer.reset();
+    reacquired = BufferPool::Acquire();
+  }).join();
+  // Still held, so that its memory can't be reused by the next allocation
+  ASSERT_EQ(raw, reacquired.get());
+  ASSERT_NE(raw, BufferPool::Acquire().get());
+}
+
+/**
+ * @test A buffer whose storage outgrew the largest class isn't kept, even once emptied
+ */
+TEST(BufferPool, Oversized) {
+  BufferPool::Clear();
+  auto buffer = BufferPool::Acquire();
+  *buffer << std::string(BufferPool::kClassSizes[BufferPool::kNumClasses - 1] + 1, 'x');
+  buffer->Reset();
+  ASSERT_EQ(0u, (**buffer).size());
+
+  const auto stats = BufferPool::GetStats();
+  buffer.reset();
+  ASSERT_EQ(stats.dropped + 1, BufferPool::GetStats().dropped);
+  ASSERT_EQ(stats.recycled, BufferPool::GetStats().recycled);
+}
+
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
+
+/// @endcond internal
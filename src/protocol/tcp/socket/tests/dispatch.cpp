@@ -0,0 +1,124 @@
+/**
+ * @cond   internal
+ * @file   tests/dispatch.cpp
+ * @brief  Unit tests for protocol::tcp::socket::Dispatch
+ */
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <boost/asio/io_service.hpp>
+#include <gtest/gtest.h>
+
+#include <protocol/tcp/socket/buffer.hpp>
+#include <protocol/tcp/socket/dispatch.hpp>
+#include <protocol/tcp/socket/read_one.hpp>
+#include <protocol/tcp/socket/read_one_handlers.hpp>
+#include <protocol/tcp/socket/socket_pair.hpp>
+#include <protocol/tcp/socket/write_one.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+
+namespace ba = boost::asio;
+namespace bs = boost::system;
+
+/**
+ * Write and read one message on a socket pair
+ * @param dispatch Policy of both operations
+ * @param service  io_service running the operations
+ * @param check    Called from the read callback
+ * @return Number of handlers the io_service ran
+ */
+static size_t RoundTrip(const Dispatch& dispatch, ba::io_service& service, std::function<void()> check) {
+  SocketPair pair(service);
+  sock::Ptr client = pair.client;
+  sock::Ptr server = pair.server;
+
+  bool done = false;
+  WriteOne::Start(client, Buffer::Create("ping\n"), [](bs::error_code ec, write_one::Ptr) {
+    ASSERT_FALSE(ec);
+  }, 0, dispatch);
+  ReadOne::Start(server, read_one::handlers::Substring(std::string("\n")), [&](bs::error_code ec, read_one::Ptr) {
+    ASSERT_FALSE(ec);
+    check();
+    done = true;
+  }, 0, dispatch);
+  const size_t handlers = service.run();
+  EXPECT_TRUE(done);
+  return handlers;
+}
+
+/**
+ * @test Inline callbacks save the queue hop of each operation, strand callbacks run in the strand
+ */
+TEST(Dispatch, Modes) {
+  ASSERT_THROW(Dispatch::OnStrand(nullptr), std::invalid_argument);
+
+  ba::io_service post_service;
+  const size_t posted = RoundTrip(Dispatch::Post(), post_service, []() {});
+
+  ba::io_service inline_service;
+  const size_t inlined = RoundTrip(Dispatch::Inline(), inline_service, []() {});
+  ASSERT_EQ(posted - 2, inlined);
+
+  ba::io_service strand_service;
+  auto strand = std::make_shared<ba::io_service::strand>(strand_service);
+  RoundTrip(Dispatch::OnStrand(strand), strand_service, [&]() {
+    ASSERT_TRUE(strand->running_in_this_thread());
+  });
+}
+
+/**
+ * @test Failed and timed out operations call back in the strand too
+ */
+TEST(Dispatch, StrandErrors) {
+  ba::io_service service;
+  auto strand = std::make_shared<ba::io_service::strand>(service);
+  const Dispatch dispatch = Dispatch::OnStrand(strand);
+  const read_one::handlers::Substring newline(std::string("\n"));
+
+  SocketPair closed(service);
+  closed.client->close();
+  bs::error_code write_error;
+  WriteOne::Start(closed.client, Buffer::Create("ping\n"), [&](bs::error_code ec, write_one::Ptr) {
+    EXPECT_TRUE(strand->running_in_this_thread());
+    write_error = ec;
+  }, 0, dispatch);
+  bs::error_code read_error;
+  ReadOne::Start(closed.server, newline, [&](bs::error_code ec, read_one::Ptr) {
+    EXPECT_TRUE(strand->running_in_this_thread());
+    read_error = ec;
+  }, 0, dispatch);
+  service.run();
+  service.reset();
+  ASSERT_EQ(ba::error::bad_descriptor, write_error);
+  ASSERT_EQ(ba::error::eof, read_error);
+
+  // Nothing reads the client, a large enough write fills both socket buffers and stalls
+  SocketPair idle(service);
+  write_error = bs::error_code();
+  WriteOne::Start(idle.client, Buffer::Create(std::string(16 << 20, 'x')), [&](bs::error_code ec, write_one::Ptr) {
+    EXPECT_TRUE(strand->running_in_this_thread());
+    write_error = ec;
+    idle.client->close();
+  }, 20, dispatch);
+  SocketPair quiet(service);
+  read_error = bs::error_code();
+  ReadOne::Start(quiet.server, newline, [&](bs::error_code ec, read_one::Ptr) {
+    EXPECT_TRUE(strand->running_in_this_thread());
+    read_error = ec;
+    quiet.server->close();
+  }, 20, dispatch);
+  service.run();
+  ASSERT_EQ(bs::errc::timed_out, write_error);
+  ASSERT_EQ(bs::errc::timed_out, read_error);
+}
+
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
+
+/// @endcond internal
@@ -0,0 +1,55 @@
+/**
+ * @cond   internal
+ * @file   tests/endpoint.cpp
+ * @brief  Unit tests for the protocol::tcp::socket::Endpoint helpers
+ */
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <gtest/gtest.h>
+
+#include <protocol/tcp/socket/endpoint.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+
+namespace ba = boost::asio;
+using ba::ip::tcp;
+
+/**
+ * @test Addresses, ports and hosts of IPv4, IPv6 and Unix domain socket endpoints
+ */
+TEST(Endpoint, Families) {
+  const Endpoint v4 = tcp::endpoint(ba::ip::address::from_string("192.168.1.2"), 80);
+  ASSERT_TRUE(IsIp(v4));
+  ASSERT_EQ("192.168.1.2", GetAddress(v4).to_string());
+  ASSERT_EQ(80, GetPort(v4));
+  ASSERT_EQ("192.168.1.2", GetHost(v4));
+  ASSERT_EQ("192.168.1.2:80", ToString(v4));
+  ASSERT_EQ("", GetPath(v4));
+
+  const Endpoint v6 = tcp::endpoint(ba::ip::address::from_string("::1"), 8080);
+  ASSERT_TRUE(IsIp(v6));
+  ASSERT_TRUE(GetAddress(v6).is_v6());
+  ASSERT_EQ(8080, GetPort(v6));
+  ASSERT_EQ("[::1]", GetHost(v6));
+  ASSERT_EQ("[::1]:8080", ToString(v6));
+
+  // Dual-stack listeners see IPv4 peers as mapped addresses
+  const Endpoint mapped = tcp::endpoint(ba::ip::address::from_string("::ffff:10.0.0.1"), 1);
+  ASSERT_TRUE(GetAddress(mapped).is_v4());
+  ASSERT_EQ("10.0.0.1", GetHost(mapped));
+
+  const Endpoint local = ba::local::stream_protocol::endpoint("/tmp/protocol.sock");
+  ASSERT_FALSE(IsIp(local));
+  ASSERT_TRUE(GetAddress(local).is_unspecified());
+  ASSERT_EQ(0, GetPort(local));
+  ASSERT_EQ("localhost", GetHost(local));
+  ASSERT_EQ("/tmp/protocol.sock", GetPath(local));
+  ASSERT_EQ("unix:/tmp/protocol.sock", ToString(local));
+}
+
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
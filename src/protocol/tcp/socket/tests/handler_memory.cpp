@@ -0,0 +1,183 @@
+/**
+ * @cond   internal
+ * @file   tests/handler_memory.cpp
+ * @brief  Unit tests for protocol::tcp::socket::HandlerMemory
+ */
+
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include <gtest/gtest.h>
+
+#include <protocol/tcp/socket/buffer.hpp>
+#include <protocol/tcp/socket/handler_memory.hpp>
+#include <protocol/tcp/socket/read_one.hpp>
+#include <protocol/tcp/socket/read_one_handlers.hpp>
+#include <protocol/tcp/socket/socket_pair.hpp>
+#include <protocol/tcp/socket/write_one.hpp>
+
+namespace {
+
+thread_local bool counting = false;   ///< Whether the heap allocations of the thread are counted
+thread_local size_t allocations = 0;  ///< Heap allocations counted
+
+}  // namespace
+
+/**
+ * Global allocation function of protocol_alloc_test, counts the allocations of the thread while enabled
+ * @param size Number of bytes
+ * @return Pointer to the memory
+ */
+void* operator new(std::size_t size) {
+  if (counting) ++allocations;
+  if (void* pointer = std::malloc(size ? size : 1)) return pointer;
+  throw std::bad_alloc();
+}
+
+/**
+ * Global deallocation function matching operator new
+ * @param pointer Pointer to the memory
+ */
+void operator delete(void* pointer) noexcept {
+  std::free(pointer);
+}
+
+#if __cpp_sized_deallocation
+/**
+ * Global sized deallocation function matching operator new
+ * @param pointer Pointer to the memory
+ */
+void operator delete(void* pointer, std::size_t) noexcept {
+  std::free(pointer);
+}
+#endif
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+
+namespace ba = boost::asio;
+namespace bs = boost::system;
+
+/**
+ * @test The block is reused once released and the heap serves what doesn't fit
+ */
+TEST(HandlerMemory, Recycle) {
+  HandlerMemory memory;
+  void* first = memory.Allocate(64);
+  memory.Deallocate(first);
+  void* second = memory.Allocate(HandlerMemory::kSize);
+  ASSERT_EQ(first, second);
+
+  void* busy = memory.Allocate(64);
+  void* large = memory.Allocate(HandlerMemory::kSize + 1);
+  ASSERT_NE(busy, second);
+  ASSERT_NE(large, second);
+  memory.Deallocate(busy);
+  memory.Deallocate(large);
+  memory.Deallocate(second);
+  ASSERT_EQ(2u, memory.GetHits());
+  ASSERT_EQ(2u, memory.GetMisses());
+}
+
+/**
+ * Sends a message back and forth on a socket pair, every operation allocated from one HandlerMemory per direction
+ */
+class PingPong {
+ public:
+  /**
+   * Ctor
+   * @param client Writing end
+   * @param server Reading end
+   * @param rounds Number of round trips
+   * @param warmup Round trips before the heap allocations are counted
+   */
+  PingPong(sock::Socket& client, sock::Socket& server, size_t rounds, size_t warmup)
+      : client_(client), server_(server), rounds_(rounds), warmup_(warmup), round_(0), message_("ping\n") {}
+
+  /**
+   * Start the next round trip
+   */
+  void Next() {
+    counting = round_ >= warmup_;
+    if (round_++ == rounds_) return;
+    ba::async_write(client_, ba::buffer(message_), MakeAllocHandler(write_memory_, [](bs::error_code ec, size_t) {
+      ASSERT_FALSE(ec);
+    }));
+    ba::async_read(server_, ba::buffer(received_), MakeAllocHandler(read_memory_, [this](bs::error_code ec, size_t) {
+      ASSERT_FALSE(ec);
+      Next();
+    }));
+  }
+
+ private:
+  sock::Socket& client_;         ///< Writing end
+  sock::Socket& server_;         ///< Reading end
+  size_t rounds_;                ///< Number of round trips
+  size_t warmup_;                ///< Round trips before counting
+  size_t round_;                 ///< Round trips started
+  const std::string message_;    ///< Message sent
+  char received_[5];             ///< Message received
+  HandlerMemory write_memory_;   ///< Memory of the write operations
+  HandlerMemory read_memory_;    ///< Memory of the read operations
+};
+
+/**
+ * @test A steady-state read/write loop doesn't allocate from the heap at all, asio included
+ */
+TEST(HandlerMemory, NoHeapAllocations) {
+  ba::io_service service;
+  SocketPair pair(service);
+
+  PingPong ping_pong(*pair.client, *pair.server, 64, 8);
+  ping_pong.Next();
+  service.run();
+  counting = false;
+  ASSERT_EQ(0u, allocations);
+}
+
+/**
+ * @test Once warmed up, the asynchronous chains of ReadOne and WriteOne, their completion callbacks included, don't
+ * allocate from the heap; only starting an operation does
+ */
+TEST(HandlerMemory, ReadOneWriteOne) {
+  ba::io_service service;
+  SocketPair pair(service);
+
+  const size_t kRounds = 64;
+  const size_t kWarmup = 8;
+  size_t completed = 0;
+  for (size_t i = 0; i < kRounds; ++i) {
+    auto writer = WriteOne::Start(pair.client, Buffer::Create("ping\n"), [&](bs::error_code ec, write_one::Ptr) {
+      ASSERT_FALSE(ec);
+      ++completed;
+    }, 0);
+    read_one::handlers::Substring newline(std::string("\n"));
+    auto reader = ReadOne::Start(pair.server, newline, [&](bs::error_code ec, read_one::Ptr r) {
+      ASSERT_FALSE(ec);
+      ASSERT_EQ(5u, (**r->GetBuffer()).size());
+      ++completed;
+    }, 0);
+
+    counting = i >= kWarmup;
+    service.run();
+    counting = false;
+    service.reset();
+
+    ASSERT_EQ(0u, writer->GetHandlerMemory().GetMisses());
+    ASSERT_EQ(0u, reader->GetHandlerMemory().GetMisses());
+  }
+  ASSERT_EQ(2 * kRounds, completed);
+  ASSERT_EQ(0u, allocations);
+}
+
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
+
+/// @endcond internal
@@ -0,0 +1,135 @@
+/**
+ * @cond   internal
+ * @file   tests/options.cpp
+ * @brief  Unit tests for protocol::tcp::socket::Options
+ */
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/asio/read.hpp>
+#include <gtest/gtest.h>
+
+#include <protocol/tcp/socket/buffer.hpp>
+#include <protocol/tcp/socket/options.hpp>
+#include <protocol/tcp/socket/socket_pair.hpp>
+#include <protocol/tcp/socket/write_one.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+
+namespace ba = boost::asio;
+namespace bs = boost::system;
+
+/**
+ * @test Default options leave the socket untouched and set options are applied
+ */
+TEST(Options, Apply) {
+  ba::io_service service;
+  sock::Socket sock(service);
+  sock.open(ba::ip::tcp::v4());
+
+  ba::ip::tcp::no_delay no_delay;
+  ba::socket_base::keep_alive keep_alive;
+  ba::socket_base::receive_buffer_size receive_buffer_size;
+  ASSERT_FALSE(Apply(Options(), sock));
+  sock.get_option(no_delay);
+  sock.get_option(keep_alive);
+  ASSERT_FALSE(no_delay.value());
+  ASSERT_FALSE(keep_alive.value());
+
+  Options options;
+  options.no_delay = true;
+  options.keep_alive = true;
+  options.receive_buffer_size = 256 * 1024;
+#ifdef TCP_KEEPIDLE
+  options.keep_alive_idle_s = 30;
+#endif
+  ASSERT_FALSE(Apply(options, sock));
+  sock.get_option(no_delay);
+  sock.get_option(keep_alive);
+  sock.get_option(receive_buffer_size);
+  ASSERT_TRUE(no_delay.value());
+  ASSERT_TRUE(keep_alive.value());
+  ASSERT_LE(256 * 1024, receive_buffer_size.value());
+#ifdef TCP_KEEPIDLE
+  int idle = 0;
+  socklen_t length = sizeof(idle);
+  ASSERT_EQ(0, getsockopt(sock.native_handle(), IPPROTO_TCP, TCP_KEEPIDLE, &idle, &length));
+  ASSERT_EQ(30, idle);
+#endif
+}
+
+/**
+ * @test TCP level options are skipped on Unix domain sockets, socket level ones still apply
+ */
+TEST(Options, UnixDomain) {
+  ba::io_service service;
+  sock::Socket sock(service);
+  sock.open(ba::local::stream_protocol());
+
+  Options options;
+  options.no_delay = true;
+  options.keep_alive_count = 3;
+  options.receive_buffer_size = 256 * 1024;
+  ASSERT_FALSE(Apply(options, sock));
+  ba::socket_base::receive_buffer_size receive_buffer_size;
+  sock.get_option(receive_buffer_size);
+  ASSERT_LE(256 * 1024, receive_buffer_size.value());
+}
+
+#ifdef TCP_CORK
+/**
+ * @test A multi-part message corks the socket on the first write and uncorks it on the last one
+ */
+TEST(Options, CorkedWrites) {
+  ba::io_service service;
+  SocketPair pair(service);
+  sock::Ptr client = pair.client;
+  sock::Socket& server = *pair.server;
+
+  const auto corked = [&]() {
+    int value = 0;
+    socklen_t length = sizeof(value);
+    getsockopt(client->native_handle(), IPPROTO_TCP, TCP_CORK, &value, &length);
+    return value != 0;
+  };
+
+  // Each part is written once the previous one completed, as a response streamed out piece by piece
+  std::vector<bool> states;
+  WriteOne::Start(client, Buffer::Create("HTTP/1.1 200 OK\r\n"), [&](bs::error_code ec, write_one::Ptr) {
+    ASSERT_FALSE(ec);
+    states.push_back(corked());
+    WriteOne::Start(client, Buffer::Create("Content-Length: 4\r\n\r\n"), [&](bs::error_code ec, write_one::Ptr) {
+      ASSERT_FALSE(ec);
+      states.push_back(corked());
+      WriteOne::Start(client, Buffer::Create("body"), [&](bs::error_code ec, write_one::Ptr) {
+        ASSERT_FALSE(ec);
+        states.push_back(corked());
+      }, 0, Dispatch(), Cork::kUncork);
+    }, 0);
+  }, 0, Dispatch(), Cork::kCork);
+  service.run();
+  ASSERT_EQ(std::vector<bool>({true, true, false}), states);
+
+  const std::string expected("HTTP/1.1 200 OK\r\nContent-Length: 4\r\n\r\nbody");
+  std::string received(expected.size(), '\0');
+  ba::read(server, ba::buffer(&received[0], received.size()));
+  ASSERT_EQ(expected, received);
+}
+#endif
+
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
+
+/// @endcond internal
@@ -0,0 +1,120 @@
+/**
+ * @cond   internal
+ * @file   tests/read_loop.cpp
+ * @brief  Unit tests for protocol::tcp::socket::ReadLoop
+ */
+
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/write.hpp>
+#include <gtest/gtest.h>
+
+#include <protocol/tcp/socket/read_loop.hpp>
+#include <protocol/tcp/socket/read_one_handlers.hpp>
+#include <protocol/tcp/socket/socket_pair.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+
+namespace ba = boost::asio;
+namespace bs = boost::system;
+
+/**
+ * @test Tests the basic concepts
+ */
+TEST(ReadLoop, Basics) {
+  ASSERT_THROW(ReadLoop::Start(sock::Ptr(), read_one::handlers::ByteCount(1), [](bs::error_code, read_loop::Ptr) {}, 0),
+               std::invalid_argument);
+}
+
+/**
+ * @test Every frame is delivered once, in order, whatever the read boundaries, and the loop ends on EOF
+ */
+TEST(ReadLoop, Frames) {
+  ba::io_service service;
+  SocketPair pair(service);
+  sock::Socket& client = *pair.client;
+  sock::Ptr server = pair.server;
+
+  const size_t kNumFrames = 20000;
+  std::string data;
+  for (size_t i = 0; i < kNumFrames; ++i) data += "message " + std::to_string(i) + "\n";
+
+  size_t frames = 0;
+  bs::error_code error;
+  read_loop::Ptr loop = ReadLoop::Start(server, read_one::handlers::Substring(std::string("\n")),
+                                        [&](bs::error_code ec, read_loop::Ptr loop) {
+    if (ec) {
+      error = ec;
+      return;
+    }
+    const auto frame = loop->GetFrame();
+    ASSERT_EQ("message " + std::to_string(frames++) + "\n",
+              std::string(ba::buffer_cast<const char*>(frame), ba::buffer_size(frame)));
+  }, 1000);
+
+  // Odd sized writes split frames across reads, they run with the loop as the data exceeds the socket buffers
+  size_t offset = 0;
+  std::function<void(bs::error_code, size_t)> write = [&](bs::error_code ec, size_t bytes) {
+    ASSERT_FALSE(ec);
+    offset += bytes;
+    if (offset == data.size()) {
+      client.close();
+      return;
+    }
+    ba::async_write(client, ba::buffer(data.data() + offset, std::min<size_t>(1001, data.size() - offset)), write);
+  };
+  write(bs::error_code(), 0);
+  service.run();
+
+  ASSERT_EQ(kNumFrames, frames);
+  ASSERT_EQ(ba::error::eof, error);
+  ASSERT_EQ(0u, loop->GetHandlerMemory().GetMisses());
+}
+
+/**
+ * @test A condition matching an empty frame ends the loop instead of spinning on it
+ */
+TEST(ReadLoop, EmptyFrame) {
+  ba::io_service service;
+  SocketPair pair(service);
+  ba::write(*pair.client, ba::buffer(std::string("data")));
+
+  size_t calls = 0;
+  bs::error_code error;
+  auto loop = ReadLoop::Start(pair.server, read_one::handlers::ByteCount(0), [&](bs::error_code ec, read_loop::Ptr) {
+    ++calls;
+    error = ec;
+  }, 0);
+  service.run();
+  ASSERT_EQ(1u, calls);
+  ASSERT_EQ(bs::errc::invalid_argument, error.value());
+}
+
+/**
+ * @test The loop ends when no data arrives in time
+ */
+TEST(ReadLoop, Timeout) {
+  ba::io_service service;
+  SocketPair pair(service);
+  sock::Ptr server = pair.server;
+
+  bs::error_code error;
+  auto loop = ReadLoop::Start(server, read_one::handlers::ByteCount(4), [&](bs::error_code ec, read_loop::Ptr) {
+    error = ec;
+    server->close();
+  }, 50);
+  service.run();
+  ASSERT_EQ(bs::errc::timed_out, error.value());
+}
+
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
+
+/// @endcond internal
@@ -4,11 +4,20 @@
  * @brief  Unit tests for protocol::tcp::ReadOne
  */
 
+#include <algorithm>
+#include <memory>
+#include <random>
 #include <stdexcept>
+#include <string>
 
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/write.hpp>
 #include <gtest/gtest.h>
 
+#include <protocol/tcp/socket/buffer.hpp>
 #include <protocol/tcp/socket/read_one.hpp>
+#include <protocol/tcp/socket/read_one_handlers.hpp>
+#include <protocol/tcp/socket/socket_pair.hpp>
 
 namespace protocol {
 namespace tcp {
@@ -28,6 +37,120 @@ void BasicsTest() {
       std::invalid_argument);
 }
 
+/**
+ * @test The incremental handlers find matches split across calls and reset after a match
+ */
+TEST(ReadOne, StreamConditions) {
+  read_one::handlers::Substring substring(std::string("abab"));
+  ASSERT_EQ(std::make_pair(size_t(5), false), substring("xxaba", 5));
+  ASSERT_EQ(std::make_pair(size_t(1), true), substring("bab", 3));
+  ASSERT_EQ(std::make_pair(size_t(4), false), substring("aba!", 4));
+  ASSERT_EQ(std::make_pair(size_t(5), true), substring("aababa", 6));
+
+  read_one::handlers::ByteCount count(10);
+  ASSERT_EQ(std::make_pair(size_t(6), false), count("123456", 6));
+  ASSERT_EQ(std::make_pair(size_t(4), true), count("7890ab", 6));
+  ASSERT_EQ(std::make_pair(size_t(10), true), count("1234567890", 10));
+}
+
+/**
+ * @test The incremental Substring finds the same matches as std::search however the input is split
+ */
+TEST(ReadOne, StreamSubstringSplits) {
+  std::mt19937 random(7);
+  for (int round = 0; round < 500; ++round) {
+    std::string data(random() % 300, '\0');
+    for (auto& c : data) c = "ab\r\n"[random() % 4];
+    const std::string token = round % 2 ? "\r\n\r\n" : "abab";
+
+    read_one::handlers::Substring substring(token);
+    size_t position = 0, consumed = 0;
+    while (position < data.size()) {
+      const size_t chunk = std::min<size_t>(1 + random() % 40, data.size() - position);
+      const auto result = substring(data.data() + position, chunk);
+      if (result.second) {
+        const size_t expected = std::search(data.begin() + consumed, data.end(), token.begin(), token.end()) -
+                                data.begin() + token.size();
+        ASSERT_EQ(expected, position + result.first);
+        consumed = position + result.first;
+        position = consumed;
+      } else {
+        ASSERT_EQ(chunk, result.first);
+        position += chunk;
+      }
+    }
+    ASSERT_TRUE(std::search(data.begin() + consumed, data.end(), token.begin(), token.end()) == data.end());
+  }
+}
+
+/**
+ * @test AnyOf reports the token ending first, in both modes
+ */
+TEST(ReadOne, AnyOf) {
+  ASSERT_THROW(read_one::handlers::AnyOf({}), std::runtime_error);
+  ASSERT_THROW(read_one::handlers::AnyOf({"a", ""}), std::runtime_error);
+
+  read_one::handlers::AnyOf any({"\r\n\r\n", "\n\n", "ERROR", "he", "she", "hers"});
+  ASSERT_EQ(-1, any.GetMatch());
+  read_one::handlers::AnyOf copy = any;
+
+  // Each copy has its own scan state, the caller's instance identifies the match from the bytes
+  ASSERT_EQ(std::make_pair(size_t(5), false), copy("abc\r\n", 5));
+  ASSERT_EQ(std::make_pair(size_t(2), true), copy("\r\nxyz", 5));
+  ASSERT_EQ(0, copy.GetMatch());
+  ASSERT_EQ(-1, any.GetMatch());
+  ASSERT_EQ(0, any.GetMatch("abc\r\n\r\n", 7));
+  ASSERT_EQ(std::make_pair(size_t(4), true), copy("ushers", 6));
+  ASSERT_EQ(4, copy.GetMatch());
+  ASSERT_EQ(4, any.GetMatch("ushe", 4));
+  ASSERT_EQ(-1, any.GetMatch("ush", 3));
+  ASSERT_EQ(std::make_pair(size_t(3), false), copy("ERR", 3));
+  read_one::handlers::AnyOf other = any;
+  ASSERT_EQ(std::make_pair(size_t(2), false), other("OR", 2));
+  ASSERT_EQ(std::make_pair(size_t(2), true), copy("OR\n\n", 4));
+  ASSERT_EQ(2, copy.GetMatch());
+  ASSERT_EQ(-1, other.GetMatch());
+
+  ba::streambuf buffer;
+  std::ostream os(&buffer);
+  os << "GET / HTTP/1.0\n\nbody";
+  const auto data = buffer.data();
+  const auto result = any(ba::buffers_begin(data), ba::buffers_end(data));
+  ASSERT_TRUE(result.second);
+  ASSERT_EQ(16, result.first - ba::buffers_begin(data));
+  ASSERT_EQ(1, any.GetMatch());
+
+  const auto partial = any(ba::buffers_begin(data), ba::buffers_begin(data) + 15);
+  ASSERT_FALSE(partial.second);
+  ASSERT_EQ(11, partial.first - ba::buffers_begin(data));
+}
+
+/**
+ * @test Streaming mode stops at the end of the match and keeps the bytes received past it
+ */
+TEST(ReadOne, Streaming) {
+  ba::io_service service;
+  SocketPair pair(service);
+  sock::Socket& client = *pair.client;
+  sock::Ptr server = pair.server;
+
+  const std::string header = std::string(3 * ReadOne::kStreamReadSize, 'h') + "\r\n\r\n";
+  ba::write(client, ba::buffer(header + "body"));
+
+  size_t match_size = 0;
+  std::string received;
+  ReadOne::StartStreaming(server, read_one::handlers::Substring(std::string("\r\n\r\n")),
+                          [&](bs::error_code ec, read_one::Ptr read) {
+                            ASSERT_FALSE(ec);
+                            match_size = read->GetMatchSize();
+                            received = read->GetBuffer()->ToString();
+                          }, 0);
+  service.run();
+
+  ASSERT_EQ(header.size(), match_size);
+  ASSERT_EQ(header, received.substr(0, match_size));
+}
+
 }  // namespace socket
 }  // namespace tcp
 }  // namespace protocol
@@ -0,0 +1,191 @@
+/**
+ * @cond   internal
+ * @file   tests/read_one_framing.cpp
+ * @brief  Unit tests for the protocol::tcp::socket::ReadOne framing functors
+ */
+
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/streambuf.hpp>
+#include <boost/asio/write.hpp>
+#include <gtest/gtest.h>
+
+#include <protocol/tcp/socket/buffer.hpp>
+#include <protocol/tcp/socket/read_one_framing.hpp>
+#include <protocol/tcp/socket/socket_pair.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+
+namespace ba = boost::asio;
+namespace bs = boost::system;
+namespace handlers = read_one::handlers;
+
+/**
+ * Run a framing functor over a string, first whole through the iterator interface, then one byte at a time through
+ * the incremental one of a copy
+ * @param handler Framing functor, GetFrame() then reports the frame matched
+ * @param data    Input
+ * @return Bytes up to the end of the frame, or 0 if the frame is incomplete
+ */
+template <typename Handler>
+static size_t Match(Handler& handler, const std::string& data) {
+  Handler stream = handler;
+  ba::streambuf buffer;
+  std::ostream os(&buffer);
+  os << data;
+  const auto begin = ba::buffers_begin(buffer.data());
+  const auto result = handler(begin, ba::buffers_end(buffer.data()));
+  const size_t whole = result.second ? result.first - begin : 0;
+
+  size_t bytes = 0;
+  for (size_t i = 0; i < data.size(); ++i) {
+    const auto step = stream(data.data() + i, 1);
+    if (step.second) {
+      bytes = i + step.first;
+      break;
+    }
+  }
+  EXPECT_EQ(whole, bytes);
+  EXPECT_EQ(handler.GetFrame().valid, stream.GetFrame().valid);
+  EXPECT_EQ(handler.GetFrame().payload_size, stream.GetFrame().payload_size);
+  return bytes;
+}
+
+/**
+ * @test Fixed width length prefixes in both byte orders
+ */
+TEST(Framing, LengthPrefix) {
+  handlers::BigEndianPrefix<uint16_t> big;
+  ASSERT_EQ(0u, Match(big, std::string("\x00\x03" "ab", 4)));
+  ASSERT_EQ(5u, Match(big, std::string("\x00\x03" "abcde", 7)));
+  ASSERT_EQ(2u, big.GetFrame().header_size);
+  ASSERT_EQ(3u, big.GetFrame().payload_size);
+
+  handlers::LittleEndianPrefix<uint32_t> little;
+  ASSERT_EQ(6u, Match(little, std::string("\x02\x00\x00\x00" "abc", 7)));
+  ASSERT_EQ(2u, little.GetFrame().payload_size);
+  ASSERT_EQ(4u, Match(little, std::string("\x00\x00\x00\x00" "abc", 7)));
+  ASSERT_TRUE(little.GetFrame().valid);
+
+  std::string large(4 + 0x10203, 'x');
+  large.replace(0, 4, std::string("\x00\x01\x02\x03", 4));
+  handlers::BigEndianPrefix<uint32_t> prefix;
+  ASSERT_EQ(large.size(), Match(prefix, large + "next"));
+}
+
+/**
+ * @test A length field inside a larger header, counting the whole frame
+ */
+TEST(Framing, LengthFieldAtOffset) {
+  ASSERT_THROW((handlers::LengthField<uint32_t, handlers::ByteOrder::kBigEndian>(4, 6)), std::invalid_argument);
+
+  // 1 byte type, 2 bytes big-endian frame size, 1 byte flags
+  handlers::LengthField<uint16_t, handlers::ByteOrder::kBigEndian> field(1, 4, -4);
+  ASSERT_EQ(7u, Match(field, std::string("T\x00\x07" "Fabc" "more", 11)));
+  ASSERT_EQ(4u, field.GetFrame().header_size);
+  ASSERT_EQ(3u, field.GetFrame().payload_size);
+  // A frame size below the header size is malformed
+  ASSERT_EQ(4u, Match(field, std::string("T\x00\x01" "Fabc", 7)));
+  ASSERT_FALSE(field.GetFrame().valid);
+}
+
+/**
+ * @test Lengths above the maximum frame size or overflowing 64 bits make invalid frames that match the header only
+ */
+TEST(Framing, MaxFrameSize) {
+  ASSERT_THROW(handlers::BigEndianPrefix<uint32_t>(0, 0, 0, 3), std::invalid_argument);
+
+  handlers::BigEndianPrefix<uint16_t> small(0, 0, 0, 10);
+  ASSERT_EQ(10u, Match(small, std::string("\x00\x08" "12345678", 10)));
+  ASSERT_TRUE(small.GetFrame().valid);
+  ASSERT_EQ(2u, Match(small, std::string("\x00\x09" "123456789", 11)));
+  ASSERT_FALSE(small.GetFrame().valid);
+  ASSERT_EQ(0u, small.GetFrame().payload_size);
+
+  for (const char* field : {"\x80\x00\x00\x00\x00\x00\x00\x00", "\xff\xff\xff\xff\xff\xff\xff\xff"}) {
+    handlers::BigEndianPrefix<uint64_t> huge;
+    ASSERT_EQ(8u, Match(huge, std::string(field, 8) + "payload"));
+    ASSERT_FALSE(huge.GetFrame().valid);
+  }
+  handlers::BigEndianPrefix<uint64_t> wrap(0, 0, 16, std::numeric_limits<size_t>::max());
+  ASSERT_EQ(8u, Match(wrap, std::string(8, '\xff')));
+  ASSERT_FALSE(wrap.GetFrame().valid);
+
+  handlers::VarintPrefix varint(100);
+  ASSERT_EQ(100u, Match(varint, "\x63" + std::string(99, 'p')));
+  ASSERT_TRUE(varint.GetFrame().valid);
+  ASSERT_EQ(1u, Match(varint, "\x64" + std::string(100, 'p')));
+  ASSERT_FALSE(varint.GetFrame().valid);
+
+  handlers::VarintPrefix unlimited(std::numeric_limits<size_t>::max());
+  ASSERT_EQ(10u, Match(unlimited, std::string(9, '\xff') + "\x02"));
+  ASSERT_FALSE(unlimited.GetFrame().valid);
+  const std::string top = std::string(9, '\x80') + "\x01";
+  const handlers::Frame frame = unlimited.GetFrame(top.data(), top.size());
+  ASSERT_EQ(10u, frame.header_size);
+  ASSERT_EQ(uint64_t(1) << 63, frame.payload_size);
+  ASSERT_TRUE(frame.valid);
+}
+
+/**
+ * @test Varint length prefixes, including a malformed one
+ */
+TEST(Framing, Varint) {
+  handlers::VarintPrefix varint;
+  ASSERT_EQ(1u, Match(varint, std::string("\x00" "abc", 4)));
+  ASSERT_EQ(4u, Match(varint, std::string("\x03" "abcd", 5)));
+  ASSERT_EQ(0u, Match(varint, std::string("\xac\x02" "abc", 5)));
+
+  const std::string payload(300, 'p');
+  ASSERT_EQ(302u, Match(varint, "\xac\x02" + payload));
+  ASSERT_EQ(2u, varint.GetFrame().header_size);
+  ASSERT_EQ(300u, varint.GetFrame().payload_size);
+
+  ASSERT_EQ(10u, Match(varint, std::string(11, '\xff')));
+  ASSERT_FALSE(varint.GetFrame().valid);
+
+  // Copies don't share the incremental state
+  handlers::VarintPrefix copy = varint;
+  ASSERT_EQ(std::make_pair(size_t(1), false), copy("\x05", 1));
+  ASSERT_EQ(std::make_pair(size_t(2), true), varint("\x01" "a", 2));
+  ASSERT_EQ(1u, varint.GetFrame().payload_size);
+  ASSERT_EQ(std::make_pair(size_t(4), false), copy("abcd", 4));
+  ASSERT_EQ(std::make_pair(size_t(1), true), copy("e", 1));
+  ASSERT_EQ(5u, copy.GetFrame().payload_size);
+}
+
+/**
+ * @test A whole frame is read in one operation and the next one stays in the buffer
+ */
+TEST(Framing, ReadOne) {
+  ba::io_service service;
+  SocketPair pair(service);
+  sock::Socket& client = *pair.client;
+  sock::Ptr server = pair.server;
+  ba::write(client, ba::buffer(std::string("\x00\x05" "hello" "\x00\x02" "hi", 11)));
+
+  handlers::BigEndianPrefix<uint16_t> prefix;
+  std::string payload;
+  ReadOne::StartStreaming(server, prefix, [&](bs::error_code ec, read_one::Ptr read) {
+    ASSERT_FALSE(ec);
+    ASSERT_EQ(7u, read->GetMatchSize());
+    const char* data = ba::buffer_cast<const char*>((**read->GetBuffer()).data());
+    const handlers::Frame frame = prefix.GetFrame(data, read->GetMatchSize());
+    ASSERT_TRUE(frame.valid);
+    payload.assign(data + frame.header_size, frame.payload_size);
+  }, 0);
+  service.run();
+  ASSERT_EQ("hello", payload);
+}
+
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
+
+/// @endcond internal
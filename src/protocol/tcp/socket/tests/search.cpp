@@ -0,0 +1,50 @@
+/**
+ * @cond   internal
+ * @file   tests/search.cpp
+ * @brief  Unit tests for protocol::tcp::socket::search
+ */
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "protocol/tcp/socket/search.hpp"
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+
+/**
+ * @test Every implementation agrees with std::search on random data, tokens and alignments
+ */
+TEST(Search, MatchesStdSearch) {
+  std::vector<search::FindFn> impls = {search::Find, search::FindScalar, search::FindSse2};
+  if (search::HasAvx2()) impls.push_back(search::FindAvx2);
+
+  std::mt19937 random(42);
+  // A small alphabet makes partial candidates frequent
+  std::uniform_int_distribution<int> byte('a', 'd');
+  for (int round = 0; round < 2000; ++round) {
+    std::string data(random() % 200, '\0');
+    for (auto& c : data) c = static_cast<char>(byte(random));
+    std::string token(1 + random() % 6, '\0');
+    for (auto& c : token) c = static_cast<char>(byte(random));
+    const size_t offset = data.empty() ? 0 : random() % data.size();
+
+    const char* begin = data.data() + offset;
+    const char* end = data.data() + data.size();
+    const char* expected = std::search(begin, end, token.begin(), token.end());
+    for (auto impl : impls) {
+      ASSERT_EQ(expected, impl(begin, end, token.data(), token.size())) << data << " / " << token;
+    }
+  }
+}
+
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
+
+/// @endcond internal
@@ -0,0 +1,30 @@
+/**
+ * @cond   internal
+ * @file   protocol/tcp/socket/tests/socket_pair.cpp
+ * @brief  Connected pair of loopback sockets for the tests and benchmarks
+ */
+
+#include <memory>
+
+#include <boost/asio/ip/tcp.hpp>
+
+#include "protocol/tcp/socket/socket_pair.hpp"
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+
+namespace ba = boost::asio;
+
+SocketPair::SocketPair(ba::io_service& service)
+    : client(std::make_shared<sock::Socket>(service)), server(std::make_shared<sock::Socket>(service)) {
+  ba::ip::tcp::acceptor acceptor(service, ba::ip::tcp::endpoint(ba::ip::address_v4::loopback(), 0));
+  client->connect(acceptor.local_endpoint());
+  acceptor.accept(*server);
+}
+
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
+
+/// @endcond internal
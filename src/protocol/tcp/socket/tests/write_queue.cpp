@@ -0,0 +1,169 @@
+/**
+ * @cond   internal
+ * @file   tests/write_queue.cpp
+ * @brief  Unit tests for protocol::tcp::socket::WriteQueue
+ */
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/make_shared.hpp>
+#include <gtest/gtest.h>
+
+#include <protocol/tcp/socket/buffer.hpp>
+#include <protocol/tcp/socket/buffer_chain.hpp>
+#include <protocol/tcp/socket/socket_pair.hpp>
+#include <protocol/tcp/socket/write_queue.hpp>
+
+namespace protocol {
+namespace tcp {
+namespace socket {
+
+namespace ba = boost::asio;
+namespace bs = boost::system;
+
+/**
+ * @test Tests the basic concepts
+ */
+TEST(WriteQueue, Basics) {
+  ASSERT_THROW(WriteQueue::Create(sock::Ptr()), std::invalid_argument);
+
+  ba::io_service service;
+  sock::Ptr sock = std::make_shared<sock::Socket>(service);
+  write_queue::Config config;
+  config.low_water_mark = config.high_water_mark + 1;
+  ASSERT_THROW(WriteQueue::Create(sock, config), std::invalid_argument);
+  ASSERT_THROW(WriteQueue::Create(sock)->Push(buffer::Ptr()), std::invalid_argument);
+}
+
+/**
+ * @test Concurrent producers never interleave, keep their order and get coalesced writes
+ */
+TEST(WriteQueue, ConcurrentProducers) {
+  ba::io_service service;
+  SocketPair pair(service);
+  sock::Ptr client = pair.client;
+  sock::Socket& server = *pair.server;
+
+  const size_t kNumProducers = 4, kNumMessages = 2000;
+  auto queue = WriteQueue::Create(client);
+  std::atomic<size_t> done(0);
+  std::vector<std::thread> producers;
+  for (size_t p = 0; p < kNumProducers; ++p) {
+    producers.emplace_back([&, p]() {
+      for (size_t i = 0; i < kNumMessages; ++i) {
+        // Fixed size messages: producer, sequence number
+        const std::string sequence = std::to_string(i);
+        const std::string message = char('0' + p) + std::string(14 - sequence.size(), '0') + sequence + "\n";
+        const auto on_done = [&](bs::error_code ec, write_queue::Ptr) {
+          ASSERT_FALSE(ec);
+          ++done;
+        };
+        if (i % 2) {
+          queue->Push(Buffer::Create(message), on_done);
+        } else {
+          auto chain = BufferChain::Create();
+          chain->Append(boost::make_shared<const std::string>(message));
+          queue->Push(chain, on_done);
+        }
+      }
+    });
+  }
+  // Keeps run() going while the queue is momentarily empty between pushes
+  std::unique_ptr<ba::io_service::work> work(new ba::io_service::work(service));
+  std::thread io([&]() { service.run(); });
+  for (auto& producer : producers) producer.join();
+
+  std::string received(kNumProducers * kNumMessages * 16, '\0');
+  ba::read(server, ba::buffer(&received[0], received.size()));
+  work.reset();
+  io.join();
+
+  std::vector<size_t> next(kNumProducers, 0);
+  for (size_t offset = 0; offset < received.size(); offset += 16) {
+    const size_t p = received[offset] - '0';
+    ASSERT_LT(p, kNumProducers);
+    ASSERT_EQ(next[p]++, std::stoul(received.substr(offset + 1, 14)));
+    ASSERT_EQ('\n', received[offset + 15]);
+  }
+  ASSERT_EQ(kNumProducers * kNumMessages, done.load());
+  const auto stats = queue->GetStats();
+  ASSERT_EQ(kNumProducers * kNumMessages, stats.messages);
+  ASSERT_LE(stats.writes, stats.messages);
+  ASSERT_EQ(0u, queue->GetQueuedBytes());
+}
+
+/**
+ * @test Producers are asked to pause above the high-water mark and to resume at the low-water mark
+ */
+TEST(WriteQueue, Backpressure) {
+  ba::io_service service;
+  SocketPair pair(service);
+  sock::Ptr client = pair.client;
+
+  write_queue::Config config;
+  config.high_water_mark = 100;
+  config.low_water_mark = 10;
+  std::vector<bool> signals;
+  auto queue = WriteQueue::Create(client, config, [&](bool pause, write_queue::Ptr) { signals.push_back(pause); });
+
+  size_t accepted = 0;
+  for (int i = 0; i < 20; ++i) {
+    if (queue->Push(Buffer::Create("0123456789"))) ++accepted;
+  }
+  ASSERT_EQ(10u, accepted);
+  ASSERT_TRUE(signals.empty());
+
+  // The pause is delivered on the I/O thread, before the resume of the write that drains the queue
+  service.run();
+  ASSERT_EQ(std::vector<bool>({true, false}), signals);
+  ASSERT_EQ(0u, queue->GetQueuedBytes());
+
+  queue->Stop();
+  bs::error_code error;
+  ASSERT_FALSE(queue->Push(Buffer::Create("late"), [&](bs::error_code ec, write_queue::Ptr) { error = ec; }));
+  service.reset();
+  service.run();
+  ASSERT_EQ(ba::error::operation_aborted, error);
+}
+
+/**
+ * @test A write that doesn't complete in time fails its messages and the queued ones, and closes the socket
+ */
+TEST(WriteQueue, Timeout) {
+  ba::io_service service;
+  SocketPair pair(service);
+  sock::Ptr client = pair.client;
+  client->set_option(ba::socket_base::send_buffer_size(4096));
+  pair.server->set_option(ba::socket_base::receive_buffer_size(4096));
+
+  write_queue::Config config;
+  config.timeout_ms = 50;
+  config.max_batch_messages = 1;
+  auto queue = WriteQueue::Create(client, config);
+
+  // The peer never reads, so the first write can't complete
+  std::vector<bs::error_code> errors;
+  const auto on_done = [&](bs::error_code ec, write_queue::Ptr) { errors.push_back(ec); };
+  queue->Push(Buffer::Create(std::string(16 << 20, 'x')), on_done);
+  queue->Push(Buffer::Create("queued"), on_done);
+  service.run();
+
+  ASSERT_EQ(2u, errors.size());
+  ASSERT_EQ(bs::errc::timed_out, errors[0].value());
+  ASSERT_EQ(bs::errc::timed_out, errors[1].value());
+  ASSERT_FALSE(client->is_open());
+  ASSERT_FALSE(queue->Push(Buffer::Create("late")));
+}
+
+}  // namespace socket
+}  // namespace tcp
+}  // namespace protocol
+
+/// @endcond internal
@@ -4,17 +4,29 @@
  * @brief  Unit tests for protocol::tcp::Acceptor and protocol::tcp::Connection
  */
 
+#include <unistd.h>
+
 #include <exception>
 #include <chrono>
+#include <future>
+#include <string>
 #include <thread>
+#include <utility>
 
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
 #include <boost/system/system_error.hpp>
 #include <gtest/gtest.h>
 
 #include <protocol/service/singleton.hpp>
 #include <protocol/tcp/client/connection.hpp>
+#include <protocol/tcp/client/http_get.hpp>
 #include <protocol/tcp/server/acceptor.hpp>
+#include <protocol/tcp/socket/options.hpp>
+#include <protocol/tcp/socket/buffer.hpp>
+#include <protocol/tcp/socket/endpoint.hpp>
 #include <protocol/tcp/socket/read_one.hpp>
+#include <protocol/tcp/socket/read_one_handlers.hpp>
 #include <protocol/tcp/socket/write_one.hpp>
 #include "protocol/utility/get_available_port.hpp"
 
@@ -48,34 +60,303 @@ class ServerClient : public ::testing::Test {
 
 };
 
+namespace {
+
+/**
+ * Fulfil a promise from a callback, with the error if any. The callback doesn't assert, a failed assertion would
+ * return without fulfilling it and leave the test thread waiting; get() rethrows the error on the test thread instead
+ * @param promise Promise to fulfil
+ * @param eptr    Error of the callback
+ * @param value   Value of the callback
+ */
+template <typename T>
+void Fulfil(std::promise<T> &promise, exception_ptr eptr, T value) {
+  if (eptr) {
+    promise.set_exception(eptr);
+  } else {
+    promise.set_value(std::move(value));
+  }
+}
+
+/**
+ * Fulfil a promise from a callback, with the error if any
+ * @param promise Promise to fulfil
+ * @param ec      Error of the callback
+ * @param value   Value of the callback
+ */
+template <typename T>
+void Fulfil(std::promise<T> &promise, bs::error_code ec, T value) {
+  Fulfil(promise, ec ? std::make_exception_ptr(bs::system_error(ec)) : exception_ptr(), std::move(value));
+}
+
+}  // namespace
+
 /**
  * @test Tests the basic concepts of WriteOne
  */
 TEST_F(ServerClient, BasicWriteRead) {
-  bool error = false;
-  socket::sock::Ptr server_sock;
+  std::promise<socket::sock::Ptr> accepted;
+  uint16_t port = utility::GetAvailablePort();
+  Acceptor acceptor(port, {[&](bs::error_code ec, Acceptor &acceptor, socket::sock::Ptr sock) {
+    acceptor.Stop();
+    Fulfil(accepted, ec, sock);
+  }});
+
+  std::promise<socket::sock::Ptr> connected;
+  auto connection = Connection::Start("127.0.0.1", port, 100, {[&](exception_ptr eptr, socket::sock::Ptr sock) {
+    Fulfil(connected, eptr, sock);
+  }});
+
+  // Wait for both ends, the callbacks refer to this scope
+  ASSERT_TRUE(accepted.get_future().get().get());
+  ASSERT_TRUE(connected.get_future().get().get());
+}
+
+/**
+ * @test Socket options are applied on both ends of a connection
+ */
+TEST_F(ServerClient, SocketOptions) {
+  socket::Options options;
+  options.no_delay = true;
+  options.keep_alive = true;
+
+  std::promise<socket::sock::Ptr> accepted;
   uint16_t port = utility::GetAvailablePort();
   Acceptor acceptor(port, {[&](bs::error_code ec, Acceptor &acceptor, socket::sock::Ptr sock) {
+    acceptor.Stop();
+    Fulfil(accepted, ec, sock);
+  }}, options);
+
+  std::promise<socket::sock::Ptr> connected;
+  auto connection = Connection::Start("127.0.0.1", port, 1000, {[&](exception_ptr eptr, socket::sock::Ptr sock) {
+    Fulfil(connected, eptr, sock);
+  }}, options);
+
+  for (auto sock : {accepted.get_future().get(), connected.get_future().get()}) {
+    ba::ip::tcp::no_delay no_delay;
+    ba::socket_base::keep_alive keep_alive;
+    sock->get_option(no_delay);
+    sock->get_option(keep_alive);
+    ASSERT_TRUE(no_delay.value());
+    ASSERT_TRUE(keep_alive.value());
+  }
+}
+
+/**
+ * @test An IPv6 acceptor is dual-stack by default and reports IPv4 peers by their IPv4 address
+ */
+TEST_F(ServerClient, DualStack) {
+  std::promise<ba::ip::address> v4_peer, v6_peer;
+  Acceptor acceptor(ba::ip::tcp::endpoint(ba::ip::tcp::v6(), 0),
+                    {[&](bs::error_code ec, Acceptor &acceptor, socket::sock::Ptr sock) {
     if (ec) {
-      error = true;
       acceptor.Stop();
+      Fulfil(v4_peer, ec, ba::ip::address());
       return;
     }
-    ASSERT_TRUE(sock.get());
-    server_sock = sock;
+    const ba::ip::address peer = socket::GetAddress(sock->remote_endpoint());
+    (peer.is_v4() ? v4_peer : v6_peer).set_value(peer);
   }});
-  ASSERT_TRUE(!error);
+  ASSERT_NE(0, acceptor.GetPort());
 
-  socket::sock::Ptr client_sock;
-  auto connection = Connection::Start("127.0.0.1", port, 100, {[&](exception_ptr eptr, socket::sock::Ptr sock) {
+  std::promise<socket::sock::Ptr> v4_connected, v6_connected;
+  auto v4 = Connection::Start("127.0.0.1", acceptor.GetPort(), 1000, {[&](exception_ptr eptr, socket::sock::Ptr sock) {
+    Fulfil(v4_connected, eptr, sock);
+  }});
+  auto v6 = Connection::Start("::1", acceptor.GetPort(), 1000, {[&](exception_ptr eptr, socket::sock::Ptr sock) {
+    Fulfil(v6_connected, eptr, sock);
+  }});
+
+  ASSERT_TRUE(v4_connected.get_future().get().get());
+  ASSERT_TRUE(v6_connected.get_future().get().get());
+  ASSERT_EQ("127.0.0.1", v4_peer.get_future().get().to_string());
+  ASSERT_EQ("::1", v6_peer.get_future().get().to_string());
+  acceptor.Stop();
+}
+
+/**
+ * @test ReadOne and WriteOne work unchanged over a Unix domain socket, whose file is removed with the acceptor and
+ * replaced only once nobody listens on it
+ */
+TEST_F(ServerClient, UnixDomain) {
+  const std::string path = "/tmp/protocol_test_" + std::to_string(getpid()) + ".sock";
+  const ba::local::stream_protocol::endpoint endpoint(path);
+  const std::string message = "Hello World!\n";
+
+  socket::Options options;
+  options.no_delay = true;
+  server::acceptor::Config config;
+  config.options = options;
+  config.max_connections_per_ip = 1;
+
+  {
+    std::promise<std::string> read;
+    Acceptor acceptor(endpoint, {[&](bs::error_code ec, Acceptor &acceptor, socket::sock::Ptr sock) {
+      if (ec) {
+        acceptor.Stop();
+        Fulfil(read, ec, std::string());
+        return;
+      }
+      socket::ReadOne::Start(sock, socket::read_one::handlers::Substring(std::string("\n")),
+                             [&](bs::error_code ec, socket::read_one::Ptr caller) {
+                               Fulfil(read, ec, ec ? std::string() : caller->GetBuffer()->ToString());
+                             }, 1000);
+    }}, config);
+    ASSERT_EQ(0, acceptor.GetPort());
+    ASSERT_EQ(0, access(path.c_str(), F_OK));
+
+    std::promise<bs::error_code> written;
+    auto connection = Connection::Start(endpoint, 1000, {[&](exception_ptr eptr, socket::sock::Ptr sock) {
+      if (eptr) {
+        written.set_exception(eptr);
+        return;
+      }
+      socket::WriteOne::Start(sock, socket::Buffer::Create(message),
+                              [&](bs::error_code ec, socket::write_one::Ptr) { written.set_value(ec); }, 1000);
+    }}, options);
+
+    ASSERT_FALSE(written.get_future().get());
+    ASSERT_EQ(message, read.get_future().get());
+    ASSERT_EQ(1u, acceptor.GetStats().accepted);
+  }
+  ASSERT_NE(0, access(path.c_str(), F_OK));
+
+  // The file of a socket still listening is left alone
+  const auto ignore = [](bs::error_code, Acceptor &, socket::sock::Ptr) {};
+  {
+    Acceptor acceptor(endpoint, {ignore}, config);
+    ASSERT_THROW(Acceptor(endpoint, {ignore}, config), bs::system_error);
+    ASSERT_EQ(0, access(path.c_str(), F_OK));
+  }
+
+  // The file left behind by a socket closed without removing it is replaced
+  {
+    ba::io_service service;
+    ba::local::stream_protocol::acceptor stale(service, endpoint);
+  }
+  ASSERT_EQ(0, access(path.c_str(), F_OK));
+  {
+    Acceptor acceptor(endpoint, {ignore}, config);
+  }
+  ASSERT_NE(0, access(path.c_str(), F_OK));
+}
+
+/**
+ * @test HTTPGet parses a response arriving in pieces, the body split across them
+ */
+TEST_F(ServerClient, HttpGet) {
+  const std::string head = "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 12\r\n\r\nHello";
+  const std::string tail = " World!";
+
+  // The server side reports its first error, or success once the whole response is written
+  std::promise<bool> served;
+  uint16_t port = utility::GetAvailablePort();
+  Acceptor acceptor(port, {[&](bs::error_code ec, Acceptor &acceptor, socket::sock::Ptr sock) {
+    acceptor.Stop();
+    if (ec) {
+      Fulfil(served, ec, false);
+      return;
+    }
+    socket::ReadOne::Start(sock, socket::read_one::handlers::Substring(std::string("\r\n\r\n")),
+                           [&, sock](bs::error_code ec, socket::read_one::Ptr) {
+      if (ec) {
+        Fulfil(served, ec, false);
+        return;
+      }
+      socket::WriteOne::Start(sock, socket::Buffer::Create(head), [&, sock](bs::error_code ec, socket::write_one::Ptr) {
+        if (ec) {
+          Fulfil(served, ec, false);
+          return;
+        }
+        socket::WriteOne::Start(sock, socket::Buffer::Create(tail), [&](bs::error_code ec, socket::write_one::Ptr) {
+          Fulfil(served, ec, true);
+        }, 1000);
+      }, 1000);
+    }, 1000);
+  }});
+
+  std::promise<client::http::http_get::Ptr> done;
+  auto connection = Connection::Start("127.0.0.1", port, 1000, {[&](exception_ptr eptr, socket::sock::Ptr sock) {
     if (eptr) {
-      error = true;
+      done.set_exception(eptr);
       return;
     }
-    ASSERT_TRUE(sock.get());
-    client_sock = sock;
+    client::http::HTTPGet::Create(sock, "/", [&](exception_ptr eptr, client::http::http_get::Ptr get) {
+      Fulfil(done, eptr, get);
+    })->Start(1000);
   }});
-  ASSERT_TRUE(!error);
+
+  ASSERT_TRUE(served.get_future().get());
+  auto get = done.get_future().get();
+  ASSERT_EQ(200, get->GetStatus());
+  ASSERT_EQ("Hello World!", get->GetBody());
+  client::http::Headers headers = get->GetHeaders();
+  ASSERT_EQ("text/plain", client::http::GetHeaderField(headers, "content-type"));
+  ASSERT_TRUE(get->IsPersistent());
+}
+
+/**
+ * @test HTTPGet streams a chunked body to the body callback as it arrives, without storing it
+ */
+TEST_F(ServerClient, HttpGetStreaming) {
+  const std::string head = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n6\r\nHello \r\n";
+  const std::string tail = "6\r\nWorld!\r\n0\r\n\r\n";
+
+  // The server side reports its first error, or success once the whole response is written
+  std::promise<bool> served;
+  std::promise<socket::sock::Ptr> accepted;
+  uint16_t port = utility::GetAvailablePort();
+  Acceptor acceptor(port, {[&](bs::error_code ec, Acceptor &acceptor, socket::sock::Ptr sock) {
+    acceptor.Stop();
+    Fulfil(accepted, ec, sock);
+    if (ec) {
+      Fulfil(served, ec, false);
+      return;
+    }
+    socket::ReadOne::Start(sock, socket::read_one::handlers::Substring(std::string("\r\n\r\n")),
+                           [&, sock](bs::error_code ec, socket::read_one::Ptr) {
+      if (ec) {
+        Fulfil(served, ec, false);
+        return;
+      }
+      socket::WriteOne::Start(sock, socket::Buffer::Create(head), [&](bs::error_code ec, socket::write_one::Ptr) {
+        if (ec) Fulfil(served, ec, false);
+      }, 1000);
+    }, 1000);
+  }});
+  auto accepted_sock = accepted.get_future().share();
+
+  std::string streamed;
+  std::promise<client::http::http_get::Ptr> done;
+  auto connection = Connection::Start("127.0.0.1", port, 1000, {[&](exception_ptr eptr, socket::sock::Ptr sock) {
+    if (eptr) {
+      done.set_exception(eptr);
+      return;
+    }
+    auto get = client::http::HTTPGet::Create(sock, "/", [&](exception_ptr eptr, client::http::http_get::Ptr get) {
+      Fulfil(done, eptr, get);
+    });
+    get->SetOnBodyCallback([&](boost::string_ref data, client::http::http_get::Ptr) {
+      // The rest of the body is only sent once the client got the first chunk
+      if (streamed.empty()) {
+        socket::sock::Ptr server = accepted_sock.get();
+        server->get_io_service().post([&, server]() {
+          socket::WriteOne::Start(server, socket::Buffer::Create(tail), [&](bs::error_code ec, socket::write_one::Ptr) {
+            Fulfil(served, ec, true);
+          }, 1000);
+        });
+      }
+      streamed.append(data.data(), data.size());
+    });
+    get->Start(1000);
+  }});
+
+  ASSERT_TRUE(served.get_future().get());
+  auto get = done.get_future().get();
+  ASSERT_EQ(200, get->GetStatus());
+  ASSERT_EQ("Hello World!", streamed);
+  ASSERT_TRUE(get->GetBody().empty());
+  ASSERT_TRUE(get->IsPersistent());
 }
 
 }  // namespace tcp
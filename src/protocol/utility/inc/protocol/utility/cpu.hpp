@@ -0,0 +1,32 @@
+#pragma once
+/**
+ * @file   protocol/utility/cpu.hpp
+ * @brief  Free method declarations for CPU topology queries
+ */
+
+#include <vector>
+
+namespace protocol {
+namespace utility {
+
+/**
+ * Get the NUMA node a CPU belongs to
+ * @param cpu CPU index
+ * @return NUMA node index or -1 if unknown
+ */
+int GetNumaNode(unsigned cpu);
+
+/**
+ * Get the CPU the calling thread is running on
+ * @return CPU index or -1 if unknown
+ */
+int GetCurrentCpu();
+
+/**
+ * Get the CPUs the process may run on, which taskset or a container cpuset can restrict
+ * @return Sorted CPU indexes, never empty
+ */
+std::vector<unsigned> GetAllowedCpus();
+
+}  // namespace utility
+}  // namespace protocol
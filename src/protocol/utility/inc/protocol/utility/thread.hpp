@@ -0,0 +1,65 @@
+#pragma once
+/**
+ * @file   protocol/utility/thread.hpp
+ * @brief  Class declaration of protocol::utility::Thread
+ */
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace protocol {
+namespace utility {
+
+/**
+ * A thread of execution created with attributes that std::thread doesn't expose
+ */
+class Thread {
+ public:
+  /**
+   * Thread creation attributes
+   */
+  struct Attributes {
+    Attributes() : name(), stack_size(0), cpus() {}
+
+    std::string name;           ///< Thread name, truncated to what the OS supports. Empty keeps the default
+    size_t stack_size;          ///< Stack size in bytes, 0 keeps the default
+    std::vector<unsigned> cpus; ///< CPUs the thread may run on, empty keeps the default
+  };
+
+  /**
+   * Create and start a thread
+   * @param attributes Creation attributes
+   * @param fn         Function to run
+   * @throws std::system_error if the thread can't be created or the attributes can't be applied
+   */
+  Thread(const Attributes& attributes, std::function<void()> fn);
+
+  /**
+   * Dtor, joins the thread if it wasn't joined yet
+   */
+  ~Thread();
+
+  /**
+   * Wait for the thread to finish
+   * @throws std::logic_error if called from the thread itself
+   */
+  void Join();
+
+  /**
+   * Check if the calling thread is this thread
+   * @return True if called from within the thread
+   */
+  bool IsCurrent() const;
+
+ private:
+  Thread(Thread const&) = delete;             ///< Delete copy construct
+  Thread& operator=(Thread const&) = delete;  ///< Delete copy assignment
+
+  struct Impl;
+  Impl* impl_;  ///< Platform specific state
+};
+
+}  // namespace utility
+}  // namespace protocol
@@ -0,0 +1,67 @@
+/**
+ * @file   protocol/utility/src/posix/cpu.cpp
+ * @brief  Free method definitions for CPU topology queries
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <dirent.h>
+#include <sched.h>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "protocol/utility/cpu.hpp"
+
+namespace protocol {
+namespace utility {
+
+int GetNumaNode(unsigned cpu) {
+  // Linux exposes the node as a "nodeN" entry in the CPU's sysfs directory
+  const std::string path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+  DIR* dir = opendir(path.c_str());
+  if (nullptr == dir) return -1;
+
+  int node = -1;
+  while (struct dirent* entry = readdir(dir)) {
+    if (0 == strncmp(entry->d_name, "node", 4) && entry->d_name[4] >= '0' && entry->d_name[4] <= '9') {
+      node = atoi(entry->d_name + 4);
+      break;
+    }
+  }
+  closedir(dir);
+  return node;
+}
+
+int GetCurrentCpu() {
+#if defined(__linux__)
+  return sched_getcpu();
+#else
+  return -1;
+#endif
+}
+
+std::vector<unsigned> GetAllowedCpus() {
+  std::vector<unsigned> cpus;
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (0 == sched_getaffinity(0, sizeof(set), &set)) {
+    for (unsigned cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+    }
+  }
+#endif
+  if (cpus.empty()) {
+    const unsigned num_cpus = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+    for (unsigned cpu = 0; cpu < num_cpus; ++cpu) cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+}  // namespace utility
+}  // namespace protocol
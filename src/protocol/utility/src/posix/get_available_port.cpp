@@ -4,6 +4,7 @@
  */
 
 #include <stdexcept>
+#include <arpa/inet.h>
 #include <netinet/in.h>
 #include <string.h>
 #include <sys/socket.h>
@@ -35,7 +36,7 @@ uint16_t GetAvailablePort() {
     throw std::runtime_error("Error getting socket info");
   }
 
-  uint16_t port = serv_addr.sin_port;
+  uint16_t port = ntohs(serv_addr.sin_port);
 
   if (close(sock) < 0) {
     throw std::runtime_error("Error closing port");
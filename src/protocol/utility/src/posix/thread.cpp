@@ -0,0 +1,108 @@
+/**
+ * @file   protocol/utility/src/posix/thread.cpp
+ * @brief  Class definition of protocol::utility::Thread
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <pthread.h>
+#include <sched.h>
+#include <limits.h>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include "protocol/utility/thread.hpp"
+
+namespace protocol {
+namespace utility {
+
+struct Thread::Impl {
+  Impl(const Attributes& attr, std::function<void()> function) : attributes(attr), fn(std::move(function)),
+                                                                  handle(), joined(false) {}
+
+  /**
+   * Entry point of the native thread
+   * @param arg Pointer to Impl
+   * @return Nothing
+   */
+  static void* Run(void* arg) {
+    Impl* impl = static_cast<Impl*>(arg);
+    if (!impl->attributes.name.empty()) {
+      // Linux limits names to 15 characters plus the terminator
+      std::string name = impl->attributes.name.substr(0, 15);
+#if defined(__APPLE__)
+      pthread_setname_np(name.c_str());
+#elif defined(__linux__)
+      pthread_setname_np(pthread_self(), name.c_str());
+#endif
+    }
+    impl->fn();
+    return nullptr;
+  }
+
+  Attributes attributes;     ///< Creation attributes
+  std::function<void()> fn;  ///< Function to run
+  pthread_t handle;          ///< Native handle
+  bool joined;               ///< Join state
+};
+
+Thread::Thread(const Attributes& attributes, std::function<void()> fn) : impl_(new Impl(attributes, std::move(fn))) {
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+
+  int err = 0;
+  if (attributes.stack_size) {
+    size_t stack_size = attributes.stack_size < static_cast<size_t>(PTHREAD_STACK_MIN)
+        ? static_cast<size_t>(PTHREAD_STACK_MIN) : attributes.stack_size;
+    err = pthread_attr_setstacksize(&attr, stack_size);
+  }
+
+#if defined(__linux__)
+  if (!err && !attributes.cpus.empty()) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for (unsigned cpu : attributes.cpus) {
+      CPU_SET(cpu, &cpus);
+    }
+    err = pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+  }
+#endif
+
+  if (!err) {
+    err = pthread_create(&impl_->handle, &attr, &Impl::Run, impl_);
+  }
+  pthread_attr_destroy(&attr);
+
+  if (err) {
+    delete impl_;
+    throw std::system_error(err, std::system_category(), "Couldn't create thread");
+  }
+}
+
+Thread::~Thread() {
+  if (!impl_->joined && IsCurrent()) {
+    // Destroyed from within, the state is still in use by Run() so it is left behind
+    pthread_detach(impl_->handle);
+    return;
+  }
+  Join();
+  delete impl_;
+}
+
+void Thread::Join() {
+  if (impl_->joined) return;
+  if (IsCurrent()) throw std::logic_error("Thread can't join itself");
+
+  pthread_join(impl_->handle, nullptr);
+  impl_->joined = true;
+}
+
+bool Thread::IsCurrent() const {
+  return pthread_equal(impl_->handle, pthread_self());
+}
+
+}  // namespace utility
+}  // namespace protocol